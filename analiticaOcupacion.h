@@ -0,0 +1,165 @@
+#ifndef ANALITICA_OCUPACION_H
+#define ANALITICA_OCUPACION_H
+
+#include <ctime>
+#include <cstdint>
+#include <vector>
+
+#include "histogramaLatencia.h"
+
+using namespace std;
+
+// ==================== ANALITICA DE OCUPACION ====================
+// Se alimenta con cada entrada y salida y mantiene, sin volver a recorrer
+// el historial de tickets:
+//   - la ultima semana por hora: lugar-segundos ocupados, ocupacion maxima,
+//     entradas y salidas (anillo de HORAS_VENTANA cubetas)
+//   - por cajon, los segundos que ha estado ocupado (utilizacion)
+//   - las estancias en un histograma log-lineal (promedio y percentiles)
+// Cada evento cuesta O(1): solo se integra la ocupacion desde el evento
+// anterior, a lo mas a traves de HORAS_VENTANA cubetas.
+class AnaliticaOcupacion {
+public:
+    static const int HORAS_VENTANA = 168;  // una semana
+    static const int SEGUNDOS_HORA = 3600;
+
+    struct Hora {
+        time_t inicio;               // -1: cubeta sin datos
+        uint64_t segundosOcupados;   // suma sobre los lugares
+        int ocupacionMaxima;
+        uint32_t entradas;
+        uint32_t salidas;
+    };
+
+private:
+    Hora horas[HORAS_VENTANA];
+    int ocupados;
+    time_t inicio;          // primer instante observado
+    time_t integradoHasta;  // la ocupacion ya esta sumada hasta aqui
+    vector<uint64_t> segundosLugar;
+    vector<time_t> ocupadoDesde;  // 0: libre
+    HistogramaLatencia estancias;  // segundos
+
+    Hora& cubeta(time_t t) {
+        time_t hora = t / SEGUNDOS_HORA;
+        Hora& h = horas[hora % HORAS_VENTANA];
+        if (h.inicio != hora * SEGUNDOS_HORA) {
+            h = {hora * SEGUNDOS_HORA, 0, ocupados, 0, 0};
+        }
+        return h;
+    }
+
+    // Suma 'ocupados' lugar-segundos de integradoHasta a t, hora por hora.
+    // Lo anterior a la ventana ya no se puede consultar y se salta.
+    void avanzar(time_t t) {
+        if (t <= integradoHasta) return;
+        time_t limite = (t / SEGUNDOS_HORA - (HORAS_VENTANA - 1)) * SEGUNDOS_HORA;
+        if (integradoHasta < limite) integradoHasta = limite;
+        while (integradoHasta < t) {
+            time_t finHora = (integradoHasta / SEGUNDOS_HORA + 1) * SEGUNDOS_HORA;
+            time_t fin = t < finHora ? t : finHora;
+            cubeta(integradoHasta).segundosOcupados += (uint64_t)ocupados * (uint64_t)(fin - integradoHasta);
+            integradoHasta = fin;
+        }
+    }
+
+public:
+    AnaliticaOcupacion(int capacidad, time_t ahora)
+        : ocupados(0), inicio(ahora), integradoHasta(ahora),
+          segundosLugar(capacidad, 0), ocupadoDesde(capacidad, 0) {
+        for (Hora& h : horas) h = {-1, 0, 0, 0, 0};
+    }
+
+    // lugar: 1..capacidad
+    void entrada(int lugar, time_t t) {
+        if (lugar < 1 || lugar > (int)ocupadoDesde.size() || ocupadoDesde[lugar - 1] != 0) return;
+        avanzar(t);
+        ocupados++;
+        Hora& h = cubeta(t);
+        h.entradas++;
+        if (ocupados > h.ocupacionMaxima) h.ocupacionMaxima = ocupados;
+        ocupadoDesde[lugar - 1] = t;
+    }
+
+    // horaEntrada es la del ticket: la estancia cuenta aunque el auto haya
+    // entrado antes de que empezara la analitica
+    void salida(int lugar, time_t horaEntrada, time_t t) {
+        if (lugar < 1 || lugar > (int)ocupadoDesde.size() || ocupadoDesde[lugar - 1] == 0) return;
+        avanzar(t);
+        ocupados--;
+        cubeta(t).salidas++;
+        segundosLugar[lugar - 1] += (uint64_t)(t - ocupadoDesde[lugar - 1]);
+        ocupadoDesde[lugar - 1] = 0;
+        estancias.registrar(t > horaEntrada ? (uint64_t)(t - horaEntrada) : 0);
+    }
+
+    // Cajones nuevos al final (lote ampliado), libres y sin historia
+    void ampliar(int capacidad) {
+        if (capacidad <= (int)segundosLugar.size()) return;
+        segundosLugar.resize(capacidad, 0);
+        ocupadoDesde.resize(capacidad, 0);
+    }
+
+    int ocupacionActual() const {
+        return ocupados;
+    }
+
+    const HistogramaLatencia& histogramaEstancias() const {
+        return estancias;
+    }
+
+    // Hora con mayor ocupacion promedio de la ultima semana; false sin datos
+    bool horaPico(time_t ahora, time_t& inicioHora, double& ocupacionPromedio) {
+        avanzar(ahora);
+        bool encontrada = false;
+        inicioHora = 0;
+        ocupacionPromedio = 0;
+        time_t desde = (ahora / SEGUNDOS_HORA - (HORAS_VENTANA - 1)) * SEGUNDOS_HORA;
+        for (const Hora& h : horas) {
+            if (h.inicio < desde || h.inicio > ahora) continue;
+            // La hora en curso solo lleva lo transcurrido
+            time_t duracion = ahora - h.inicio < SEGUNDOS_HORA ? ahora - h.inicio : SEGUNDOS_HORA;
+            if (duracion <= 0) continue;
+            double promedio = (double)h.segundosOcupados / duracion;
+            if (!encontrada || promedio > ocupacionPromedio) {
+                encontrada = true;
+                inicioHora = h.inicio;
+                ocupacionPromedio = promedio;
+            }
+        }
+        return encontrada;
+    }
+
+    // Datos de una hora (cualquier instante dentro de ella) de la ultima semana
+    bool datosHora(time_t ahora, time_t t, Hora& resultado) {
+        avanzar(ahora);
+        const Hora& h = horas[(t / SEGUNDOS_HORA) % HORAS_VENTANA];
+        if (h.inicio != t / SEGUNDOS_HORA * SEGUNDOS_HORA) return false;
+        resultado = h;
+        return true;
+    }
+
+    // Entradas de las ultimas 'horas' horas por lugar (rotacion)
+    double rotacion(time_t ahora, int horasAtras = 24) {
+        avanzar(ahora);
+        if (segundosLugar.empty()) return 0;
+        time_t desde = (ahora / SEGUNDOS_HORA - (horasAtras - 1)) * SEGUNDOS_HORA;
+        uint64_t entradas = 0;
+        for (const Hora& h : horas) {
+            if (h.inicio >= desde && h.inicio <= ahora) entradas += h.entradas;
+        }
+        return (double)entradas / segundosLugar.size();
+    }
+
+    // Fraccion del tiempo observado que el lugar (1..) ha estado ocupado
+    double utilizacion(int lugar, time_t ahora) const {
+        if (lugar < 1 || lugar > (int)segundosLugar.size() || ahora <= inicio) return 0;
+        uint64_t segundos = segundosLugar[lugar - 1];
+        if (ocupadoDesde[lugar - 1] != 0 && ahora > ocupadoDesde[lugar - 1]) {
+            segundos += (uint64_t)(ahora - ocupadoDesde[lugar - 1]);
+        }
+        return (double)segundos / (double)(ahora - inicio);
+    }
+};
+
+#endif
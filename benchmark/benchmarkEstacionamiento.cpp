@@ -0,0 +1,700 @@
+// benchmarkEstacionamiento.cpp
+// Mide el motor de estacionamiento con lotes sinteticos de 10^3 a 10^6
+// lugares y tickets: ns por operacion, reservas de memoria por operacion y
+// memoria residente pico del proceso. Tambien el costo de actualizar una
+// metrica (metricas.h) y de registrar un evento (trazaEventos.h) en el
+// camino caliente, de la analitica de ocupacion, del indice de placas, del
+// historial de tickets, de las reservas, de las politicas de asignacion y de
+// los contadores por nivel y zona, el lote del MEGA con capacidad fija
+// contra dinamica (el fijo no debe reservar memoria), la lectura de las tramas del MEGA (MB/s y reservas, que deben ser 0) y la
+// de los folios que teclea el cajero (resolverTicket).
+//
+// Uso: benchmarkEstacionamiento [--presupuesto ms] [tamanio ...]
+//   --presupuesto ms  tiempo maximo de medicion por operacion (200 por defecto)
+//   tamanio           lugares del lote; la mitad empieza ocupada
+//                     (por defecto 1000 10000 100000 1000000)
+//
+// Cada operacion se repite hasta agotar el presupuesto o los tickets
+// preparados; el estado se restaura con cargarLugares() fuera de la medicion.
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+#include "../estacionamiento.h"
+#include "../metricas.h"
+#include "../trazaEventos.h"
+#include "../analiticaOcupacion.h"
+#include "../indicePlacas.h"
+#include "../indiceTiempo.h"
+#include "../historialTickets.h"
+#include "../exportacionHistorial.h"
+#include "../reservasLugares.h"
+#include "../protocoloMega.h"
+
+using namespace std;
+
+// --------------------------- Conteo de reservas ------------------------------
+// Todas las reservas del proceso pasan por aqui; el benchmark es de un hilo
+static unsigned long long reservas = 0;
+
+void* operator new(size_t n) {
+    reservas++;
+    void* p = malloc(n ? n : 1);
+    if (p == nullptr) throw bad_alloc();
+    return p;
+}
+void* operator new[](size_t n) { return operator new(n); }
+void* operator new(size_t n, const nothrow_t&) noexcept {
+    reservas++;
+    return malloc(n ? n : 1);
+}
+void* operator new[](size_t n, const nothrow_t& t) noexcept { return operator new(n, t); }
+// GCC ve el free() de estos reemplazos tras un new en linea y lo toma por
+// una mezcla de new con free; aqui es justamente el par correcto
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+// Memoria residente pico del proceso en KB
+long memoriaPicoKB() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc));
+    return (long)(pmc.PeakWorkingSetSize / 1024);
+#else
+    rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+#ifdef __APPLE__
+    return uso.ru_maxrss / 1024;
+#else
+    return uso.ru_maxrss;
+#endif
+#endif
+}
+
+// consulta() y repararInconsistencias() imprimen; se descarta la salida
+class SalidaNula : public streambuf {
+protected:
+    int overflow(int c) override { return c; }
+};
+
+// --------------------------- Medicion ----------------------------------------
+struct Resultado {
+    unsigned long long operaciones;
+    double nsPorOperacion;
+    double reservasPorOperacion;
+};
+
+double presupuestoMs = 200;
+
+// Repite 'operacion(i)' hasta agotar el presupuesto o 'maximo' operaciones
+template <typename Operacion>
+Resultado medir(unsigned long long maximo, Operacion operacion) {
+    typedef chrono::steady_clock Reloj;
+    Reloj::time_point inicio = Reloj::now();
+    Reloj::time_point limite = inicio + chrono::microseconds((long long)(presupuestoMs * 1000));
+    unsigned long long reservasInicio = reservas;
+    unsigned long long i = 0;
+    while (i < maximo) {
+        operacion(i);
+        i++;
+        // Consultar el reloj cada vez distorsiona las operaciones de pocos ns
+        if ((i & 63) == 0 || i < 64) {
+            if (Reloj::now() >= limite) break;
+        }
+    }
+    double ns = (double)chrono::duration_cast<chrono::nanoseconds>(Reloj::now() - inicio).count();
+    Resultado r;
+    r.operaciones = i;
+    r.nsPorOperacion = i ? ns / i : 0;
+    r.reservasPorOperacion = i ? (double)(reservas - reservasInicio) / i : 0;
+    return r;
+}
+
+// tamanio 0: la operacion no depende del lote
+void reportar(int tamanio, const char* operacion, const Resultado& r) {
+    printf("%10s  %-28s %10llu %14.1f %12.2f\n", tamanio ? to_string(tamanio).c_str() : "-", operacion,
+           r.operaciones, r.nsPorOperacion, r.reservasPorOperacion);
+    fflush(stdout);
+}
+
+// Folio con verificador como los de generarTicketId(), todos del mismo dia
+string idTicket(int n) {
+    tm dia = {};
+    dia.tm_mday = 1;
+    dia.tm_year = 2025 - 1900;
+    return formatearFolio(dia, n);
+}
+
+// Lote de 'tamanio' lugares con la primera mitad ocupada
+vector<Estacionamiento::Lugar> loteSintetico(int tamanio, time_t ahora) {
+    vector<Estacionamiento::Lugar> lugares(tamanio);
+    for (int i = 0; i < tamanio; i++) {
+        if (i < tamanio / 2) {
+            lugares[i] = {idTicket(i + 1), true, ahora - (i % 600) * 60, false, false};
+        } else {
+            lugares[i] = {"", false, 0, false, false};
+        }
+    }
+    return lugares;
+}
+
+void medirMotor(int tamanio) {
+    time_t ahora = time(nullptr);
+    int ocupados = tamanio / 2;
+    vector<Estacionamiento::Lugar> lote = loteSintetico(tamanio, ahora);
+    Estacionamiento est(tamanio);
+    mt19937 azar(tamanio);
+
+    // entrada(): busca el primer libre despues de la mitad ocupada
+    est.cargarLugares(lote, ocupados);
+    reportar(tamanio, "entrada", medir(tamanio - ocupados, [&](unsigned long long) {
+        est.entrada();
+    }));
+
+    est.cargarLugares(lote, ocupados);
+    reportar(tamanio, "salida", medir(ocupados, [&](unsigned long long i) {
+        est.salida(idTicket((int)i + 1));
+    }));
+
+    est.cargarLugares(lote, ocupados);
+    streambuf* original = cout.rdbuf();
+    SalidaNula nula;
+    cout.rdbuf(&nula);
+    vector<string> buscados(1024);
+    for (string& id : buscados) id = idTicket((int)(azar() % ocupados) + 1);
+    Resultado consulta = medir(~0ULL, [&](unsigned long long i) {
+        est.consulta(buscados[i % buscados.size()]);
+    });
+    Resultado reparar = medir(~0ULL, [&](unsigned long long) {
+        est.repararInconsistencias();
+    });
+    cout.rdbuf(original);
+    reportar(tamanio, "consulta", consulta);
+    reportar(tamanio, "repararInconsistencias", reparar);
+
+    // Lo que teclea el cajero: el folio completo o solo el final impreso
+    vector<string> finales(buscados.size());
+    for (size_t i = 0; i < buscados.size(); i++) finales[i] = buscados[i].substr(4 + INICIO_SECUENCIA_FOLIO);
+    string resuelto;
+    reportar(tamanio, "resolverTicket completo", medir(~0ULL, [&](unsigned long long i) {
+        est.resolverTicket(buscados[i % buscados.size()], resuelto);
+    }));
+    reportar(tamanio, "resolverTicket final", medir(~0ULL, [&](unsigned long long i) {
+        est.resolverTicket(finales[i % finales.size()], resuelto);
+    }));
+
+    volatile float total = 0;
+    reportar(tamanio, "calcularCobro", medir(~0ULL, [&](unsigned long long i) {
+        total = total + est.calcularCobro(lote[i % ocupados].horaEntrada, ahora);
+    }));
+
+    reportar(tamanio, "getTicketsActivos", medir(~0ULL, [&](unsigned long long) {
+        vector<string> activos = est.getTicketsActivos();
+        total = total + (float)activos.size();
+    }));
+}
+
+// Historial de estacionamiento01 y del servidor: consulta por folio y
+// paginas de 20 renglones; la mitad de los tickets ya salio
+void medirHistorial(int tamanio) {
+    HistorialTickets historial;
+    time_t ahora = time(nullptr);
+    for (int i = 0; i < tamanio; i++) {
+        historial.registrarEntrada(idTicket(i + 1), i % 6 + 1, ahora - (time_t)(tamanio - i) * 60);
+    }
+    for (int i = 0; i < tamanio; i += 2) historial.registrarSalida(idTicket(i + 1), ahora, 20.0f);
+    mt19937 azar(tamanio);
+    vector<string> buscados(1024);
+    for (string& id : buscados) id = idTicket((int)(azar() % tamanio) + 1);
+    uint32_t encontrado = 0;
+
+    reportar(tamanio, "HistorialTickets buscar", medir(~0ULL, [&](unsigned long long i) {
+        historial.buscar(buscados[i % buscados.size()], encontrado);
+    }));
+    vector<uint32_t> pagina;
+    pagina.reserve(20);
+    HistorialTickets::Filtro activos;
+    activos.estado = 1;
+    reportar(tamanio, "HistorialTickets pagina activos", medir(~0ULL, [&](unsigned long long) {
+        HistorialTickets::Cursor cursor;
+        pagina.clear();
+        historial.pagina(activos, cursor, pagina, 20);
+    }));
+    HistorialTickets::Filtro lugar;
+    lugar.estado = 2;
+    lugar.lugar = 3;
+    reportar(tamanio, "HistorialTickets pagina lugar", medir(~0ULL, [&](unsigned long long) {
+        HistorialTickets::Cursor cursor;
+        pagina.clear();
+        historial.pagina(lugar, cursor, pagina, 20);
+    }));
+    encontrado += (uint32_t)pagina.size();
+}
+
+// Lote del MEGA con capacidad fija (EstacionamientoMega) contra el mismo
+// lote con capacidad dinamica: un auto entra y sale, y una trama de
+// sensores. La primera vuelta, fuera de la medicion, le da su memoria a los
+// folios y a las instantaneas que el lote fijo recicla.
+template <int N>
+void medirLoteChico(EstacionamientoLote<N>& est, const char* ciclo, const char* sensores) {
+    auto entradaSalida = [&](unsigned long long) {
+        int lugar = est.entrada();
+        est.salida(est.obtenerInstantanea()->lugares[lugar - 1].ticketId);
+    };
+    for (int i = 0; i < 4; i++) entradaSalida(i);
+    reportar(est.capacidad(), ciclo, medir(~0ULL, entradaSalida));
+    reportar(est.capacidad(), sensores, medir(~0ULL, [&](unsigned long long i) {
+        est.conciliarSensores((i & 1) ? 0x3F : 0x00);
+    }));
+}
+
+// Lo que paga cada entrada/salida del servidor por contar
+void medirMetricas() {
+    RegistroMetricas registro;
+    Metrica& contador = registro.contador("benchmark_total", "Contador de prueba");
+    Metrica& medidor = registro.medidor("benchmark_valor", "Medidor de prueba");
+    reportar(0, "metrica sumar", medir(~0ULL, [&](unsigned long long) {
+        contador.sumar();
+    }));
+    reportar(0, "metrica fijar", medir(~0ULL, [&](unsigned long long i) {
+        medidor.fijar((int64_t)i);
+    }));
+    reportar(0, "metricas textoPrometheus", medir(~0ULL, [&](unsigned long long) {
+        string texto = registro.textoPrometheus();
+    }));
+}
+
+// Placas al estilo "ABC1234"; una busqueda exacta, por prefijo de 3 y con un
+// caracter cambiado por cada placa consultada
+string placaSintetica(mt19937& azar) {
+    string placa;
+    for (int i = 0; i < 3; i++) placa += (char)('A' + azar() % 26);
+    for (int i = 0; i < 4; i++) placa += (char)('0' + azar() % 10);
+    return placa;
+}
+
+void medirPlacas(int tamanio) {
+    mt19937 azar(tamanio);
+    vector<string> placas(tamanio);
+    for (string& placa : placas) placa = placaSintetica(azar);
+    IndicePlacas indice;
+    indice.reservar(tamanio);
+    reportar(tamanio, "IndicePlacas agregar", medir(tamanio, [&](unsigned long long i) {
+        indice.agregar(placas[i], (uint32_t)i);
+    }));
+    for (size_t i = indice.totalRegistros(); i < placas.size(); i++) indice.agregar(placas[i], (uint32_t)i);
+
+    vector<string> buscadas(1024), erroneas(1024);
+    for (size_t i = 0; i < buscadas.size(); i++) {
+        buscadas[i] = placas[azar() % tamanio];
+        erroneas[i] = buscadas[i];
+        erroneas[i][azar() % erroneas[i].size()] = 'Z';
+    }
+    vector<uint32_t> resultado;
+    reportar(tamanio, "IndicePlacas exacta", medir(~0ULL, [&](unsigned long long i) {
+        resultado.clear();
+        indice.buscarExacta(buscadas[i % buscadas.size()], resultado, 20);
+    }));
+    reportar(tamanio, "IndicePlacas prefijo", medir(~0ULL, [&](unsigned long long i) {
+        resultado.clear();
+        indice.buscarPrefijo(buscadas[i % buscadas.size()].substr(0, 3), resultado, 20);
+    }));
+    reportar(tamanio, "IndicePlacas aproximada", medir(~0ULL, [&](unsigned long long i) {
+        resultado.clear();
+        indice.buscarAproximada(erroneas[i % erroneas.size()], resultado, 20);
+    }));
+}
+
+// Historial por hora: un ticket cada ~30 s y 1 de cada 100 fuera de orden
+// (hasta una hora atras); consultas de una hora y barrido de estancias largas
+// sobre los activos (la mitad de los tickets, ya salio la otra). Tambien con
+// las salidas en orden de llegada, que es lo comun: sale la mitad mas vieja
+// menos el primer auto, que se queda todo el tiempo
+void medirIndiceTiempo(int tamanio) {
+    mt19937 azar(tamanio);
+    vector<time_t> horas(tamanio);
+    time_t reloj = 1700000000;
+    for (time_t& t : horas) {
+        reloj += azar() % 60;
+        t = azar() % 100 == 0 ? reloj - (time_t)(azar() % 3600) : reloj;
+    }
+    IndiceTiempo entradas, activos;
+    entradas.reservar(tamanio);
+    reportar(tamanio, "IndiceTiempo agregar", medir(tamanio, [&](unsigned long long i) {
+        entradas.agregar(horas[i], (uint32_t)i);
+    }));
+    for (size_t i = entradas.total(); i < horas.size(); i++) entradas.agregar(horas[i], (uint32_t)i);
+    for (size_t i = 0; i < horas.size(); i++) activos.agregar(horas[i], (uint32_t)i);
+    unsigned long long salidas = 0;
+    reportar(tamanio, "IndiceTiempo quitar", medir(tamanio / 2, [&](unsigned long long i) {
+        activos.quitar(horas[i * 2], (uint32_t)(i * 2));
+        salidas++;
+    }));
+    for (size_t i = salidas * 2; i < horas.size(); i += 2) activos.quitar(horas[i], (uint32_t)i);
+
+    vector<uint32_t> resultado;
+    time_t primera = horas[0];
+    reportar(tamanio, "IndiceTiempo rango 1h", medir(~0ULL, [&](unsigned long long) {
+        resultado.clear();
+        time_t desde = primera + (time_t)(azar() % (uint32_t)(reloj - primera + 1));
+        entradas.buscarRango(desde, desde + 3600, resultado, 100);
+    }));
+    reportar(tamanio, "IndiceTiempo estancias largas", medir(~0ULL, [&](unsigned long long) {
+        resultado.clear();
+        activos.buscarAnteriores(reloj - 12 * 3600, resultado, 100);
+    }));
+
+    vector<uint32_t> porLlegada(tamanio);
+    for (int i = 0; i < tamanio; i++) porLlegada[i] = (uint32_t)i;
+    sort(porLlegada.begin(), porLlegada.end(), [&](uint32_t a, uint32_t b) {
+        return horas[a] < horas[b] || (horas[a] == horas[b] && a < b);
+    });
+    IndiceTiempo quedan;
+    for (size_t i = 0; i < horas.size(); i++) quedan.agregar(horas[i], (uint32_t)i);
+    for (int i = 1; i < tamanio / 2; i++) quedan.quitar(horas[porLlegada[i]], porLlegada[i]);
+    reportar(tamanio, "IndiceTiempo largas, en orden", medir(~0ULL, [&](unsigned long long) {
+        resultado.clear();
+        quedan.buscarAnteriores(reloj - 12 * 3600, resultado, 100);
+    }));
+}
+
+// Cada politica sola, con la mitad del lote ocupado: se elige y ocupa un
+// lugar y se libera uno ocupado al azar (el costo de entrada() sin la
+// instantanea). Zonas de 100 cajones, 1 de cada 10 preferente.
+void medirPoliticas(int tamanio) {
+    vector<int> distancias(tamanio), zonaDeCajon(tamanio);
+    vector<bool> preferentes(tamanio);
+    mt19937 azar(tamanio);
+    for (int i = 0; i < tamanio; i++) {
+        distancias[i] = (int)(azar() % 1000);
+        zonaDeCajon[i] = i / 100;
+        preferentes[i] = i % 10 == 0;
+    }
+    const char* nombres[] = {"cercania", "rotacion", "zonas", "preferentes"};
+    for (const char* nombre : nombres) {
+        unique_ptr<PoliticaAsignacion> politica = crearPolitica(nombre, distancias, zonaDeCajon, preferentes);
+        politica->reiniciar(tamanio);
+        vector<int> ocupados;
+        for (int i = 0; i < tamanio; i++) {
+            if (i % 2) politica->disponible(i); else ocupados.push_back(i);
+        }
+        string operacion = string("politica ") + nombre;
+        reportar(tamanio, operacion.c_str(), medir(~0ULL, [&](unsigned long long i) {
+            SolicitudLugar solicitud;
+            solicitud.zona = (int)(i % (tamanio / 100 + 1));
+            solicitud.preferente = (i & 3) == 0;
+            int lugar = politica->elegir(solicitud);
+            if (lugar >= 0) {
+                politica->noDisponible(lugar);
+                ocupados.push_back(lugar);
+            }
+            size_t k = azar() % ocupados.size();
+            politica->disponible(ocupados[k]);
+            ocupados[k] = ocupados.back();
+            ocupados.pop_back();
+        }));
+    }
+}
+
+// Contadores de letreros: 10 niveles con zonas de ~100 cajones; cada
+// operacion cambia un cajon al azar y cada 64 se toman los cambios, como el
+// ciclo del servidor
+void medirJerarquia(int tamanio) {
+    JerarquiaLote jerarquia;
+    int zonasNivel = tamanio / 1000 > 1 ? tamanio / 1000 : 1;
+    int asignados = 0;
+    for (int n = 0; n < 10; n++) {
+        int nivel = jerarquia.agregarNivel("P" + to_string(n + 1));
+        for (int z = 0; z < zonasNivel; z++) {
+            int cajones = (n == 9 && z == zonasNivel - 1) ? tamanio - asignados : tamanio / (10 * zonasNivel);
+            jerarquia.agregarZona(nivel, "Z" + to_string(z), cajones);
+            asignados += cajones;
+        }
+    }
+    vector<char> disponible(tamanio, 0);
+    vector<int> cambiados;
+    mt19937 azar(tamanio);
+    reportar(tamanio, "jerarquia marcar", medir(~0ULL, [&](unsigned long long i) {
+        int cajon = (int)(azar() % tamanio);
+        disponible[cajon] = !disponible[cajon];
+        jerarquia.marcar(cajon, disponible[cajon] != 0);
+        if ((i & 63) == 63) {
+            cambiados.clear();
+            jerarquia.tomarCambios(cambiados);
+        }
+    }));
+}
+
+// Reservas de 1 a 3 horas en los proximos 13 dias sobre tamanio/100
+// cajones (el cajon sale del indice de huecos, sin recorrerlos); una que
+// empieza pronto con el lote lleno salvo el ultimo 1% de los cajones, que
+// antes revisaba todos los ocupados; despues la disponibilidad de ventanas
+// de 2 h, que sale del calendario, y la revision de un cajon
+void medirReservas(int tamanio) {
+    int cajones = tamanio / 100 > 10 ? tamanio / 100 : 10;
+    time_t ahora = 1700000000;
+    mt19937 azar(tamanio);
+    ReservasLugares agenda(cajones, ahora);
+    reportar(tamanio, "Reservas reservar", medir(tamanio, [&](unsigned long long) {
+        time_t inicio = ahora + (time_t)(azar() % (13 * 86400));
+        int lugar;
+        agenda.reservar(inicio, inicio + 3600 + (time_t)(azar() % 7200), "", ahora, lugar);
+    }));
+    for (int lugar = 1; lugar <= cajones; lugar++) agenda.marcarLibre(lugar, lugar > cajones - cajones / 100);
+    reportar(tamanio, "Reservas pronto, lote lleno", medir(~0ULL, [&](unsigned long long) {
+        time_t inicio = ahora + (time_t)(azar() % 1800);
+        int lugar;
+        ReservasLugares::Reserva r;
+        uint32_t id = agenda.reservar(inicio, inicio + 3600, "", ahora, lugar);
+        if (id != 0) agenda.quitar(id, r);
+    }));
+    reportar(tamanio, "Reservas disponibilidad 2h", medir(~0ULL, [&](unsigned long long) {
+        time_t desde = ahora + (time_t)(azar() % (13 * 86400));
+        agenda.disponiblesEn(desde, desde + 7200);
+    }));
+    reportar(tamanio, "Reservas libre", medir(~0ULL, [&](unsigned long long) {
+        time_t desde = ahora + (time_t)(azar() % (13 * 86400));
+        agenda.libre(1 + (int)(azar() % cajones), desde, desde + 3600);
+    }));
+    reportar(tamanio, "Reservas admiteSinReserva", medir(~0ULL, [&](unsigned long long) {
+        agenda.admiteSinReserva(cajones / 2, ahora + (time_t)(azar() % (13 * 86400)), 7200);
+    }));
+}
+
+// Quien llega sin reserva en el limite, 10 cajones: 6 con auto (1, 2 y
+// 5..8) y 4 reservas de 1 a 2 h, que caen en 1..4. Las de 1 y 2 ya cuentan
+// por su auto, asi que con 6 o 7 ocupados entra (queda cajon ademas de
+// 3 y 4) y con 8 no. Sumando todas las reservas se rechazaba desde 6.
+void comprobarAdmisionSinReserva() {
+    time_t ahora = 1700000000;
+    ReservasLugares agenda(10, ahora);
+    int ocupados = 0;
+    auto ocupar = [&](int lugar) {
+        agenda.marcarLibre(lugar, false);
+        agenda.marcarOcupado(lugar, true);
+        ocupados++;
+    };
+    for (int lugar : {1, 2, 5, 6, 7, 8}) ocupar(lugar);
+    int lugar;
+    for (int i = 0; i < 4; i++) agenda.reservar(ahora + 3600, ahora + 7200, "", ahora, lugar);
+    bool conSeis = agenda.admiteSinReserva(ocupados, ahora, 7200);
+    ocupar(9);
+    bool conSiete = agenda.admiteSinReserva(ocupados, ahora, 7200);
+    ocupar(10);
+    bool conOcho = agenda.admiteSinReserva(ocupados, ahora, 7200);
+    printf("%10d  %-28s %s\n", agenda.capacidad(), "admision sin reserva",
+           conSeis && conSiete && !conOcho ? "ok: entra con 6 y 7 ocupados, con 8 no" : "FALLA");
+}
+
+// Un anio de historial de 4 lotes, ~1500 tickets por dia cada uno (~2.2
+// millones de filas), generado al vuelo: la memoria medida es la del
+// exportador. Escribe en el directorio actual y borra al terminar.
+void medirExportacion(const char* nombre, int formatos, bool comprimir) {
+    const int lotes = 4, dias = 365, ticketsDia = 1500;
+    string prefijo = "benchmarkExportacion";
+    ExportadorHistorial exportador;
+    if (!exportador.abrir(prefijo, formatos, comprimir)) {
+        printf("%10d  %-28s no se pudo escribir %s.*\n", 0, nombre, prefijo.c_str());
+        return;
+    }
+    mt19937 azar(7);
+    time_t inicio = 1735711200;  // 2025-01-01 06:00 UTC
+    char ticket[32];
+    string placa;
+    // Sin presupuesto: el anio completo, es lo que se quiere saber
+    typedef chrono::steady_clock Reloj;
+    Reloj::time_point comienzo = Reloj::now();
+    unsigned long long reservasInicio = reservas;
+    unsigned long long total = (unsigned long long)lotes * dias * ticketsDia;
+    for (unsigned long long i = 0; i < total; i++) {
+        int lote = (int)(i % lotes) + 1;
+        unsigned long long n = i / lotes;
+        time_t entrada = inicio + (time_t)(n / ticketsDia) * 86400 + (time_t)(n % ticketsDia) * 40;
+        time_t estancia = 300 + (time_t)(azar() % 14400);
+        snprintf(ticket, sizeof(ticket), "TCK-%d-%08llu", lote, n);
+        placa = placaSintetica(azar);
+        FilaTicket fila = {lote, ticket, placa, (int)(azar() % 500) + 1, entrada,
+                           entrada + estancia, (int64_t)(estancia / 3600 + 1) * 2000};
+        exportador.agregar(fila);
+    }
+    bool ok = exportador.cerrar();
+    double ns = (double)chrono::duration_cast<chrono::nanoseconds>(Reloj::now() - comienzo).count();
+    Resultado r = {total, ns / total, (double)(reservas - reservasInicio) / total};
+    long bytes = 0;
+    const char* extensiones[] = {".csv", ".tkc", "_diario.csv", "_diario.tkc"};
+    for (const char* extension : extensiones) {
+        string ruta = prefijo + extension;
+        FILE* f = fopen(ruta.c_str(), "rb");
+        if (f == nullptr) continue;
+        fseek(f, 0, SEEK_END);
+        bytes += ftell(f);
+        fclose(f);
+        remove(ruta.c_str());
+    }
+    reportar(0, nombre, r);
+    printf("%10s  %-28s %.1f MB en %.2f s%s\n", "", "", bytes / 1e6, ns / 1e9, ok ? "" : " (error al escribir)");
+}
+
+// Analitica: cada evento avanza el reloj sintetico ~1 min; lote de 100 lugares
+void medirAnalitica() {
+    const int lugares = 100;
+    time_t reloj = 1700000000;
+    AnaliticaOcupacion analitica(lugares, reloj);
+    vector<time_t> entradas(lugares, 0);
+    reportar(0, "analitica entrada/salida", medir(~0ULL, [&](unsigned long long i) {
+        int lugar = (int)(i * 37 % lugares);
+        reloj += 60;
+        if (entradas[lugar] == 0) {
+            analitica.entrada(lugar + 1, reloj);
+            entradas[lugar] = reloj;
+        } else {
+            analitica.salida(lugar + 1, entradas[lugar], reloj);
+            entradas[lugar] = 0;
+        }
+    }));
+    volatile double pico = 0;
+    reportar(0, "analitica horaPico", medir(~0ULL, [&](unsigned long long) {
+        time_t inicioHora;
+        double ocupacion;
+        if (analitica.horaPico(reloj, inicioHora, ocupacion)) pico = pico + ocupacion;
+    }));
+}
+
+// Lo que paga estacionamiento01 por cada evento de diagnostico
+void medirTraza() {
+    const char bytes[] = "40\r\n";
+    reportar(0, "trazar evento", medir(~0ULL, [&](unsigned long long i) {
+        TRAZAR(TRAZA_DETALLE, EV_LUGAR_REVISADO, (int32_t)i, 1);
+    }));
+    reportar(0, "trazar evento con texto", medir(~0ULL, [&](unsigned long long i) {
+        TRAZAR_TEXTO(TRAZA_DETALLE, EV_SERIAL_BYTES, (int32_t)i, 0, bytes, sizeof(bytes) - 1);
+    }));
+}
+
+// Como se leian las lineas antes de DecodificadorMega: un string por linea
+// que se copia al clasificarla y los dos primeros digitos que aparezcan
+TramaMega leerTramaAnterior(string linea) {
+    TramaMega trama = {TRAMA_VACIA, -1, 0, 0};
+    while (!linea.empty() && (linea.back() == '\r' || linea.back() == '\n')) linea.pop_back();
+    if (linea.empty()) return trama;
+    if (linea == "P1" || linea == "P2") {
+        trama.tipo = TRAMA_PLUMA;
+        trama.carril = linea[1] - '0';
+        return trama;
+    }
+    if (leerTramaCajones(linea, trama.mapa)) {
+        trama.tipo = TRAMA_CAJONES;
+        return trama;
+    }
+    size_t pos = linea.find_first_of("0123456789");
+    if (pos == string::npos) {
+        trama.tipo = TRAMA_DESCONOCIDA;
+        return trama;
+    }
+    trama.tipo = TRAMA_CODIGO;
+    try { trama.codigo = stoi(linea.substr(pos, 2)); } catch (...) { trama.codigo = -1; }
+    return trama;
+}
+
+// Trafico del MEGA en bloques de 4 KB (lo que trae una lectura grande del
+// puerto): codigos, tramas de cajones y de plumas, y 1 de cada 20 lineas de
+// ruido; cada operacion decodifica un bloque completo
+void medirProtocolo() {
+    const size_t BLOQUE = 4096;
+    const char* lineas[] = {"40\r\n", "30\r\n", "P1\r\n", "P2\r\n", "M3F\r\n", "M05\r\n"};
+    mt19937 azar(7);
+    string trafico;
+    while (trafico.size() < 64 * BLOQUE) {
+        trafico += azar() % 20 == 0 ? "Cajon:4 libre\r\n" : lineas[azar() % 6];
+    }
+    size_t bloques = trafico.size() / BLOQUE;
+
+    DecodificadorMega decodificador;
+    unsigned long long codigos = 0;
+    Resultado nuevo = medir(~0ULL, [&](unsigned long long i) {
+        const char* p = trafico.data() + (i % bloques) * BLOQUE;
+        const char* fin = p + BLOQUE;
+        TramaMega trama;
+        while (decodificador.siguiente(p, fin, trama)) codigos += trama.tipo == TRAMA_CODIGO;
+    });
+    reportar(0, "protocolo decodificar 4KB", nuevo);
+
+    string linea;
+    Resultado anterior = medir(~0ULL, [&](unsigned long long i) {
+        const char* p = trafico.data() + (i % bloques) * BLOQUE;
+        for (size_t j = 0; j < BLOQUE; j++) {
+            if (p[j] != '\n') {
+                linea += p[j];
+                continue;
+            }
+            codigos += leerTramaAnterior(linea).tipo == TRAMA_CODIGO;
+            linea.clear();
+        }
+    });
+    reportar(0, "protocolo anterior 4KB", anterior);
+    // bytes/ns * 1000 = MB/s
+    printf("%10s  protocolo: %.0f MB/s decodificador, %.0f MB/s anterior (%llu codigos)\n", "-",
+           BLOQUE / nuevo.nsPorOperacion * 1000, BLOQUE / anterior.nsPorOperacion * 1000, codigos);
+}
+
+int main(int argc, char* argv[]) {
+    vector<int> tamanios;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--presupuesto" && i + 1 < argc) {
+            presupuestoMs = atof(argv[++i]);
+        } else if (atoi(arg.c_str()) > 1) {
+            tamanios.push_back(atoi(arg.c_str()));
+        } else {
+            fprintf(stderr, "Uso: %s [--presupuesto ms] [tamanio ...]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (tamanios.empty()) tamanios = {1000, 10000, 100000, 1000000};
+
+    printf("%10s  %-28s %10s %14s %12s\n", "tamanio", "operacion", "ops", "ns/op", "reservas/op");
+    medirMetricas();
+    medirTraza();
+    medirProtocolo();
+    medirAnalitica();
+    medirExportacion("exportar csv", ExportadorHistorial::FORMATO_CSV, false);
+    medirExportacion("exportar columnar", ExportadorHistorial::FORMATO_COLUMNAR, false);
+    if (compresionDisponible()) {
+        medirExportacion("exportar columnar zlib", ExportadorHistorial::FORMATO_COLUMNAR, true);
+    }
+    EstacionamientoMega fijo;
+    Estacionamiento dinamico(CAJONES_LOTE);
+    medirLoteChico(fijo, "fijo entrada+salida", "fijo conciliarSensores");
+    medirLoteChico(dinamico, "dinamico entrada+salida", "dinamico conciliarSensores");
+    comprobarAdmisionSinReserva();
+    for (int tamanio : tamanios) {
+        medirMotor(tamanio);
+        medirPoliticas(tamanio);
+        medirJerarquia(tamanio);
+        medirHistorial(tamanio);
+        medirPlacas(tamanio);
+        medirIndiceTiempo(tamanio);
+        medirReservas(tamanio);
+        printf("%10d  memoria residente pico: %ld KB\n", tamanio, memoriaPicoKB());
+    }
+    return 0;
+}
@@ -0,0 +1,50 @@
+// convertirColumnar.cpp
+// Convierte a CSV (en la salida estandar) un archivo .tkc de
+// exportacionHistorial.h, bloque por bloque: sirve para revisar una
+// exportacion o para cargarla donde no se lee el formato por columnas.
+//
+// Uso: convertirColumnar archivo.tkc > archivo.csv
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "../exportacionHistorial.h"
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "Uso: %s archivo.tkc\n", argv[0]);
+        return 1;
+    }
+    LectorColumnar lector;
+    if (!lector.abrir(argv[1])) {
+        fprintf(stderr, "No es un archivo TKC1 valido: %s\n", argv[1]);
+        return 1;
+    }
+    const vector<ColumnaTabla>& columnas = lector.getColumnas();
+    EscritorCsv csv;
+    csv.abrir(stdout, columnas);
+    vector<Celda> celdas(columnas.size());
+    size_t filas = 0;
+    while (lector.siguienteBloque()) {
+        for (size_t f = 0; f < lector.filasBloque(); f++) {
+            for (size_t c = 0; c < columnas.size(); c++) {
+                if (columnas[c].tipo == COLUMNA_TEXTO) {
+                    celdas[c].texto = lector.texto(c, f);
+                } else {
+                    celdas[c].entero = lector.entero(c, f);
+                }
+            }
+            csv.fila(celdas.data());
+        }
+        filas += lector.filasBloque();
+    }
+    csv.cerrar();
+    if (!lector.terminado()) {
+        fprintf(stderr, "Archivo danado o truncado despues de %zu filas\n", filas);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,75 @@
+// decodificarTraza.cpp
+// Convierte a texto el volcado binario de trazaEventos.h (p. ej. el
+// estacionamiento01.trz que deja estacionamiento01 al salir), ordenado por
+// tiempo y con los bytes de control escapados.
+//
+// Uso: decodificarTraza archivo [--nivel N]
+//   --nivel N  solo eventos de ese nivel o mayor (0 DETALLE .. 3 ERROR)
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "../trazaEventos.h"
+
+using namespace std;
+
+string textoEscapado(const RegistroEvento& r) {
+    string texto;
+    for (int i = 0; i < r.largoTexto && i < (int)sizeof(r.texto); i++) {
+        unsigned char c = (unsigned char)r.texto[i];
+        if (c == '\r') texto += "\\r";
+        else if (c == '\n') texto += "\\n";
+        else if (c < 32 || c >= 127) {
+            char hex[8];
+            snprintf(hex, sizeof(hex), "\\x%02X", c);
+            texto += hex;
+        } else texto += (char)c;
+    }
+    return texto;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s archivo [--nivel N]\n", argv[0]);
+        return 1;
+    }
+    int nivelMinimo = 0;
+    for (int i = 2; i < argc; i++) {
+        if (string(argv[i]) == "--nivel" && i + 1 < argc) nivelMinimo = atoi(argv[++i]);
+    }
+
+    FILE* archivo = fopen(argv[1], "rb");
+    if (archivo == nullptr) {
+        perror(argv[1]);
+        return 1;
+    }
+    char cabecera[sizeof(CABECERA_TRAZA_EVENTOS)];
+    if (fread(cabecera, 1, sizeof(cabecera), archivo) != sizeof(cabecera) ||
+        memcmp(cabecera, CABECERA_TRAZA_EVENTOS, sizeof(cabecera)) != 0) {
+        fprintf(stderr, "%s no es una traza de eventos\n", argv[1]);
+        return 1;
+    }
+    vector<RegistroEvento> registros;
+    RegistroEvento r;
+    while (fread(&r, sizeof(r), 1, archivo) == 1) registros.push_back(r);
+    fclose(archivo);
+
+    stable_sort(registros.begin(), registros.end(), [](const RegistroEvento& x, const RegistroEvento& y) {
+        return x.nanosegundos < y.nanosegundos;
+    });
+
+    uint64_t inicio = registros.empty() ? 0 : registros.front().nanosegundos;
+    for (const RegistroEvento& e : registros) {
+        if (e.nivel < nivelMinimo) continue;
+        const char* evento = e.evento < TOTAL_EVENTOS_TRAZA ? NOMBRES_EVENTO_TRAZA[e.evento] : "?";
+        const char* nivel = e.nivel <= TRAZA_ERROR ? NOMBRES_NIVEL_TRAZA[e.nivel] : "?";
+        printf("[%12.3f ms] hilo %u %-7s %-15s a=%d b=%d", (e.nanosegundos - inicio) / 1e6, e.hilo,
+               nivel, evento, e.a, e.b);
+        if (e.largoTexto > 0) printf(" \"%s\"", textoEscapado(e).c_str());
+        printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,197 @@
+// fuzzProtocoloMega.cpp
+// Arnes de fuzzing de protocoloMega.h. Cada entrada son bytes crudos del
+// puerto serial; se decodifican tres veces y las tres deben coincidir:
+//   referencia   una linea a la vez con string y strtol, escrita aparte
+//                a partir de la descripcion del protocolo
+//   de un golpe  DecodificadorMega con todo el bloque
+//   por pedazos  DecodificadorMega con lecturas de 1 a 64 bytes, como
+//                llegan del puerto (trama partida, varias en una lectura)
+// y cada trama debe cumplir lo que promete el tipo (carril 1 o 2, mapa de
+// un byte, codigo de a lo mas MAX_DIGITOS_CODIGO digitos). Una diferencia
+// imprime la entrada y aborta, que es lo que libFuzzer guarda como caso.
+//
+// Con libFuzzer (Clang):
+//   make fuzz  o  cmake -DESTACIONAMIENTO_FUZZ=ON -DCMAKE_CXX_COMPILER=clang++
+//   bin/fuzzProtocoloMega-libfuzzer corpusMega/   (con CMake: bin/fuzzProtocoloMega)
+// Sin libFuzzer (cualquier compilador) el mismo arnes repite los archivos
+// que se le den y despues entradas al azar con semilla fija:
+//   bin/fuzzProtocoloMega [--entradas n] [archivo ...]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cctype>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <random>
+
+#include "../protocoloMega.h"
+
+using namespace std;
+
+// Lo que el protocolo dice de una linea (sin el '\n'), sin DecodificadorMega
+TramaMega tramaReferencia(string linea) {
+    TramaMega trama = {TRAMA_VACIA, -1, 0, 0};
+    if (linea.size() > MAX_TRAMA_MEGA) {
+        trama.tipo = TRAMA_DESCONOCIDA;
+        return trama;
+    }
+    while (!linea.empty() && linea.back() == '\r') linea.pop_back();
+    if (linea.empty()) return trama;
+
+    trama.tipo = TRAMA_DESCONOCIDA;
+    if (linea == "P1" || linea == "P2") {
+        trama.tipo = TRAMA_PLUMA;
+        trama.carril = linea[1] - '0';
+    } else if (linea.size() == 3 && linea[0] == 'M' && isxdigit((unsigned char)linea[1]) &&
+               isxdigit((unsigned char)linea[2])) {
+        trama.tipo = TRAMA_CAJONES;
+        trama.mapa = (unsigned int)strtoul(linea.c_str() + 1, nullptr, 16);
+    } else if (linea.size() <= MAX_DIGITOS_CODIGO &&
+               linea.find_first_not_of("0123456789") == string::npos) {
+        trama.tipo = TRAMA_CODIGO;
+        trama.codigo = (int)strtol(linea.c_str(), nullptr, 10);
+    }
+    return trama;
+}
+
+bool iguales(const TramaMega& a, const TramaMega& b) {
+    if (a.tipo != b.tipo) return false;
+    if (a.tipo == TRAMA_CODIGO) return a.codigo == b.codigo;
+    if (a.tipo == TRAMA_CAJONES) return a.mapa == b.mapa;
+    if (a.tipo == TRAMA_PLUMA) return a.carril == b.carril;
+    return true;
+}
+
+bool valida(const TramaMega& t) {
+    switch (t.tipo) {
+        case TRAMA_CODIGO: return t.codigo >= 0 && t.codigo <= 999999999;
+        case TRAMA_CAJONES: return t.mapa <= 0xFF;
+        case TRAMA_PLUMA: return t.carril == 1 || t.carril == 2;
+        default: return true;
+    }
+}
+
+[[noreturn]] void fallar(const char* motivo, const uint8_t* datos, size_t largo, size_t trama) {
+    fprintf(stderr, "fuzzProtocoloMega: %s en la trama %zu de la entrada:\n", motivo, trama);
+    for (size_t i = 0; i < largo; i++) fprintf(stderr, "%02x%s", datos[i], (i + 1) % 32 ? " " : "\n");
+    fprintf(stderr, "\n");
+    abort();
+}
+
+// Tramas de 'datos' (lineas completas y, con 'terminar', la ultima sin '\n')
+// entregando al decodificador pedazos de 'pedazos[i]' bytes por turno
+void decodificar(const uint8_t* datos, size_t largo, const vector<size_t>& pedazos, bool terminar,
+                 vector<TramaMega>& tramas) {
+    DecodificadorMega decodificador;
+    const char* p = (const char*)datos;
+    const char* fin = p + largo;
+    TramaMega trama;
+    size_t turno = 0;
+    while (p < fin) {
+        const char* finPedazo = p + pedazos[turno++ % pedazos.size()];
+        if (finPedazo > fin) finPedazo = fin;
+        while (decodificador.siguiente(p, finPedazo, trama)) tramas.push_back(trama);
+    }
+    if (terminar && decodificador.terminar(trama)) tramas.push_back(trama);
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* datos, size_t largo) {
+    // El primer byte decide si la ultima linea se entrega sin '\n'
+    bool terminar = largo > 0 && (datos[0] & 1);
+
+    vector<TramaMega> esperadas;
+    size_t inicio = 0;
+    for (size_t i = 0; i < largo; i++) {
+        if (datos[i] != '\n') continue;
+        esperadas.push_back(tramaReferencia(string((const char*)datos + inicio, i - inicio)));
+        inicio = i + 1;
+    }
+    if (terminar && inicio < largo) {
+        esperadas.push_back(tramaReferencia(string((const char*)datos + inicio, largo - inicio)));
+    }
+
+    // Pedazos de 1..64 bytes, repetibles para la misma entrada
+    vector<size_t> pedazos;
+    uint32_t semilla = 2166136261u;
+    for (size_t i = 0; i < largo; i++) semilla = (semilla ^ datos[i]) * 16777619u;
+    for (int i = 0; i < 16; i++) {
+        semilla = semilla * 1103515245u + 12345u;
+        pedazos.push_back(1 + (semilla >> 16) % 64);
+    }
+
+    vector<TramaMega> deUnGolpe, porPedazos;
+    decodificar(datos, largo, vector<size_t>(1, largo > 0 ? largo : 1), terminar, deUnGolpe);
+    decodificar(datos, largo, pedazos, terminar, porPedazos);
+
+    if (deUnGolpe.size() != esperadas.size() || porPedazos.size() != esperadas.size()) {
+        fallar("numero de tramas distinto", datos, largo, esperadas.size());
+    }
+    for (size_t i = 0; i < esperadas.size(); i++) {
+        if (!valida(deUnGolpe[i])) fallar("trama invalida", datos, largo, i);
+        if (!iguales(deUnGolpe[i], esperadas[i])) fallar("difiere de la referencia", datos, largo, i);
+        if (!iguales(porPedazos[i], esperadas[i])) fallar("difiere al leer por pedazos", datos, largo, i);
+    }
+
+    // leerTramaMega sobre la linea sin copiar debe dar lo mismo que la referencia
+    if (largo > 0 && largo <= MAX_TRAMA_MEGA && memchr(datos, '\n', largo) == nullptr) {
+        TramaMega directa = leerTramaMega((const char*)datos, largo);
+        if (!iguales(directa, tramaReferencia(string((const char*)datos, largo)))) {
+            fallar("leerTramaMega difiere de la referencia", datos, largo, 0);
+        }
+    }
+    return 0;
+}
+
+#ifndef ESTACIONAMIENTO_LIBFUZZER
+// Entradas parecidas a lo que llega por el puerto: tramas validas, casi
+// validas ("4", "400", "M4", "P3", "Cajon:4") y bytes cualesquiera
+vector<uint8_t> entradaAlAzar(mt19937& azar) {
+    static const char* piezas[] = {"40", "30", "4", "400", "0", "M", "MFF", "M3f", "M4", "P1", "P2", "P3",
+                                   "Cajon:4", " ", "\r", "\n", "\r\n", "1234567890", "999999999"};
+    vector<uint8_t> entrada;
+    int total = (int)(azar() % 24);
+    for (int i = 0; i < total; i++) {
+        if (azar() % 4 == 0) {
+            entrada.push_back((uint8_t)azar());
+        } else {
+            const char* pieza = piezas[azar() % (sizeof(piezas) / sizeof(piezas[0]))];
+            entrada.insert(entrada.end(), pieza, pieza + strlen(pieza));
+        }
+        if (azar() % 3 == 0) entrada.push_back('\n');
+    }
+    return entrada;
+}
+
+int main(int argc, char* argv[]) {
+    long entradas = 200000;
+    size_t archivos = 0;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--entradas" && i + 1 < argc) {
+            entradas = atol(argv[++i]);
+            continue;
+        }
+        FILE* archivo = fopen(argv[i], "rb");
+        if (archivo == nullptr) {
+            fprintf(stderr, "No se pudo abrir %s\n", argv[i]);
+            return 1;
+        }
+        vector<uint8_t> datos;
+        int c;
+        while ((c = fgetc(archivo)) != EOF) datos.push_back((uint8_t)c);
+        fclose(archivo);
+        LLVMFuzzerTestOneInput(datos.data(), datos.size());
+        archivos++;
+    }
+
+    mt19937 azar(12345);
+    for (long i = 0; i < entradas; i++) {
+        vector<uint8_t> datos = entradaAlAzar(azar);
+        LLVMFuzzerTestOneInput(datos.data(), datos.size());
+    }
+    printf("%zu archivos y %ld entradas al azar sin diferencias\n", archivos, entradas);
+    return 0;
+}
+#endif
@@ -0,0 +1,375 @@
+// reproducirTraza.cpp
+// Generador de carga para el controlador: hace el papel del MEGA sobre un
+// pty y le manda las tramas de una traza grabada (servidorEstacionamiento
+// --grabar) o de una hora pico sintetica, acelerada de 1x a 1000x, y
+// verifica que las respuestas del controlador sean las de la traza.
+// Solo POSIX (pty); el controlador se arranca aparte, recien iniciado.
+//
+// Uso: reproducirTraza (--traza archivo | --hora-pico minutos) [opciones]
+//   --velocidad N      N veces mas rapido que la traza (0 = sin pausas; 1 por defecto)
+//   --enlace ruta      enlace simbolico al pty (/tmp/ttyREPRODUCTOR por defecto)
+//   --socket ruta      socket del servidor: hace de cajero en cada salida ("30")
+//   --guardar archivo  guarda la traza sintetica generada
+//   --llegadas N       autos en la hora pico (300)
+//   --capacidad N      lugares del controlador (6)
+//   --estancia min     estancia promedio (20)
+//   --semilla N        semilla del generador (1)
+//
+// Ejemplo:
+//   servidorEstacionamiento /tmp/e.sock /tmp/ttyREPRODUCTOR &
+//   reproducirTraza --hora-pico 120 --velocidad 1000 --socket /tmp/e.sock
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <deque>
+#include <queue>
+#include <random>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <termios.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "../trazaSerial.h"
+#include "../histogramaLatencia.h"
+
+using namespace std;
+
+const uint64_t ESPERA_FINAL_US = 2000000;  // respuestas tardias al terminar
+const int ESPERA_CAJERO_MS = 2000;
+const int CAJONES_TRAMA = 6;               // bits de la trama "Mxx" del MEGA
+
+// --------------------------- Hora pico sintetica ------------------------------
+struct EventoSintetico {
+    uint64_t microsegundos;
+    int tipo;   // 0 llegada, 1 salida, 2 trama de cajones
+    bool operator>(const EventoSintetico& otro) const { return microsegundos > otro.microsegundos; }
+};
+
+string textoMapa(unsigned int mapa) {
+    char buffer[8];
+    snprintf(buffer, sizeof(buffer), "M%02X", mapa & 0xFF);
+    return buffer;
+}
+
+// Llegadas de Poisson con una campana a la mitad de la ventana (por
+// adelgazamiento), estancias exponenciales y el refresco "Mxx" cada 2 s.
+// Las respuestas esperadas siguen la ocupacion: "1" si hay lugar, "0" si no.
+vector<RegistroTraza> horaPico(double minutos, int llegadas, int capacidad, double estanciaMin, unsigned semilla) {
+    mt19937 azar(semilla);
+    uniform_real_distribution<double> uniforme(0.0, 1.0);
+    double duracionUs = minutos * 60e6;
+    double sigma = duracionUs / 6;
+    auto intensidad = [&](double t) {
+        double z = (t - duracionUs / 2) / sigma;
+        return 0.25 + exp(-z * z);
+    };
+    // Integral aproximada de la intensidad para escalar a 'llegadas'
+    double integral = 0;
+    for (int i = 0; i < 1000; i++) integral += intensidad((i + 0.5) * duracionUs / 1000) * duracionUs / 1000;
+    double tasaMaxima = 1.25 * llegadas / integral;  // por us
+
+    priority_queue<EventoSintetico, vector<EventoSintetico>, greater<EventoSintetico> > eventos;
+    exponential_distribution<double> entreLlegadas(tasaMaxima);
+    for (double t = entreLlegadas(azar); t < duracionUs; t += entreLlegadas(azar)) {
+        if (uniforme(azar) * 1.25 <= intensidad(t)) eventos.push({(uint64_t)t, 0});
+    }
+    for (uint64_t t = 2000000; t < (uint64_t)duracionUs; t += 2000000) eventos.push({t, 2});
+
+    exponential_distribution<double> estancia(1.0 / (estanciaMin * 60e6));
+    vector<RegistroTraza> traza;
+    deque<int> cajonesAutos;  // cajon de cada auto, en orden de llegada
+    unsigned int mapa = 0;
+    int ocupados = 0;
+    while (!eventos.empty()) {
+        EventoSintetico e = eventos.top();
+        eventos.pop();
+        if (e.tipo == 0) {
+            traza.push_back({e.microsegundos, false, "40"});
+            if (ocupados < capacidad) {
+                ocupados++;
+                traza.push_back({e.microsegundos + 1000, true, "1"});
+                traza.push_back({e.microsegundos + 200000, false, "P1"});
+                int cajon = 0;
+                while (cajon < CAJONES_TRAMA && (mapa & (1u << cajon))) cajon++;
+                if (cajon < CAJONES_TRAMA) mapa |= 1u << cajon;
+                cajonesAutos.push_back(cajon);
+                eventos.push({e.microsegundos + (uint64_t)estancia(azar) + 1000000, 1});
+            } else {
+                traza.push_back({e.microsegundos + 1000, true, "0"});
+            }
+        } else if (e.tipo == 1) {
+            // El cajero cobra el ticket mas antiguo
+            ocupados--;
+            if (cajonesAutos.front() < CAJONES_TRAMA) mapa &= ~(1u << cajonesAutos.front());
+            cajonesAutos.pop_front();
+            traza.push_back({e.microsegundos, false, "30"});
+            traza.push_back({e.microsegundos + 1000, true, "2"});
+            traza.push_back({e.microsegundos + 200000, false, "P2"});
+        } else {
+            traza.push_back({e.microsegundos, false, textoMapa(mapa)});
+        }
+    }
+    stable_sort(traza.begin(), traza.end(), [](const RegistroTraza& a, const RegistroTraza& b) {
+        return a.microsegundos < b.microsegundos;
+    });
+    return traza;
+}
+
+// --------------------------- Cajero por el socket ------------------------------
+class Cajero {
+private:
+    int s;
+    string recibido;
+    deque<string> tickets;
+
+    // Siguiente linea del servidor, o "" si se agota la espera
+    string leerLinea(int esperaMs) {
+        uint64_t limite = microsegundosAhora() + (uint64_t)esperaMs * 1000;
+        while (true) {
+            size_t fin = recibido.find('\n');
+            if (fin != string::npos) {
+                string linea = recibido.substr(0, fin);
+                recibido.erase(0, fin + 1);
+                // "evento entrada <lugar> <ticket>"
+                if (linea.compare(0, 15, "evento entrada ") == 0) {
+                    tickets.push_back(linea.substr(linea.rfind(' ') + 1));
+                }
+                return linea;
+            }
+            uint64_t ahora = microsegundosAhora();
+            if (ahora >= limite) return "";
+            pollfd p = {s, POLLIN, 0};
+            if (poll(&p, 1, (int)((limite - ahora) / 1000) + 1) <= 0) continue;
+            char buffer[4096];
+            ssize_t n = read(s, buffer, sizeof(buffer));
+            if (n <= 0) return "";
+            recibido.append(buffer, n);
+        }
+    }
+
+    bool enviar(const string& linea) {
+        string texto = linea + "\n";
+        return write(s, texto.data(), texto.size()) == (ssize_t)texto.size();
+    }
+
+public:
+    Cajero() : s(-1) {}
+
+    bool conectar(const string& ruta) {
+        sockaddr_un direccion;
+        memset(&direccion, 0, sizeof(direccion));
+        direccion.sun_family = AF_UNIX;
+        strncpy(direccion.sun_path, ruta.c_str(), sizeof(direccion.sun_path) - 1);
+        // El servidor abre el serial antes de escuchar: se reintenta un momento
+        for (int intento = 0; intento < 50; intento++) {
+            if (s >= 0) close(s);
+            s = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (s >= 0 && connect(s, (sockaddr*)&direccion, sizeof(direccion)) == 0) break;
+            usleep(100000);
+        }
+        return enviar("suscribir") && leerLinea(ESPERA_CAJERO_MS) == "ok";
+    }
+
+    bool activo() const {
+        return s >= 0;
+    }
+
+    // Despues de un "30": espera el aviso y cobra el ticket mas antiguo
+    bool cobrar() {
+        string linea;
+        while ((linea = leerLinea(ESPERA_CAJERO_MS)) != "evento espera_salida") {
+            if (linea.empty()) return false;
+        }
+        if (tickets.empty()) return false;
+        string ticket = tickets.front();
+        tickets.pop_front();
+        if (!enviar("salida " + ticket)) return false;
+        while ((linea = leerLinea(ESPERA_CAJERO_MS)).compare(0, 3, "ok ") != 0) {
+            if (linea.empty() || linea.compare(0, 6, "error ") == 0) return false;
+        }
+        return true;
+    }
+
+    ~Cajero() {
+        if (s >= 0) close(s);
+    }
+};
+
+// --------------------------- Reproduccion ------------------------------
+struct RespuestaEsperada {
+    string trama;
+    uint64_t enviada;  // us en que se mando la trama que la provoca
+};
+
+int abrirPty(const string& enlace) {
+    int maestro = posix_openpt(O_RDWR | O_NOCTTY);
+    if (maestro < 0 || grantpt(maestro) != 0 || unlockpt(maestro) != 0) {
+        perror("posix_openpt");
+        exit(1);
+    }
+    termios modo;
+    tcgetattr(maestro, &modo);
+    cfmakeraw(&modo);
+    tcsetattr(maestro, TCSANOW, &modo);
+    fcntl(maestro, F_SETFL, fcntl(maestro, F_GETFL) | O_NONBLOCK);
+
+    const char* esclavo = ptsname(maestro);
+    unlink(enlace.c_str());
+    if (symlink(esclavo, enlace.c_str()) != 0) perror("symlink");
+
+    // Igual que el simulador: POLLHUP mientras nadie abra el esclavo
+    close(open(esclavo, O_RDWR | O_NOCTTY));
+    fprintf(stderr, "Esperando que el controlador abra %s (%s)...\n", enlace.c_str(), esclavo);
+    while (true) {
+        pollfd p = {maestro, POLLIN, 0};
+        poll(&p, 1, 100);
+        if (!(p.revents & POLLHUP)) break;
+    }
+    return maestro;
+}
+
+int main(int argc, char* argv[]) {
+    string rutaTraza, rutaGuardar, rutaSocket, enlace = "/tmp/ttyREPRODUCTOR";
+    double velocidad = 1, minutosPico = 0, estancia = 20;
+    int llegadas = 300, capacidad = 6;
+    unsigned semilla = 1;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool valor = i + 1 < argc;
+        if (arg == "--traza" && valor) rutaTraza = argv[++i];
+        else if (arg == "--hora-pico" && valor) minutosPico = atof(argv[++i]);
+        else if (arg == "--velocidad" && valor) velocidad = atof(argv[++i]);
+        else if (arg == "--enlace" && valor) enlace = argv[++i];
+        else if (arg == "--socket" && valor) rutaSocket = argv[++i];
+        else if (arg == "--guardar" && valor) rutaGuardar = argv[++i];
+        else if (arg == "--llegadas" && valor) llegadas = atoi(argv[++i]);
+        else if (arg == "--capacidad" && valor) capacidad = atoi(argv[++i]);
+        else if (arg == "--estancia" && valor) estancia = atof(argv[++i]);
+        else if (arg == "--semilla" && valor) semilla = (unsigned)atoi(argv[++i]);
+        else {
+            fprintf(stderr, "Uso: %s (--traza archivo | --hora-pico minutos) [--velocidad N] [--enlace ruta]\n"
+                            "       [--socket ruta] [--guardar archivo] [--llegadas N] [--capacidad N]\n"
+                            "       [--estancia min] [--semilla N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    vector<RegistroTraza> traza;
+    if (!rutaTraza.empty()) {
+        if (!leerTraza(rutaTraza, traza)) {
+            fprintf(stderr, "Traza invalida o incompleta: %s (se usan %zu registros)\n",
+                    rutaTraza.c_str(), traza.size());
+            if (traza.empty()) return 1;
+        }
+    } else if (minutosPico > 0) {
+        traza = horaPico(minutosPico, llegadas, capacidad, estancia, semilla);
+        if (!rutaGuardar.empty()) {
+            GrabadorTraza grabador;
+            if (!grabador.abrir(rutaGuardar)) {
+                perror(rutaGuardar.c_str());
+                return 1;
+            }
+            for (const RegistroTraza& r : traza) grabador.registrarEn(r.microsegundos, r.haciaMega, r.trama);
+        }
+    } else {
+        fprintf(stderr, "Falta --traza o --hora-pico\n");
+        return 1;
+    }
+
+    int maestro = abrirPty(enlace);
+    Cajero cajero;
+    if (!rutaSocket.empty() && !cajero.conectar(rutaSocket)) {
+        fprintf(stderr, "No se pudo conectar como cajero a %s\n", rutaSocket.c_str());
+        return 1;
+    }
+
+    deque<RespuestaEsperada> esperadas;
+    HistogramaLatencia latencia;
+    unsigned long long enviadas = 0, correctas = 0, distintas = 0, inesperadas = 0, cobrosFallidos = 0;
+    string lineaRecibida;
+
+    auto leerRespuestas = [&]() {
+        char buffer[4096];
+        ssize_t n;
+        while ((n = read(maestro, buffer, sizeof(buffer))) > 0) {
+            uint64_t ahora = microsegundosAhora();
+            for (ssize_t i = 0; i < n; i++) {
+                if (buffer[i] != '\n') {
+                    if (buffer[i] != '\r') lineaRecibida += buffer[i];
+                    continue;
+                }
+                if (esperadas.empty()) {
+                    inesperadas++;
+                    fprintf(stderr, "Respuesta inesperada: \"%s\"\n", lineaRecibida.c_str());
+                } else {
+                    const RespuestaEsperada& e = esperadas.front();
+                    if (e.trama == lineaRecibida) {
+                        correctas++;
+                    } else {
+                        distintas++;
+                        fprintf(stderr, "Se esperaba \"%s\" y llego \"%s\"\n", e.trama.c_str(), lineaRecibida.c_str());
+                    }
+                    latencia.registrar(ahora - e.enviada);
+                    esperadas.pop_front();
+                }
+                lineaRecibida.clear();
+            }
+        }
+    };
+
+    uint64_t inicio = microsegundosAhora();
+    uint64_t ultimaEnviada = 0;
+    for (size_t i = 0; i < traza.size(); i++) {
+        const RegistroTraza& r = traza[i];
+        if (r.haciaMega) {
+            esperadas.push_back({r.trama, ultimaEnviada});
+            continue;
+        }
+        uint64_t objetivo = velocidad > 0 ? inicio + (uint64_t)(r.microsegundos / velocidad) : 0;
+        while (true) {
+            leerRespuestas();
+            uint64_t ahora = microsegundosAhora();
+            if (ahora >= objetivo) break;
+            pollfd p = {maestro, POLLIN, 0};
+            poll(&p, 1, (int)((objetivo - ahora) / 1000));
+        }
+
+        string linea = r.trama + "\n";
+        if (write(maestro, linea.data(), linea.size()) != (ssize_t)linea.size()) {
+            perror("write");
+            return 1;
+        }
+        ultimaEnviada = microsegundosAhora();
+        enviadas++;
+        if (r.trama == "30" && cajero.activo() && !cajero.cobrar()) cobrosFallidos++;
+    }
+
+    uint64_t finEnvio = microsegundosAhora();
+    while (!esperadas.empty() && microsegundosAhora() - finEnvio < ESPERA_FINAL_US) {
+        pollfd p = {maestro, POLLIN, 0};
+        poll(&p, 1, 10);
+        leerRespuestas();
+    }
+    double segundos = (microsegundosAhora() - inicio) / 1e6;
+
+    printf("Tramas enviadas: %llu en %.2f s (%.0f tramas/s), velocidad %gx\n",
+           enviadas, segundos, enviadas / segundos, velocidad);
+    printf("Respuestas: %llu correctas, %llu distintas, %zu faltantes, %llu inesperadas\n",
+           correctas, distintas, esperadas.size(), inesperadas);
+    if (cajero.activo()) printf("Cobros fallidos: %llu\n", cobrosFallidos);
+    printf("Latencia de respuesta (ms): p50 %.2f  p90 %.2f  p99 %.2f  max %.2f\n",
+           latencia.percentil(50) / 1000.0, latencia.percentil(90) / 1000.0,
+           latencia.percentil(99) / 1000.0, latencia.valorMaximo() / 1000.0);
+
+    close(maestro);
+    unlink(enlace.c_str());
+    bool correcto = distintas == 0 && esperadas.empty() && inesperadas == 0 && cobrosFallidos == 0;
+    return correcto ? 0 : 1;
+}
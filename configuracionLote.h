@@ -0,0 +1,187 @@
+#ifndef CONFIGURACION_LOTE_H
+#define CONFIGURACION_LOTE_H
+
+#include <cmath>
+#include <ctime>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <sys/stat.h>
+
+using namespace std;
+
+// ==================== CONFIGURACION DEL LOTE ====================
+// Lo que antes iba compilado (tarifa, capacidad, puertos, velocidad) en un
+// archivo de texto que el servidor vuelve a leer cuando cambia, sin
+// reiniciar ni perder los tickets; los frentes de consola lo leen solo al
+// arrancar (ver configurarConsola). Una clave por linea, '#' comenta:
+//
+//   tarifa_hora = 20
+//   minutos_gratis = 15
+//   capacidad = 6                  solo crece: los cajones nuevos van al final
+//                                  (las consolas del MEGA la tienen fija)
+//   niveles = P1:A=4;P2:B=2        ver JerarquiaLote::desdeTexto
+//   politica = rotacion            ver --politica del servidor
+//   puertos = /dev/ttyACM0,COM3    se prueban en orden
+//   baudios = 9600
+//
+// Las claves que no aparecen se quedan como estaban (combinar()).
+struct ConfiguracionLote {
+    float tarifaHora = -1;    // <0: no viene
+    int minutosGratis = -1;   // <0: no viene
+    int capacidad = 0;        // 0: no viene
+    string niveles;
+    string politica;
+    vector<string> puertos;
+    int baudios = 0;          // 0: no viene
+
+    static string recortar(const string& texto) {
+        size_t inicio = texto.find_first_not_of(" \t\r");
+        if (inicio == string::npos) return "";
+        size_t fin = texto.find_last_not_of(" \t\r");
+        return texto.substr(inicio, fin - inicio + 1);
+    }
+
+    // Entero completo y positivo; false si sobra texto
+    static bool leerEntero(const string& texto, int& valor) {
+        char* fin = nullptr;
+        long numero = strtol(texto.c_str(), &fin, 10);
+        if (texto.empty() || *fin != '\0' || numero <= 0 || numero > 10000000) return false;
+        valor = (int)numero;
+        return true;
+    }
+
+    // Interpreta todo el texto o nada: con un error, 'resultado' no cambia y
+    // 'error' dice la linea
+    static bool interpretar(istream& entrada, ConfiguracionLote& resultado, string& error) {
+        ConfiguracionLote leida;
+        string linea;
+        int numeroLinea = 0;
+        while (getline(entrada, linea)) {
+            numeroLinea++;
+            size_t comentario = linea.find('#');
+            if (comentario != string::npos) linea.erase(comentario);
+            linea = recortar(linea);
+            if (linea.empty()) continue;
+
+            size_t igual = linea.find('=');
+            string clave = recortar(linea.substr(0, igual));
+            string valor = igual == string::npos ? "" : recortar(linea.substr(igual + 1));
+            error = "linea " + to_string(numeroLinea) + ": " + clave;
+            if (igual == string::npos || valor.empty()) return false;
+
+            if (clave == "tarifa_hora") {
+                char* fin = nullptr;
+                leida.tarifaHora = strtof(valor.c_str(), &fin);
+                // strtof tambien acepta "nan" e "inf"
+                if (*fin != '\0' || !isfinite(leida.tarifaHora) || leida.tarifaHora < 0) return false;
+            } else if (clave == "minutos_gratis") {
+                if (valor == "0") {
+                    leida.minutosGratis = 0;
+                } else if (!leerEntero(valor, leida.minutosGratis)) {
+                    return false;
+                }
+            } else if (clave == "capacidad") {
+                if (!leerEntero(valor, leida.capacidad)) return false;
+            } else if (clave == "niveles") {
+                leida.niveles = valor;
+            } else if (clave == "politica") {
+                leida.politica = valor;
+            } else if (clave == "puertos") {
+                istringstream lista(valor);
+                string puerto;
+                while (getline(lista, puerto, ',')) {
+                    puerto = recortar(puerto);
+                    if (!puerto.empty()) leida.puertos.push_back(puerto);
+                }
+                if (leida.puertos.empty()) return false;
+            } else if (clave == "baudios") {
+                if (!leerEntero(valor, leida.baudios)) return false;
+            } else {
+                error = "linea " + to_string(numeroLinea) + ": clave desconocida " + clave;
+                return false;
+            }
+        }
+        error.clear();
+        resultado = leida;
+        return true;
+    }
+
+    static bool leer(const string& ruta, ConfiguracionLote& resultado, string& error) {
+        ifstream archivo(ruta);
+        if (!archivo) {
+            error = "no se pudo abrir " + ruta;
+            return false;
+        }
+        return interpretar(archivo, resultado, error);
+    }
+
+    // Esta configuracion con lo que traiga 'cambios' encima
+    ConfiguracionLote combinar(const ConfiguracionLote& cambios) const {
+        ConfiguracionLote resultado = *this;
+        if (cambios.tarifaHora >= 0) resultado.tarifaHora = cambios.tarifaHora;
+        if (cambios.minutosGratis >= 0) resultado.minutosGratis = cambios.minutosGratis;
+        if (cambios.capacidad > 0) resultado.capacidad = cambios.capacidad;
+        if (!cambios.niveles.empty()) resultado.niveles = cambios.niveles;
+        if (!cambios.politica.empty()) resultado.politica = cambios.politica;
+        if (!cambios.puertos.empty()) resultado.puertos = cambios.puertos;
+        if (cambios.baudios > 0) resultado.baudios = cambios.baudios;
+        return resultado;
+    }
+};
+
+// Avisa cuando el archivo cambia de fecha o de tamanio. Es un stat() por
+// revision, sin hilos ni inotify, para que el servidor lo pregunte en su
+// mismo ciclo en Windows y en POSIX. La fecha tiene resolucion de segundos:
+// dos guardados en el mismo segundo con el mismo tamanio se ven como uno.
+class VigilanteArchivo {
+private:
+    string ruta;
+    bool existia;
+    time_t fecha;
+    long long tamanio;
+
+    bool leerEstado(bool& existe, time_t& f, long long& t) const {
+        struct stat info;
+        existe = stat(ruta.c_str(), &info) == 0;
+        f = existe ? info.st_mtime : 0;
+        t = existe ? (long long)info.st_size : 0;
+        return existe;
+    }
+
+public:
+    VigilanteArchivo() : existia(false), fecha(0), tamanio(0) {}
+
+    // Empieza a vigilar 'archivo' tomando su estado actual como visto
+    void vigilar(const string& archivo) {
+        ruta = archivo;
+        leerEstado(existia, fecha, tamanio);
+    }
+
+    bool activo() const {
+        return !ruta.empty();
+    }
+
+    // true una vez por cada cambio; un archivo borrado no cuenta (se espera
+    // a que vuelva a aparecer)
+    bool cambio() {
+        if (ruta.empty()) return false;
+        bool existe;
+        time_t f;
+        long long t;
+        leerEstado(existe, f, t);
+        bool distinto = existe && (!existia || f != fecha || t != tamanio);
+        existia = existe;
+        fecha = f;
+        tamanio = t;
+        return distinto;
+    }
+
+    const string& archivo() const {
+        return ruta;
+    }
+};
+
+#endif
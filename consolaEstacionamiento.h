@@ -0,0 +1,165 @@
+#ifndef CONSOLA_ESTACIONAMIENTO_H
+#define CONSOLA_ESTACIONAMIENTO_H
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <fstream>
+
+#include "estacionamiento.h"
+#include "configuracionLote.h"
+#include "serialController.h"
+
+using namespace std;
+
+// ==================== PANTALLAS DE CONSOLA ====================
+// Lo unico del frente de consola que dependia del sistema era limpiar la
+// pantalla; el resto solo lee la instantanea del nucleo.
+inline void limpiarPantalla() {
+#ifdef _WIN32
+    system("cls");
+#else
+    cout << "\033[2J\033[H";
+#endif
+}
+
+template <int N>
+void mostrarEstado(const EstacionamientoLote<N>& est) {
+    shared_ptr<const BaseEstacionamiento::Instantanea> vista = est.obtenerInstantanea();
+
+    limpiarPantalla();
+    cout << "==========================================" << endl;
+    cout << "    SISTEMA DE ESTACIONAMIENTO - v5.0" << endl;
+    cout << "==========================================" << endl;
+    
+    for (int i = 0; i < (int)vista->lugares.size(); i++) {
+        const BaseEstacionamiento::Lugar& lugar = vista->lugares[i];
+        string discrepancia = BaseEstacionamiento::textoDiscrepancia(*vista, i);
+        cout << " " << est.etiquetaLugar(i + 1) << ": " 
+             << (lugar.ocupado ? "OCUPADO (" + lugar.ticketId + ")" : lugar.apartado ? "RESERVADO" : "LIBRE") 
+             << (discrepancia.empty() ? "" : "  ! " + discrepancia)
+             << endl;
+    }
+    
+    cout << "------------------------------------------" << endl;
+    cout << "           Estado: " << vista->ocupados << "/" << vista->lugares.size() << " ocupados" << endl;
+    cout << " Contador tickets: " << vista->contadorTickets << endl;
+    cout << "     Mapa tickets: " << vista->ticketToLugar.size() << " registros" << endl;
+    cout <<           " Tarifa: $" << est.getTarifaPorHora() << " por hora" << endl;
+    cout << "------------------------------------------" << endl;
+    cout << "\n Comandos:" << endl;
+    cout << "   E - Entrada vehiculo" << endl;
+    cout << "   S - Salida vehiculo" << endl; 
+    cout << "   I - Informacion de Ticket" << endl; 
+    cout << "   D - Debug completo" << endl;
+    cout << "   R - Reparar inconsistencias" << endl;
+    cout << "   F - Forzar liberacion de lugar" << endl;
+    cout << "   Q - Salir" << endl;
+    cout << "==========================================" << endl;
+}
+
+template <int N>
+void debugCompleto(const EstacionamientoLote<N>& est) {
+    shared_ptr<const BaseEstacionamiento::Instantanea> vista = est.obtenerInstantanea();
+
+    limpiarPantalla();
+    cout << "=== DEBUG COMPLETO ===" << endl;
+    cout << "Capacidad: " << vista->lugares.size() << endl;
+    cout << "Contador tickets: " << vista->contadorTickets << endl;
+    cout << "Tickets en mapa: " << vista->ticketToLugar.size() << endl;
+    cout << "Tarifa por hora: $" << est.getTarifaPorHora() << endl;
+    cout << "Version estado: " << vista->version << endl;
+    cout << "Sensores de cajones: " << (vista->sensoresActivos ? "activos" : "sin datos") << endl;
+    cout << endl;
+    
+    cout << "ESTADO LUGARES:" << endl;
+    time_t ahora = time(nullptr);
+    for (int i = 0; i < (int)vista->lugares.size(); i++) {
+        const BaseEstacionamiento::Lugar& lugar = vista->lugares[i];
+        cout << "Lugar " << est.etiquetaLugar(i + 1) << ": ";
+        if (lugar.ocupado) {
+            cout << "OCUPADO por " << lugar.ticketId;
+            // Calcular tiempo transcurrido
+            double minutos = difftime(ahora, lugar.horaEntrada) / 60.0;
+            cout << " (Tiempo: " << fixed << setprecision(1) << minutos << " min)";
+            
+            int indexado;
+            if (vista->ticketToLugar.buscar(lugar.ticketId, vista->lugares, indexado) && indexado == i) {
+                cout << " ✓ CONSISTENTE";
+            } else {
+                cout << " ✗ INCONSISTENTE";
+            }
+        } else {
+            cout << (lugar.apartado ? "RESERVADO" : "LIBRE");
+        }
+        string discrepancia = BaseEstacionamiento::textoDiscrepancia(*vista, i);
+        if (!discrepancia.empty()) {
+            cout << " ! " << discrepancia;
+        }
+        cout << endl;
+    }
+    
+    cout << endl << "MAPA TICKETS:" << endl;
+    vista->ticketToLugar.recorrer([&](int lugar) {
+        cout << "  " << vista->lugares[lugar].ticketId << " -> Lugar " << est.etiquetaLugar(lugar + 1) << endl;
+    });
+    
+    cout << endl << "Presione cualquier tecla para continuar...";
+}
+
+// Archivo de configuracion de los frentes de consola si no se da otro
+const char* const CONFIGURACION_CONSOLA = "estacionamiento.cfg";
+
+// Tarifa, capacidad, niveles, politica, puertos y baudios del archivo (ver
+// configuracionLote.h), una sola vez al arrancar: solo el servidor lo
+// vuelve a leer cuando cambia. Si el archivo no existe se queda lo
+// compilado (CAJONES_LOTE, la tarifa del motor y puertosPorOmision()). Un
+// lote de capacidad fija no cambia la suya: el archivo solo puede repetirla.
+// En 'configuracion' queda lo aplicado, con todas las claves; con un error
+// el motor no cambia.
+template <int N>
+bool configurarConsola(EstacionamientoLote<N>& est, const string& ruta, ConfiguracionLote& configuracion,
+                       string& error) {
+    ConfiguracionLote compilada;
+    BaseEstacionamiento::Tarifa tarifa = est.getTarifa();
+    compilada.tarifaHora = tarifa.porHora;
+    compilada.minutosGratis = tarifa.minutosGratis;
+    compilada.capacidad = est.capacidad();
+    compilada.politica = est.getPolitica().nombre();
+    compilada.puertos = puertosPorOmision();
+    compilada.baudios = 9600;
+    configuracion = compilada;
+    if (!ifstream(ruta)) return true;
+
+    ConfiguracionLote archivo;
+    if (!ConfiguracionLote::leer(ruta, archivo, error)) return false;
+    ConfiguracionLote nueva = compilada.combinar(archivo);
+    if (N != CAPACIDAD_DINAMICA && nueva.capacidad != N) {
+        error = "la capacidad de este lote es fija (" + to_string(N) + ", ver distribucionLote.h)";
+        return false;
+    }
+    if (nueva.capacidad < est.capacidad()) {
+        error = "la capacidad solo crece (minimo " + to_string(est.capacidad()) + ")";
+        return false;
+    }
+    JerarquiaLote jerarquia = JerarquiaLote::delLote(nueva.capacidad);
+    if (!nueva.niveles.empty() && (!JerarquiaLote::desdeTexto(nueva.niveles, jerarquia) ||
+                                   jerarquia.totalCajones() != nueva.capacidad)) {
+        error = "niveles invalidos (deben sumar " + to_string(nueva.capacidad) + " cajones): " + nueva.niveles;
+        return false;
+    }
+    unique_ptr<PoliticaAsignacion> politica = crearPoliticaLote(nueva.politica, jerarquia);
+    if (!politica) {
+        error = "politica desconocida " + nueva.politica;
+        return false;
+    }
+
+    est.asignarTarifa({nueva.tarifaHora, nueva.minutosGratis});
+    est.ampliar(nueva.capacidad);
+    est.asignarJerarquia(jerarquia);
+    est.asignarPolitica(std::move(politica));
+    configuracion = nueva;
+    return true;
+}
+
+#endif
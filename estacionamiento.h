@@ -0,0 +1,775 @@
+#ifndef ESTACIONAMIENTO_H
+#define ESTACIONAMIENTO_H
+
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <ctime>
+#include <iomanip>
+#include <map>
+#include <unordered_map>
+#include <cmath>
+#include <memory>
+#include <cstdlib>
+#include <cctype>
+#include <array>
+#include <atomic>
+#include <type_traits>
+
+#include "megaEstacionamiento01/distribucionLote.h"
+#include "politicasAsignacion.h"
+#include "jerarquiaLote.h"
+#include "folioTicket.h"
+#include "vectorPersistente.h"
+
+using namespace std;
+
+// ==================== SISTEMA DE ESTACIONAMIENTO MEJORADO ====================
+// Nucleo portable: sin conio.h, windows.h ni pantallas. Las pantallas de
+// consola estan en consolaEstacionamiento.h y el protocolo del MEGA en
+// protocoloMega.h.
+
+// Tipos que comparten todas las capacidades: los lectores (pantallas,
+// servidor) trabajan con la Instantanea sin importar el tamanio del lote
+class BaseEstacionamiento {
+public:
+    struct Lugar {
+        string ticketId;
+        bool ocupado;
+        time_t horaEntrada;
+        bool autoPresente;  // segun el sensor del cajon (ver conciliarSensores)
+        bool apartado;      // reservado: entrada() no lo asigna (ver reservasLugares.h)
+    };
+
+    // Lo que se cobra; se cambia completa con asignarTarifa() (p. ej. al
+    // recargar la configuracion) y cada cobro usa una sola, nunca una mezcla
+    struct Tarifa {
+        float porHora;
+        int minutosGratis;  // estancias de hasta este tiempo no pagan
+    };
+
+    // La trama del MEGA es de un byte: cajones 1..8
+    static const int MAX_CAJONES_SENSADOS = 8;
+
+    // Cajon cuyo sensor no coincide con los tickets
+    struct Discrepancia {
+        int lugar;           // 1..capacidad
+        bool autoSinTicket;  // false: ticket sin auto
+    };
+
+    // Las de una trama: a lo mas una por cajon sensado, asi que caben aqui
+    // sin reservar memoria. Se recorre como un vector.
+    struct Discrepancias {
+        Discrepancia lista[MAX_CAJONES_SENSADOS];
+        int total = 0;
+
+        const Discrepancia* begin() const {
+            return lista;
+        }
+        const Discrepancia* end() const {
+            return lista + total;
+        }
+        bool empty() const {
+            return total == 0;
+        }
+        int size() const {
+            return total;
+        }
+    };
+
+    // Lo que tecleo el cajero, ver resolverTicket()
+    enum ResultadoFolio {
+        FOLIO_ACTIVO,        // ticket activo
+        FOLIO_MAL_ESCRITO,   // un verificador no cuadra: no se busco
+        FOLIO_NO_ENCONTRADO  // bien escrito pero no esta dentro
+    };
+
+    // Copia inmutable del estado. Se publica despues de cada cambio, asi los
+    // lectores (pantallas, debug, consultas) nunca ven un estado a medias ni
+    // detienen el procesamiento de las plumas. Lugares y tickets son
+    // persistentes (vectorPersistente.h): cada instantanea comparte con la
+    // anterior todo lo que no cambio y publicar cuesta O(log n) por lugar
+    // tocado, no una copia del lote. En los lotes de capacidad fija ninguna
+    // comparte nodos: el motor reusa las que ya nadie lee (ver
+    // EstacionamientoLote::instantaneaLibre).
+    struct Instantanea {
+        unsigned long version;
+        VectorPersistente<Lugar> lugares;
+        TablaTickets ticketToLugar;
+        int ocupados;
+        int contadorTickets;
+        bool sensoresActivos;
+    };
+
+    // Texto de la discrepancia del lugar (indice 0..) o vacio si coincide
+    static string textoDiscrepancia(const Instantanea& vista, int lugarIndex) {
+        if (!vista.sensoresActivos || lugarIndex >= MAX_CAJONES_SENSADOS) return "";
+        const Lugar& lugar = vista.lugares[lugarIndex];
+        if (lugar.autoPresente == lugar.ocupado) return "";
+        return lugar.autoPresente ? "AUTO SIN TICKET" : "TICKET SIN AUTO";
+    }
+};
+
+// Capacidad conocida al compilar (p. ej. CAJONES_LOTE de distribucionLote.h):
+// los lugares viven en un std::array dentro del objeto, los recorridos
+// tienen limite constante, que el compilador desenrolla en lotes chicos, y
+// entrar, salir y conciliar los sensores no reservan memoria (folio en la
+// memoria del lugar, indice por secuencia en un arreglo, instantaneas
+// recicladas). CAPACIDAD_DINAMICA: la capacidad se da al construir, puede
+// crecer y los lugares van en un vector, con instantaneas que comparten lo
+// que no cambio (lotes grandes, servidor, benchmark).
+const int CAPACIDAD_DINAMICA = 0;
+
+template <int N>
+class EstacionamientoLote : public BaseEstacionamiento {
+private:
+    static const bool FIJO = N != CAPACIDAD_DINAMICA;
+    typedef typename conditional<FIJO, array<Lugar, N>, vector<Lugar>>::type Lugares;
+    // Dinamico: secuencia del folio -> lugar. Fijo: la secuencia de cada
+    // lugar (-1 si no tiene), que se busca recorriendo N enteros.
+    typedef typename conditional<FIJO, array<int, N>, unordered_map<int, int>>::type IndiceSecuencias;
+
+    Lugares lugares;
+    TablaTickets ticketToLugar;        // dinamico: cada instantanea la copia compartiendo su raiz
+    IndiceSecuencias secuenciaToLugar;  // activos por secuencia del folio
+    int contadorTickets;
+    shared_ptr<const Tarifa> tarifa;
+    unsigned long version;
+    shared_ptr<const Instantanea> instantanea;
+    VectorPersistente<Lugar> lugaresPublicados;  // 'lugares' hasta la ultima publicacion
+    vector<int> cambiados;                       // lugares por pasar a lugaresPublicados
+    vector<bool> cambiado;
+    bool cambioTodo;                             // reconstruir lugaresPublicados completo
+    int ocupados;                                // en la ultima instantanea
+    vector<shared_ptr<Instantanea>> reciclables;  // fijo: todas las que se han publicado
+    unsigned int mapaSensores;  // ultima trama de ocupacion aplicada
+    bool sensoresActivos;       // ya llego al menos una trama
+    unique_ptr<PoliticaAsignacion> politica;  // que lugar da entrada()
+    JerarquiaLote jerarquia;                   // niveles y zonas, disponibles por nodo
+    vector<int> cambiosDisponibles;            // lugares avisados desde tomarCambiosDisponibles()
+    vector<bool> disponibleCambiado;
+
+    // Los dos indices de tickets activos; los folios de otro formato solo
+    // van al mapa por texto
+    void indexarTicket(const string& ticketId, int i) {
+        ticketToLugar.fijar(ticketId, i, lugares);
+        int secuencia = secuenciaFolio(ticketId);
+        if (secuencia < 0) return;
+        if constexpr (FIJO) {
+            secuenciaToLugar[i] = secuencia;
+        } else {
+            secuenciaToLugar[secuencia] = i;
+        }
+    }
+
+    void desindexarTicket(const string& ticketId, int i) {
+        ticketToLugar.quitar(ticketId, i);
+        if constexpr (FIJO) {
+            secuenciaToLugar[i] = -1;
+        } else {
+            auto it = secuenciaToLugar.find(secuenciaFolio(ticketId));
+            if (it != secuenciaToLugar.end() && it->second == i) secuenciaToLugar.erase(it);
+        }
+    }
+
+    // Lugar (0..) del ticket activo con esa secuencia; -1 si no hay
+    int lugarDeSecuencia(int secuencia) const {
+        if constexpr (FIJO) {
+            for (int i = 0; i < N; i++) {
+                if (secuenciaToLugar[i] == secuencia) return i;
+            }
+            return -1;
+        } else {
+            auto it = secuenciaToLugar.find(secuencia);
+            return it == secuenciaToLugar.end() ? -1 : it->second;
+        }
+    }
+
+    void limpiarIndices() {
+        ticketToLugar.limpiar();
+        if constexpr (FIJO) {
+            secuenciaToLugar.fill(-1);
+        } else {
+            secuenciaToLugar.clear();
+        }
+    }
+
+    // Fijo: una instantanea que solo cuenta 'reciclables', sin lectores y
+    // que no es la publicada, para escribirla en su lugar; si todas estan
+    // en uso se agrega otra. La cuenta se revisa como en
+    // VectorPersistente::propio: solo este hilo la sube.
+    shared_ptr<Instantanea> instantaneaLibre() {
+        for (const shared_ptr<Instantanea>& candidata : reciclables) {
+            if (candidata.use_count() == 1) {
+                atomic_thread_fence(memory_order_acquire);
+                return candidata;
+            }
+        }
+        shared_ptr<Instantanea> nueva = make_shared<Instantanea>();
+        nueva->lugares.asignar(lugares.begin(), lugares.end());
+        reciclables.push_back(nueva);
+        return nueva;
+    }
+
+    // Solo la llama el hilo que modifica (entradas/salidas); los lectores
+    // toman la instantanea con obtenerInstantanea() sin bloquear a nadie.
+    // Dinamico: pasa a lugaresPublicados solo los lugares cambiados (todos
+    // si fueron muchos o si se cargo el lote completo) y comparte el resto.
+    // Fijo: copia los N lugares y la tabla en una instantanea libre, cuyos
+    // nodos y folios ya tienen su memoria.
+    void publicarInstantanea() {
+        shared_ptr<Instantanea> nueva;
+        if constexpr (FIJO) {
+            nueva = instantaneaLibre();
+            ocupados = 0;
+            for (int i = 0; i < N; i++) {
+                nueva->lugares.fijar(i, lugares[i]);
+                if (lugares[i].ocupado) ocupados++;
+            }
+            nueva->ticketToLugar.copiar(ticketToLugar);
+        } else {
+            if (cambioTodo || cambiados.size() > VectorPersistente<Lugar>::ANCHO + lugares.size() / 8) {
+                lugaresPublicados.asignar(lugares.begin(), lugares.end());
+                ocupados = 0;
+                for (int i = 0; i < capacidad(); i++) {
+                    if (lugares[i].ocupado) ocupados++;
+                }
+            } else {
+                for (int i : cambiados) {
+                    ocupados += (int)lugares[i].ocupado - (int)lugaresPublicados[i].ocupado;
+                    lugaresPublicados.fijar(i, lugares[i]);
+                }
+            }
+            nueva = make_shared<Instantanea>();
+            nueva->lugares = lugaresPublicados;
+            nueva->ticketToLugar = ticketToLugar;
+        }
+        for (int i : cambiados) cambiado[i] = false;
+        cambiados.clear();
+        cambioTodo = false;
+
+        nueva->version = ++version;
+        nueva->contadorTickets = contadorTickets;
+        nueva->sensoresActivos = sensoresActivos;
+        nueva->ocupados = ocupados;
+        atomic_store(&instantanea, shared_ptr<const Instantanea>(nueva));
+    }
+
+    // Cualquier cambio de lugares[i] que deba ver la siguiente instantanea
+    void marcarCambio(int i) {
+        if (cambiado[i]) return;
+        cambiado[i] = true;
+        cambiados.push_back(i);
+    }
+
+    // La politica y los contadores de la jerarquia solo cuentan los
+    // disponibles (libres y sin apartar)
+    void avisarDisponible(int i) {
+        bool disponible = !lugares[i].ocupado && !lugares[i].apartado;
+        if (disponible) {
+            politica->disponible(i);
+        } else {
+            politica->noDisponible(i);
+        }
+        jerarquia.marcar(i, disponible);
+        if (!disponibleCambiado[i]) {
+            disponibleCambiado[i] = true;
+            cambiosDisponibles.push_back(i);
+        }
+    }
+
+    // Despues de cada cambio de ocupacion o apartado de un lugar
+    void avisarCambio(int i) {
+        marcarCambio(i);
+        avisarDisponible(i);
+    }
+
+    void reiniciarAvisos() {
+        politica->reiniciar(capacidad());
+        for (int i = 0; i < capacidad(); i++) avisarDisponible(i);
+    }
+
+    void ocupar(int i) {
+        escribirTicketId(lugares[i].ticketId);
+        lugares[i].ocupado = true;
+        lugares[i].apartado = false;
+        lugares[i].horaEntrada = time(nullptr);
+
+        indexarTicket(lugares[i].ticketId, i);
+        avisarCambio(i);
+        publicarInstantanea();
+
+        //cout << "DEBUG: Entrada - Ticket " << ticketId << " en Lugar A-" << (i + 1) << endl;
+    }
+    
+public:
+    // En los lotes de capacidad fija 'cap' se ignora
+    explicit EstacionamientoLote(int cap = N)
+        : contadorTickets(0), tarifa(make_shared<const Tarifa>(Tarifa{20.0f, 15})), version(0), cambioTodo(true), ocupados(0),
+          mapaSensores(0), sensoresActivos(false), politica(new PoliticaCercania()) {
+        if constexpr (FIJO) {
+            cap = N;
+            lugares.fill({"", false, 0, false, false});
+            // Folios e instantaneas se reciclan; solo hay que reservar una vez
+            for (Lugar& lugar : lugares) lugar.ticketId.reserve(MAX_LARGO_FOLIO);
+            secuenciaToLugar.fill(-1);
+        } else {
+            lugares.assign(cap, {"", false, 0, false, false});
+        }
+        cambiado.assign(cap, false);
+        disponibleCambiado.assign(cap, false);
+        ticketToLugar.reservar(cap);
+        jerarquia = JerarquiaLote::delLote(capacidad());
+        reiniciarAvisos();
+        publicarInstantanea();
+    }
+
+    int capacidad() const {
+        if constexpr (FIJO) {
+            return N;
+        } else {
+            return (int)lugares.size();
+        }
+    }
+
+    // Agrega cajones libres sin tocar los tickets abiertos; la jerarquia
+    // vuelve a la de distribucionLote.h (el llamador puede asignar otra
+    // despues). Solo crece y solo en lotes de capacidad dinamica: false si no.
+    bool ampliar(int nuevaCapacidad) {
+        if (nuevaCapacidad < capacidad()) return false;
+        if (nuevaCapacidad == capacidad()) return true;
+        if constexpr (FIJO) {
+            return false;
+        } else {
+            lugares.resize(nuevaCapacidad, {"", false, 0, false, false});
+        }
+        cambiado.resize(nuevaCapacidad, false);
+        disponibleCambiado.resize(nuevaCapacidad, false);
+        ticketToLugar.reservar(nuevaCapacidad);
+        cambioTodo = true;
+        jerarquia = JerarquiaLote::delLote(capacidad());
+        reiniciarAvisos();
+        publicarInstantanea();
+        return true;
+    }
+
+    // Vista consistente del ultimo estado publicado
+    shared_ptr<const Instantanea> obtenerInstantanea() const {
+        return atomic_load(&instantanea);
+    }
+    
+    // "TCK-" + ddmmaaaa + verificador + contador + verificador (ver
+    // folioTicket.h) en 'ticketId', reusando su memoria
+    void escribirTicketId(string& ticketId) {
+        time_t ahora = time(nullptr);
+        tm* tiempo = localtime(&ahora);
+        contadorTickets++;
+        char folio[MAX_LARGO_FOLIO];
+        ticketId.assign(folio, escribirFolio(*tiempo, contadorTickets, folio));
+    }
+
+    string generarTicketId() {
+        string ticketId;
+        escribirTicketId(ticketId);
+        return ticketId;
+    }
+
+    // El ticket activo que tecleo el cajero, completo o solo el final impreso
+    // ("00059"), en 'ticketId' para salida() o buscarTicket(). Los
+    // verificadores se revisan antes de buscar, tambien el del final, que no
+    // depende de ningun ticket. La busqueda es O(1) en el indice por
+    // secuencia (O(N) sin reservas en los lotes fijos). Un folio de otro formato (cargado con cargarLugares) no
+    // pasa leerFolio: se busca tal cual en el indice por texto antes de
+    // darlo por mal escrito. Lee el estado vivo: solo el hilo que modifica.
+    ResultadoFolio resolverTicket(const string& tecleado, string& ticketId) const {
+        LecturaFolio lectura = leerFolio(tecleado);
+        if (lectura.tipo == LecturaFolio::MAL_ESCRITO) {
+            int lugarIndex;
+            if (ticketToLugar.buscar(tecleado, lugares, lugarIndex) && lugares[lugarIndex].ocupado) {
+                ticketId = tecleado;
+                return FOLIO_ACTIVO;
+            }
+            return FOLIO_MAL_ESCRITO;
+        }
+
+        int lugarIndex = lugarDeSecuencia(lectura.secuencia);
+        if (lugarIndex < 0 || lugarIndex >= capacidad()) return FOLIO_NO_ENCONTRADO;
+        const Lugar& lugar = lugares[lugarIndex];
+        if (!lugar.ocupado || secuenciaFolio(lugar.ticketId) != lectura.secuencia) return FOLIO_NO_ENCONTRADO;
+        // Otro dia con la misma secuencia (el contador se reinicio)
+        if (lectura.tipo == LecturaFolio::COMPLETO && !lectura.es(lugar.ticketId)) return FOLIO_NO_ENCONTRADO;
+        ticketId = lugar.ticketId;
+        return FOLIO_ACTIVO;
+    }
+    
+    // El lugar lo elige la politica (primer libre si no se cambio); -1: lleno
+    int entrada(const SolicitudLugar& solicitud = SolicitudLugar()) {
+        int i = politica->elegir(solicitud);
+        if (i < 0) return -1;
+        ocupar(i);
+        return i + 1;
+    }
+
+    // Cambia la politica de entrada() conservando el estado de los lugares
+    void asignarPolitica(unique_ptr<PoliticaAsignacion> nueva) {
+        if (!nueva) return;
+        politica = std::move(nueva);
+        reiniciarAvisos();
+    }
+
+    const PoliticaAsignacion& getPolitica() const {
+        return *politica;
+    }
+
+    // Reemplaza niveles y zonas (por omision, las de distribucionLote.h);
+    // false si no suma la capacidad. Todos los nodos quedan como cambiados.
+    bool asignarJerarquia(const JerarquiaLote& nueva) {
+        if (nueva.totalCajones() != capacidad()) return false;
+        jerarquia = nueva;
+        for (int i = 0; i < capacidad(); i++) avisarDisponible(i);
+        return true;
+    }
+
+    const JerarquiaLote& getJerarquia() const {
+        return jerarquia;
+    }
+
+    // Nodos de la jerarquia cuyos disponibles cambiaron desde la llamada
+    // anterior, para refrescar solo esos letreros
+    void tomarCambiosJerarquia(vector<int>& nodos) {
+        jerarquia.tomarCambios(nodos);
+    }
+
+    // Lugares (1..) que pudieron pasar de disponible a no disponible o al
+    // reves desde la llamada anterior; el llamador lee su estado en la
+    // instantanea
+    void tomarCambiosDisponibles(vector<int>& numerosLugar) {
+        for (int i : cambiosDisponibles) {
+            disponibleCambiado[i] = false;
+            numerosLugar.push_back(i + 1);
+        }
+        cambiosDisponibles.clear();
+    }
+
+    // "A-3" o, con varios niveles, "P1-A-3"
+    string etiquetaLugar(int numeroLugar) const {
+        return jerarquia.etiqueta(numeroLugar - 1);
+    }
+
+    // Entrada en un lugar dado (1..), apartado o no: la llegada de una
+    // reserva. -1 si esta ocupado o no existe.
+    int entradaEn(int numeroLugar) {
+        if (numeroLugar < 1 || numeroLugar > capacidad() || lugares[numeroLugar - 1].ocupado) {
+            return -1;
+        }
+        ocupar(numeroLugar - 1);
+        return numeroLugar;
+    }
+
+    // Aparta o libera un lugar (1..) para una reserva; false si no existe
+    bool apartarLugar(int numeroLugar, bool apartado) {
+        if (numeroLugar < 1 || numeroLugar > capacidad()) return false;
+        if (lugares[numeroLugar - 1].apartado != apartado) {
+            lugares[numeroLugar - 1].apartado = apartado;
+            avisarCambio(numeroLugar - 1);
+            publicarInstantanea();
+        }
+        return true;
+    }
+
+    // consulta ticket
+    void consulta(const string& ticketId) {
+        char buffer[80];
+
+        // Buscar en el mapa
+        int lugarIndex;
+        if (ticketToLugar.buscar(ticketId, lugares, lugarIndex)) {
+            
+            tm* fecha = localtime(&lugares[lugarIndex].horaEntrada);
+
+            if (lugarIndex >= 0 && lugarIndex < capacidad() && 
+                lugares[lugarIndex].ocupado && 
+                lugares[lugarIndex].ticketId == ticketId) {
+                
+                strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", fecha);
+
+                // 5. Imprimir la cadena formateada usando `cout`
+                cout << "La fecha y hora actuales son: " << buffer << endl;
+                
+                cout << "Hr. Entrada  = " << lugares[lugarIndex].horaEntrada << endl;
+                cout << "Hr. Entrada  = " << fecha->tm_mday << "/" << fecha->tm_mon << "/" << fecha->tm_year << endl;
+                cout << "     Ocupado = " << lugares[lugarIndex].ocupado << endl;
+                cout << "    Ticket # = " << lugares[lugarIndex].ticketId << endl;
+            }
+        }
+    }
+    
+    float getTarifaPorHora() const {
+        return atomic_load(&tarifa)->porHora;
+    }
+
+    Tarifa getTarifa() const {
+        return *atomic_load(&tarifa);
+    }
+
+    // Cambia la tarifa de un golpe; los tickets abiertos pagan la nueva al salir
+    void asignarTarifa(const Tarifa& nueva) {
+        atomic_store(&tarifa, shared_ptr<const Tarifa>(make_shared<const Tarifa>(nueva)));
+    }
+
+    // Calcula el cobro basado en el tiempo transcurrido
+    float calcularCobro(time_t horaEntrada, time_t horaSalida) {
+        shared_ptr<const Tarifa> vigente = atomic_load(&tarifa);
+        double diferenciaSegundos = difftime(horaSalida, horaEntrada);
+        double minutos = diferenciaSegundos / 60.0;
+        
+        // Los primeros minutos son gratis (15 si no se cambio la tarifa)
+        if (minutos <= vigente->minutosGratis) {
+            return 0.0;
+        }
+        
+        // Después de los minutos gratis, se cobra por hora completa
+        double horas = ceil(minutos / 60.0);
+        return horas * vigente->porHora;
+    }
+    
+    // Salida con ticket específico y cálculo de cobro
+    float salida(const string& ticketId) {
+        //cout << "DEBUG: Intentando salida con ticket: " << ticketId << endl;
+        
+        // Buscar en el mapa
+        int lugarIndex;
+        if (ticketToLugar.buscar(ticketId, lugares, lugarIndex)) {
+            
+            if (lugarIndex >= 0 && lugarIndex < capacidad() && 
+                lugares[lugarIndex].ocupado && 
+                lugares[lugarIndex].ticketId == ticketId) {
+                
+                // Calcular cobro
+                time_t horaSalida = time(nullptr);
+                float cobro = calcularCobro(lugares[lugarIndex].horaEntrada, horaSalida);
+                
+                // Liberar el lugar; el folio se borra sin soltar su memoria
+                lugares[lugarIndex].ocupado = false;
+                desindexarTicket(lugares[lugarIndex].ticketId, lugarIndex);
+                lugares[lugarIndex].ticketId.clear();
+                
+                avisarCambio(lugarIndex);
+                publicarInstantanea();
+                
+                /*cout << "DEBUG: Salida EXITOSA - Lugar A-" << (lugarIndex + 1) 
+                     << " liberado. Ticket: " << ticketId 
+                     << " Cobro: $" << fixed << setprecision(2) << cobro << endl;*/
+                
+                return cobro;
+            }
+        }
+        
+        // Si no se encuentra en el mapa, buscar manualmente
+        for (int i = 0; i < capacidad(); i++) {
+            if (lugares[i].ocupado && lugares[i].ticketId == ticketId) {
+                // Calcular cobro
+                time_t horaSalida = time(nullptr);
+                float cobro = calcularCobro(lugares[i].horaEntrada, horaSalida);
+                
+                lugares[i].ocupado = false;
+                desindexarTicket(lugares[i].ticketId, i);
+                lugares[i].ticketId.clear();
+                
+                avisarCambio(i);
+                publicarInstantanea();
+                
+                /*cout << "DEBUG: Salida MANUAL - Lugar A-" << (i + 1) 
+                     << " liberado. Ticket: " << ticketId 
+                     << " Cobro: $" << fixed << setprecision(2) << cobro << endl;*/
+                return cobro;
+            }
+        }
+        
+        //cout << "DEBUG: Salida FALLIDA - Ticket no encontrado: " << ticketId << endl;
+        return -1.0f;
+    }
+    
+    // Función de reparación de emergencia
+    void repararInconsistencias() {
+        cout << "DEBUG: Iniciando reparacion de inconsistencias..." << endl;
+        
+        // Reconstruir los indices desde cero
+        limpiarIndices();
+        int reparados = 0;
+        
+        for (int i = 0; i < capacidad(); i++) {
+            if (lugares[i].ocupado && !lugares[i].ticketId.empty()) {
+                // Verificar si este ticket ya está en el mapa en otro lugar
+                int otro;
+                if (ticketToLugar.buscar(lugares[i].ticketId, lugares, otro)) {
+                    // ¡Inconsistencia! Dos lugares con el mismo ticket
+                    cout << "DEBUG: Reparando inconsistencia - Ticket duplicado: " 
+                         << lugares[i].ticketId << endl;
+                    // Liberar el lugar actual (asumimos que es el incorrecto)
+                    lugares[i].ocupado = false;
+                    lugares[i].ticketId = "";
+                    avisarCambio(i);
+                } else {
+                    // Agregar al mapa
+                    indexarTicket(lugares[i].ticketId, i);
+                    reparados++;
+                }
+            }
+        }
+        publicarInstantanea();
+        
+        cout << "DEBUG: Reparacion completada. " << reparados << " tickets reconstruidos." << endl;
+    }
+    
+    // Forzar liberación de un lugar específico
+    bool forzarLiberacion(int numeroLugar) {
+        if (numeroLugar < 1 || numeroLugar > capacidad()) {
+            return false;
+        }
+        
+        int index = numeroLugar - 1;
+        if (lugares[index].ocupado) {
+            string ticketId = lugares[index].ticketId;
+            lugares[index].ocupado = false;
+            lugares[index].ticketId = "";
+            
+            // Eliminar del mapa si existe
+            desindexarTicket(ticketId, index);
+            avisarCambio(index);
+            publicarInstantanea();
+            
+            /*cout << "DEBUG: Liberación forzada - Lugar A-" << numeroLugar 
+                 << " liberado. Ticket: " << ticketId << endl;*/
+            return true;
+        }
+        return false;
+    }
+    
+    // Aplica la ocupacion fisica reportada por los sensores. Solo se visitan
+    // los cajones cuyo bit cambio desde la trama anterior (todos en la
+    // primera) y se regresan los que quedaron en desacuerdo con los tickets.
+    Discrepancias conciliarSensores(unsigned int mapa) {
+        Discrepancias discrepancias;
+        int sensados = capacidad() < MAX_CAJONES_SENSADOS ? capacidad() : MAX_CAJONES_SENSADOS;
+        unsigned int todos = (1u << sensados) - 1;
+        mapa &= todos;
+
+        unsigned int cambios = sensoresActivos ? (mapa ^ mapaSensores) : todos;
+        mapaSensores = mapa;
+        sensoresActivos = true;
+        if (cambios == 0) {
+            return discrepancias;
+        }
+
+        for (int i = 0; cambios != 0; i++, cambios >>= 1) {
+            if (!(cambios & 1)) continue;
+            lugares[i].autoPresente = (mapa & (1u << i)) != 0;
+            marcarCambio(i);
+            if (lugares[i].autoPresente != lugares[i].ocupado) {
+                discrepancias.lista[discrepancias.total++] = {i + 1, lugares[i].autoPresente};
+            }
+        }
+        publicarInstantanea();
+        return discrepancias;
+    }
+
+    // Datos de un ticket activo sin imprimir nada (para clientes sin consola)
+    bool buscarTicket(const string& ticketId, int& numeroLugar, time_t& horaEntrada) const {
+        shared_ptr<const Instantanea> vista = obtenerInstantanea();
+        int lugarIndex;
+        if (!vista->ticketToLugar.buscar(ticketId, vista->lugares, lugarIndex)) return false;
+
+        if (lugarIndex < 0 || lugarIndex >= (int)vista->lugares.size() ||
+            !vista->lugares[lugarIndex].ocupado ||
+            vista->lugares[lugarIndex].ticketId != ticketId) {
+            return false;
+        }
+        numeroLugar = lugarIndex + 1;
+        horaEntrada = vista->lugares[lugarIndex].horaEntrada;
+        return true;
+    }
+
+    vector<string> getTicketsActivos() {
+        shared_ptr<const Instantanea> vista = obtenerInstantanea();
+        vector<string> tickets;
+        vista->lugares.recorrer([&](size_t i, const Lugar& lugar) {
+            if (lugar.ocupado) {
+                tickets.push_back(lugar.ticketId + " (Lugar " + etiquetaLugar((int)i + 1) + ")");
+            }
+        });
+        return tickets;
+    }
+
+    // Función para crear timestamp exacto
+    time_t crearTimestamp(int anio, int mes, int dia, int hora, int minuto, int segundo = 0) {
+        tm tiempo = {};
+        tiempo.tm_year = anio - 1900;  // Años desde 1900
+        tiempo.tm_mon = mes - 1;       // Meses 0-11
+        tiempo.tm_mday = dia;
+        tiempo.tm_hour = hora;
+        tiempo.tm_min = minuto;
+        tiempo.tm_sec = segundo;
+        tiempo.tm_isdst = -1;          // No considerar horario de verano
+    
+        return mktime(&tiempo);
+    }
+
+    void cargaPrevia(){
+    
+        // Crear los registros
+        // 25/11/2025 20:08
+        lugares[2].ticketId = "TCK-25112025300059";
+        lugares[2].ocupado = true;
+        lugares[2].horaEntrada  = crearTimestamp(2025, 11, 25, 20, 8, 0);
+        indexarTicket(lugares[2].ticketId, 2);
+
+        // 27/11/2025 10:06
+        lugares[1].ticketId = "TCK-27112025900037";
+        lugares[1].ocupado = true;
+        lugares[1].horaEntrada  = crearTimestamp(2025, 11, 27, 10, 6, 0);
+        indexarTicket(lugares[1].ticketId, 1);
+    
+        // 26/11/2025 22:28
+        lugares[0].ticketId = "TCK-26112025400013";
+        lugares[0].ocupado = true;
+        lugares[0].horaEntrada = crearTimestamp(2025, 11, 26, 22, 28, 0);
+        indexarTicket(lugares[0].ticketId, 0);
+
+        contadorTickets = 5;
+        cambioTodo = true;
+        reiniciarAvisos();
+        publicarInstantanea();
+    }    
+
+    // Restaura el estado completo de los lugares (respaldo, pruebas de carga)
+    // reconstruyendo el mapa de tickets y publicando una sola instantanea
+    void cargarLugares(const vector<Lugar>& estado, int contador) {
+        limpiarIndices();
+        for (int i = 0; i < capacidad(); i++) {
+            lugares[i] = i < (int)estado.size() ? estado[i] : Lugar{"", false, 0, false, false};
+            if (lugares[i].ocupado) indexarTicket(lugares[i].ticketId, i);
+        }
+        contadorTickets = contador;
+        cambioTodo = true;
+        reiniciarAvisos();
+        publicarInstantanea();
+    }
+
+    // Función de formateo integrada
+    string formatearCobro(double cantidad) {
+        stringstream ss;
+        ss.imbue(locale(""));  // Configuración regional
+        ss << fixed << setprecision(2) << cantidad;
+        return "$" + ss.str();
+    }
+
+};
+
+typedef EstacionamientoLote<CAPACIDAD_DINAMICA> Estacionamiento;
+
+// El lote del MEGA, con la capacidad de distribucionLote.h
+typedef EstacionamientoLote<CAJONES_LOTE> EstacionamientoMega;
+
+#endif
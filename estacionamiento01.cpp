@@ -1,6 +1,12 @@
 // parking_system.cpp
 // Versión optimizada del sistema de estacionamiento
 // Compatibilidad: Windows (WinAPI), compilar con Visual Studio (MSVC)
+//
+// Frente de consola con ticket impreso en pantalla, placa y consultas del
+// historial. Los lugares, folios y cobros son los del nucleo
+// (estacionamiento.h), el puerto el de serialController.h y el historial el
+// de historialTickets.h, los mismos que usan estacionamiento04 y el
+// servidor; aqui solo quedan las pantallas.
 
 #include <iostream>
 #include <conio.h>
@@ -10,222 +16,62 @@
 #include <ctime>
 #include <limits>
 #include <iomanip>
+#include <sstream>
 
-using namespace std;
+#include "trazaEventos.h"
+#include "serialController.h"
+#include "estacionamiento.h"
+#include "historialTickets.h"
+#include "consolaEstacionamiento.h"
+#include "protocoloMega.h"
 
-struct Ticket {
-    string id = "";
-    int hora = 0;
-    int min = 0;
-    int dia = 0;
-    int yyyy = 0;
-    int mes = 0;
-    int lugar = 0;
-    string placa = "";
-    float cobro = 0;
-    bool activo = true;
-};
+using namespace std;
 
-vector<Ticket> RegistroTickets;
-const int totalLugares = 6;
-vector<string> lugaresOcupados(totalLugares); 
-const float pagoHora = 20.00;
-Ticket boletoSalida;
-int contadorTickets = 0;
-int numeroLugar = 0;
+EstacionamientoMega est;
+HistorialTickets historial;  // activos e historicos, con placa y cobro
 string mensaje = "";
-
-
-// --------------------------- SerialController -------------------------------
-class SerialController {
-private:
-    HANDLE hSerial = INVALID_HANDLE_VALUE;
-    bool connected = false;
-    string accion;
-    bool newDataAvailable = false;  // Nueva bandera para controlar datos nuevos
-
-    int safeStoi(const string& str, int defaultValue = -1) {
-        if (str.empty()) return defaultValue;
-        for (char c : str) if (!isdigit((unsigned char)c)) return defaultValue;
-        try { return stoi(str); } catch (...) { return defaultValue; }
-    }
-
-public:
-    SerialController() = default;
-
-    bool connect(const char* portName) {
-        cout << "Intentando conectar a " << portName << "..." << endl;
-
-        hSerial = CreateFileA(portName,
-                             GENERIC_READ | GENERIC_WRITE,
-                             0,
-                             NULL,
-                             OPEN_EXISTING,
-                             FILE_ATTRIBUTE_NORMAL,
-                             NULL);
-
-        if (hSerial == INVALID_HANDLE_VALUE) {
-            DWORD error = GetLastError();
-            cout << "Error al conectar a " << portName << " (Codigo: " << error << ")" << endl;
-            if (error == 5) cout << "Acceso denegado. Cierra el Monitor Serial del IDE Arduino." << endl;
-            else if (error == 2) cout << "Puerto no encontrado." << endl;
-            return false;
-        }
-
-        DCB dcbSerialParams = {0};
-        dcbSerialParams.DCBlength = sizeof(dcbSerialParams);
-
-        if (!GetCommState(hSerial, &dcbSerialParams)) {
-            cout << "Error: No se pudo obtener configuracion del puerto" << endl;
-            CloseHandle(hSerial);
-            hSerial = INVALID_HANDLE_VALUE;
-            return false;
-        }
-
-        dcbSerialParams.BaudRate = CBR_9600;
-        dcbSerialParams.ByteSize = 8;
-        dcbSerialParams.StopBits = ONESTOPBIT;
-        dcbSerialParams.Parity   = NOPARITY;
-
-        if (!SetCommState(hSerial, &dcbSerialParams)) {
-            cout << "Error: No se pudo configurar el puerto serial" << endl;
-            CloseHandle(hSerial);
-            hSerial = INVALID_HANDLE_VALUE;
-            return false;
-        }
-
-        COMMTIMEOUTS timeouts = {0};
-        timeouts.ReadIntervalTimeout = 50;
-        timeouts.ReadTotalTimeoutConstant = 50;
-        timeouts.ReadTotalTimeoutMultiplier = 10;
-        timeouts.WriteTotalTimeoutConstant = 50;
-        timeouts.WriteTotalTimeoutMultiplier = 10;
-
-        if (!SetCommTimeouts(hSerial, &timeouts)) {
-            cout << "Error: No se pudo configurar timeouts" << endl;
-            CloseHandle(hSerial);
-            hSerial = INVALID_HANDLE_VALUE;
-            return false;
-        }
-
-        connected = true;
-        cout << "Conectado al puerto " << portName << " correctamente!" << endl;
-        clearSerialBuffer();
-        return true;
-    }
-
-    void clearSerialBuffer() {
-        if (!connected || hSerial == INVALID_HANDLE_VALUE) return;
-        DWORD errors = 0;
-        COMSTAT comStat = {0};
-        ClearCommError(hSerial, &errors, &comStat);
-        if (comStat.cbInQue > 0) {
-            vector<char> tmp(comStat.cbInQue + 1);
-            DWORD read = 0;
-            ReadFile(hSerial, tmp.data(), (DWORD)tmp.size() - 1, &read, NULL);
-            // Se ignora el contenido; objetivo: limpiar buffer
-        }
-    }
-
-    bool sendData(const string& data) {
-        if (!connected || hSerial == INVALID_HANDLE_VALUE) return false;
-        DWORD bytesWritten = 0;
-        string dataWithNewline = data + "\n";
-        bool success = WriteFile(hSerial, dataWithNewline.c_str(),
-                                 (DWORD)dataWithNewline.length(), &bytesWritten, NULL);
-        if (!success) {
-            cout << "Error al enviar datos" << endl;
-        }
-        return success;
-    }
-
-    // Devuelve true si hay nuevos datos disponibles
-    bool hasNewData() const { 
-        return newDataAvailable; 
-    }
-
-    // Obtiene el último dato y marca como consumido
-    string getLastData() {
-        newDataAvailable = false;  // Resetear después de obtener
-        return accion;
-    }
-
-    // Lee datos del puerto y actualiza 'accion' cuando haya algo nuevo
-    void checkForData() {
-        if (!connected || hSerial == INVALID_HANDLE_VALUE) return;
-
-        char buffer[256];
-        DWORD bytesRead = 0;
-        BOOL ok = ReadFile(hSerial, buffer, sizeof(buffer) - 1, &bytesRead, NULL);
-        if (ok && bytesRead > 0) {
-            buffer[bytesRead] = '\0';
-            string receivedData(buffer);
-            
-            // DEBUG: Ver datos crudos
-            //cout << "DEBUG: Bytes leidos: " << bytesRead << endl;
-            //cout << "DEBUG: Raw data: '";
-            for(int i = 0; i < bytesRead; i++) {
-                if(buffer[i] == '\r') cout << "\\r";
-                else if(buffer[i] == '\n') cout << "\\n";
-                else cout << buffer[i];
-            }
-            cout << "'" << endl;
-            
-            // Limpiar saltos de línea al final
-            while (!receivedData.empty() && (receivedData.back() == '\r' || receivedData.back() == '\n')) {
-                receivedData.pop_back();
-            }
-            
-            // Solo marcar como nuevo dato si es diferente al anterior
-            if (!receivedData.empty()) {
-                //cout << "DEBUG: Datos limpios '" <<  receivedData << "'" << endl;
-                accion = receivedData;
-                newDataAvailable = true;  // Marcar que hay nuevo dato
-                //cout << "DEBUG: Nuevo dato disponible: '" << accion << "'" << endl;
-            }
-        }
-    }
-
-    ~SerialController() {
-        if (connected && hSerial != INVALID_HANDLE_VALUE) {
-            CloseHandle(hSerial);
-            hSerial = INVALID_HANDLE_VALUE;
-            connected = false;
-            cout << "Conexion serial cerrada." << endl;
-        }
-    }
+const size_t MAX_RESULTADOS = 50;
+const DWORD ESPERA_PLACA_MS = 10000;
+
+// Placa que el operador esta tecleando; el ciclo principal la atiende sin
+// detenerse (ver atenderCapturaPlaca)
+struct CapturaPlaca {
+    bool activa = false;
+    string ticketId;
+    string placa;
+    DWORD inicio = 0;
 };
+CapturaPlaca capturaPlaca;
 
-// --------------------------- Administracion de lugares  ------------------------------
-
-// Función para encontrar el primer lugar disponible
-int encontrarLugarDisponible() {
+// --------------------------- Menús y utilidades ------------------------------
+// "dd/mm/aaaa" y "hh:mm" de un instante, en hora local
+string textoFecha(time_t instante) {
+    tm* fecha = localtime(&instante);
+    ostringstream texto;
+    texto << setw(2) << setfill('0') << fecha->tm_mday << "/" << setw(2) << fecha->tm_mon + 1 << "/"
+          << fecha->tm_year + 1900;
+    return texto.str();
+}
 
-    cout << "Entrando a contar lugares " << endl; // 23/11/2025 21:07
-    for (int i = 0; i < totalLugares; i++) {
-        cout << "Lugar A - " << i + 1 << lugaresOcupados[i] << endl;
-        if (lugaresOcupados[i] == "" || lugaresOcupados[i].empty()) {
-            cout << "Lugar A - " << i + 1 << endl;
-            return i;  // Devuelve el índice del lugar disponible
-        }
-    }
-    cout << "No hay lugares disponibles" << endl; // 23/11/2025 21:07
-    return -1;  // No hay lugares disponibles
+string textoHora(time_t instante) {
+    tm* fecha = localtime(&instante);
+    ostringstream texto;
+    texto << setw(2) << setfill('0') << fecha->tm_hour << ":" << setw(2) << fecha->tm_min;
+    return texto.str();
 }
 
-// Función para contar lugares ocupados
-int contarLugaresOcupados() {
-    int count = 0;
-    for (int i = 0; i < totalLugares; i++) {
-        if (lugaresOcupados[i] == "" && lugaresOcupados[i].empty()) count++;
-    }
-    return count;
+// Un renglon de los listados: [placa] ticket lugar fecha hora estado
+void mostrarRenglon(const HistorialTickets::Registro& registro, bool conPlaca) {
+    cout << " ";
+    if (conPlaca) cout << registro.placa << "   ";
+    cout << registro.ticketId << "   " << est.etiquetaLugar(registro.lugar) << "   "
+         << textoFecha(registro.horaEntrada) << " " << textoHora(registro.horaEntrada) << "   "
+         << (registro.activo() ? "Activo" : "No Activo") << endl;
 }
 
-// --------------------------- Menús y utilidades ------------------------------
 void consultarTicket() {
     string ticket;
-    
+
     cout << "\n     =================================" << endl;
     cout << "     ===     Consultar Ticket      ===" << endl;
     cout << "     =================================" << endl;
@@ -235,21 +81,25 @@ void consultarTicket() {
     cout << "\n\n------------------------------------------" << endl;
     cout << "------------------------------------------" << endl;
 
-    bool found = false;
-    for (const auto& registro : RegistroTickets) {
-        if (registro.id == ticket) {
-            found = true;
-            cout << "\n    ID:  " << registro.id    << endl;
-            cout << " Lugar:  " << registro.lugar << endl;
-            cout << "  Hora:  " << registro.hora << ":" << registro.min << endl;
-            cout << " Fecha:  " << registro.dia << "/" << registro.mes << "/" << registro.yyyy << endl;
-            boletoSalida = registro; 
+    // Un ticket activo tambien con solo el final impreso; los que ya
+    // salieron, con el folio completo
+    string ticketId = ticket;
+    string activo;
+    if (est.resolverTicket(ticket, activo) == Estacionamiento::FOLIO_ACTIVO) ticketId = activo;
+
+    uint32_t i;
+    if (historial.buscar(ticketId, i)) {
+        const HistorialTickets::Registro& registro = historial[i];
+        cout << "\n    ID:  " << registro.ticketId << endl;
+        cout << " Lugar:  " << est.etiquetaLugar(registro.lugar) << endl;
+        cout << "  Hora:  " << textoHora(registro.horaEntrada) << endl;
+        cout << " Fecha:  " << textoFecha(registro.horaEntrada) << endl;
+        if (!registro.placa.empty()) cout << " Placa:  " << registro.placa << endl;
+        if (!registro.activo()) {
+            cout << "Salida:  " << textoFecha(registro.horaSalida) << " " << textoHora(registro.horaSalida) << endl;
         }
-    }
-
-    if (!found) {
+    } else {
         cout << "Ticket no encontrado." << endl;
-        boletoSalida.id = "";
     }
     cout << "------------------------------------------" << endl;
     cout << "Presione enter para continuar..." << endl;
@@ -257,20 +107,13 @@ void consultarTicket() {
     cin.get();
 }
 
+// Cobra el ticket que teclea el cajero (completo o solo el final impreso) y
+// libera su lugar; el cobro es el del nucleo con la tarifa vigente. Regresa
+// lo cobrado, -1 si no se encontro o se cancelo.
 float pagoTotal() {
-    int lugarIndex = 0; // aqui2
-    ostringstream wnum, wmes, wdia, whora, wmin;
-    ostringstream wn, wmm, wdd, whh, wmn;
-    bool found = false;
-    char op;
-
     string ticket;
-
-    float pagoDD = 0;
-    float pagoHH = 0;
-    float pagoMin = 0;
-    float TotalxCobrar = 0;
-
+    string ticketId;
+    char op;
 
     cout << "\n     =================================" << endl;
     cout << "     ===   Informacion del Ticket   ===" << endl;
@@ -281,23 +124,26 @@ float pagoTotal() {
     cout << "\n\n------------------------------------------" << endl;
     cout << "------------------------------------------" << endl;
 
-    for (const auto& registro : RegistroTickets) {
-        if (registro.id == ticket && registro.activo) {
-            found = true;
-            cout << "\n    ID:  " << registro.id    << endl;
-            cout << " Lugar:  " << registro.lugar << endl;
-            cout << "  Hora:  " << registro.hora << ":" << registro.min << endl;
-            cout << " Fecha:  " << registro.dia << "/" << registro.mes << "/" << registro.yyyy << endl;
-            boletoSalida = registro; 
+    Estacionamiento::ResultadoFolio folio = est.resolverTicket(ticket, ticketId);
+    int lugar = 0;
+    time_t horaEntrada = 0;
+    if (folio != Estacionamiento::FOLIO_ACTIVO || !est.buscarTicket(ticketId, lugar, horaEntrada)) {
+        if (folio == Estacionamiento::FOLIO_MAL_ESCRITO) {
+            cout << "Digito verificador incorrecto: " << ticket << endl;
+        } else {
+            cout << "Ticket no encontrado: " << ticket << endl;
         }
-    }
-    
-    if (!found) {
-        cout << "Ticket no encontrado."  << boletoSalida.id << endl;
-        boletoSalida.id = "";
-        return -2;
+        cout << "------------------------------------------" << endl;
+        cout << "Presione enter para continuar..." << endl;
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        cin.get();
+        return -1;
     }
 
+    cout << "\n    ID:  " << ticketId << endl;
+    cout << " Lugar:  " << est.etiquetaLugar(lugar) << endl;
+    cout << "  Hora:  " << textoHora(horaEntrada) << endl;
+    cout << " Fecha:  " << textoFecha(horaEntrada) << endl;
     cout << "------------------------------------------" << endl;
     do {
         cout << "Desea continuar [s/n]?  ";
@@ -309,121 +155,56 @@ float pagoTotal() {
             cout << "------------------------------------------" << endl;
             cout << "Cancelando el proceso de salida...  " << endl;
             Sleep(500);
-            return 0;
+            return -1;
         }
     } while (op != 's' && op != 'n');
 
-    //Borrando boleto de los cajones de estacionamiento
-    for (int i = 0; i < totalLugares ; i++) {
-        if (lugaresOcupados[i] == boletoSalida.id) {
-            lugaresOcupados [i] = "";
-            lugarIndex = i;
-            found = true;
-            break;
-        }
-    }
-    
-    // hola1
-    wmes << setw(2) << setfill('0') << boletoSalida.mes;
-    wdia << setw(2) << setfill('0') << boletoSalida.dia;
-    wmin << setw(2) << setfill('0') << boletoSalida.min;
-    whora << setw(2) << setfill('0') << boletoSalida.hora;
-
-    time_t now = time(nullptr);
-    tm* tiempo_desglosado = localtime(&now);
-    int yy = tiempo_desglosado->tm_year + 1900;
-    int mm = tiempo_desglosado->tm_mon + 1;
-    int dd = tiempo_desglosado->tm_mday;
-    int hh = tiempo_desglosado->tm_hour;
-    int min = tiempo_desglosado->tm_min;
-// wn, wmm, wdd, whh, wmn
-    wmm << setw(2) << setfill('0') << mm;
-    wdd << setw(2) << setfill('0') << dd;
-    whh << setw(2) << setfill('0') << hh;
-    wmn << setw(2) << setfill('0') << min;
+    float cobro = est.salida(ticketId);
+    time_t horaSalida = time(nullptr);
+    if (cobro < 0) return -1;
+    historial.registrarSalida(ticketId, horaSalida, cobro);
 
     system("cls");
     cout << "\n =====================================" << endl;
-    cout << "===     Ticket: " << boletoSalida.id << "      ===" << endl;
+    cout << "===     Ticket: " << ticketId << "      ===" << endl;
     cout << " =====================================" << endl;
-    cout << "         Lugar: " << "A-" << boletoSalida.lugar << endl;
-    cout << "         Fecha: " << wdia.str() << "/" << wmes.str() << "/" << boletoSalida.yyyy << endl;
-    cout << "          Hora: " << whora.str() <<":" << wmin.str() << endl;
+    cout << "         Lugar: " << est.etiquetaLugar(lugar) << endl;
+    cout << "         Fecha: " << textoFecha(horaEntrada) << endl;
+    cout << "          Hora: " << textoHora(horaEntrada) << endl;
     cout << "\n =====================================" << endl;
     cout << "\n\nDatos actuales: " << endl;
     cout << "-------------------------------------" << endl;
-    cout << "\n  Fecha Salida: " << wdd.str() << "/" <<  wmm.str() << "/" << yy <<  endl;
-    cout << "   Hora Salida: " << whh.str() << ":" << wmn.str() << endl;
-    cout << " Precio x Hora: " << pagoHora << endl;
+    cout << "\n  Fecha Salida: " << textoFecha(horaSalida) << endl;
+    cout << "   Hora Salida: " << textoHora(horaSalida) << endl;
+    cout << " Precio x Hora: " << est.getTarifaPorHora() << endl;
     cout << "\n =====================================" << endl;
 
-    if (yy == boletoSalida.yyyy && boletoSalida.activo) {
-        if (mm == boletoSalida.mes) {
-
-            if (dd == boletoSalida.dia) {
-                if (hh > boletoSalida.hora) {
-                    pagoHH = (hh - boletoSalida.hora) * pagoHora;
-                }
-            } else {
-                if (dd > boletoSalida.dia && (dd - boletoSalida.dia > 1)) {
-                    pagoDD = ((dd -boletoSalida.dia) - 1) * 24;
-                    cout << "\nTotal de horas: " << pagoDD << endl;
-                    pagoDD = (pagoDD + hh) * pagoHora;
-                    pagoMin = min * (pagoHora/60);
-                } else {
-                    pagoDD = (24 - boletoSalida.hora); 
-                    //pagoDD = pagoDD + (dd - boletoSalida.dia);
-                    pagoDD = (pagoDD + hh) * pagoHora;
-                    pagoMin = (min + boletoSalida.min)* (pagoHora / 60);
-                }
-            }
-        }
-    }
-    
-    cout << "\n\nLugar A-" << boletoSalida.lugar << " liberado." << endl;
+    cout << "\n\nLugar " << est.etiquetaLugar(lugar) << " liberado." << endl;
     mensaje = "";
 
-    TotalxCobrar = pagoDD + pagoHH + pagoMin;
-
     cout << "\n    Por favor, " << endl;
     cout << "            reciba:  $ ";
-    cout << fixed << setprecision(2) << TotalxCobrar;
+    cout << fixed << setprecision(2) << cobro;
     cout << "  del cliente. " << endl;
 
-    // desactivar el boleto que sale pero dejarlo en el sistema para consultas
-    for (int i = 0; i < RegistroTickets.size(); i++) {
-        if (RegistroTickets[i].id == boletoSalida.id) {
-            RegistroTickets[i].activo = false;
-            RegistroTickets[i].cobro = TotalxCobrar;
-            //lugarIndex = boletoSalida.lugar;
-            boletoSalida.id = "";
-            boletoSalida.hora = 0;
-            boletoSalida.dia = 0;
-            boletoSalida.yyyy = 0;
-            boletoSalida.mes = 0;
-            boletoSalida.lugar = 0;
-            boletoSalida.placa = "";
-            boletoSalida.cobro = 0;
-            boletoSalida.activo = true;
-        }
-    }    
-
     cout << "\n------------------------------------------" << endl;
     cout << "Presione enter para continuar..." << endl;
     cin.ignore(numeric_limits<streamsize>::max(), '\n');
     cin.get();
-    return TotalxCobrar;
+    return cobro;
 }
 
 void listarLugares() {
+    shared_ptr<const Estacionamiento::Instantanea> vista = est.obtenerInstantanea();
+
     system("cls");
     cout << "\n=====================================" << endl;
     cout << "\nTodos los Cajones del Estacionamiento" << endl;
     cout << "\n-------------------------------------" << endl;
     cout << "\n      Lugar          # de Ticket     " << endl;
     cout << "\n=====================================" << endl;
-    for (int i = 0; i < 6; i++) {
-        cout << "     A-" << i + 1 << "     " << lugaresOcupados[i] << endl;
+    for (int i = 0; i < (int)vista->lugares.size(); i++) {
+        cout << "     " << est.etiquetaLugar(i + 1) << "     " << vista->lugares[i].ticketId << endl;
     }
     cout << "\n------------------------------------------" << endl;
     cout << "Presione enter para continuar..." << endl;
@@ -431,48 +212,239 @@ void listarLugares() {
     cin.get();
 }
 
+// --------------------------- Listado por paginas ------------------------------
+// Cada pagina sale de un indice del historial (ver HistorialTickets::pagina)
+// y solo se formatean sus FILAS_PAGINA renglones.
+const size_t FILAS_PAGINA = 20;
+
+string textoFiltro(const HistorialTickets::Filtro& filtro) {
+    const char* estados[] = {"todos", "activos", "no activos"};
+    string texto = estados[filtro.estado];
+    if (filtro.lugar != 0) texto += ", lugar " + est.etiquetaLugar(filtro.lugar);
+    if (filtro.hasta != 0) texto += ", dia " + textoFecha(filtro.desde);
+    return texto;
+}
+
+HistorialTickets::Filtro pedirFiltro() {
+    HistorialTickets::Filtro filtro;
+    int dia = 0, mes = 0, anio = 0;
+    cout << "\n  Estado (0 todos, 1 activos, 2 no activos): ";
+    cin >> filtro.estado;
+    cout << "  Lugar (0 todos, 1-" << est.capacidad() << "): ";
+    cin >> filtro.lugar;
+    cout << "  Dia de entrada (dd mm aaaa, 0 cualquiera): ";
+    cin >> dia;
+    if (dia != 0) cin >> mes >> anio;
+    if (!cin) {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        return HistorialTickets::Filtro();
+    }
+    if (filtro.estado < 0 || filtro.estado > 2) filtro.estado = 0;
+    if (filtro.lugar < 0 || filtro.lugar > est.capacidad()) filtro.lugar = 0;
+    if (dia != 0) {
+        tm fecha = {};
+        fecha.tm_year = anio - 1900;
+        fecha.tm_mon = mes - 1;
+        fecha.tm_mday = dia;
+        fecha.tm_isdst = -1;
+        filtro.desde = mktime(&fecha);
+        fecha.tm_mday++;
+        fecha.tm_isdst = -1;
+        filtro.hasta = mktime(&fecha);
+    }
+    return filtro;
+}
+
 void listarTickets() {
-    ostringstream wid, wreg, wdd, wmm, whh, wmin;
-    string estado = "activo";
+    HistorialTickets::Filtro filtro;
+    vector<HistorialTickets::Cursor> paginas(1);  // inicio de cada pagina vista, para regresar
+    while (true) {
+        HistorialTickets::Cursor cursor = paginas.back();
+        vector<uint32_t> pagina;
+        bool hayMas = historial.pagina(filtro, cursor, pagina, FILAS_PAGINA);
 
-    system("cls");
-    cout << "\n======================================================" << endl;
-    cout << "\n                  Tickets registrados                 " << endl;
-    cout << "\n------------------------------------------------------" << endl;
-    cout << "\n       ID       Lugar    Fecha      Hora      Activo  " << endl;
-    cout << "\n======================================================" << endl;
-    cout << " " << endl;
-
-    if (RegistroTickets.empty()) {
-        cout << " No hay tickets registrados." << endl;
-    } else { //aqui1
-        for (const auto& registro : RegistroTickets) {
-            wreg << setw(2) << setfill('0') << "A-" << registro.lugar;
-            wdd << setw(2) << setfill('0') << registro.dia;
-            wmm << setw(2) << setfill('0') << registro.mes;
-            whh << setw(2) << setfill('0') << registro.hora;
-            wmin << setw(2) << setfill('0') << registro.min;
-            if (!registro.activo) {
-                estado = "No Activo";
-            } else {
-                estado = "Activo";
-            }
+        system("cls");
+        cout << "\n======================================================" << endl;
+        cout << "\n                  Tickets registrados                 " << endl;
+        cout << "\n------------------------------------------------------" << endl;
+        cout << "\n       ID       Lugar    Fecha      Hora      Activo  " << endl;
+        cout << "\n======================================================" << endl;
+        cout << " " << endl;
+
+        if (pagina.empty()) {
+            cout << " No hay tickets registrados." << endl;
+        }
+        for (uint32_t i : pagina) {
+            mostrarRenglon(historial[i], false);
+        }
+
+        cout << "\n======================================================" << endl;
+        cout << " Pagina " << paginas.size() << " (" << textoFiltro(filtro) << ", "
+             << historial.total() << " tickets en total)" << endl;
+        cout << " [S]iguiente  [A]nterior  [F]iltrar  [Esc] regresar" << endl;
+
+        int tecla = toupper(_getch());
+        if (tecla == 27 || tecla == 'Q') {
+            return;
+        } else if ((tecla == 'S' || tecla == ' ' || tecla == '\r') && hayMas) {
+            paginas.push_back(cursor);
+        } else if (tecla == 'A' && paginas.size() > 1) {
+            paginas.pop_back();
+        } else if (tecla == 'F') {
+            filtro = pedirFiltro();
+            paginas.assign(1, HistorialTickets::Cursor());
+        }
+    }
+}
 
-            cout << registro.id <<"   " <<  wreg.str() << "   " << wdd.str();
-            cout << "/" << wmm.str() << "/" << registro.yyyy << "   ";
-            cout <<  whh.str() << ":" << wmin.str() << "   " << estado << endl;
-            wreg.str("");
-            wid.str("");
-            wreg.str("");
-            wdd.str("");
-            wmm.str("");
-            whh.str("");
-            wmin.str("");
+// Asigna lo tecleado (nada si quedo vacio) al ticket de la captura en curso
+void terminarCapturaPlaca() {
+    if (!capturaPlaca.activa) return;
+    cout << endl;
+    historial.registrarPlaca(capturaPlaca.ticketId, capturaPlaca.placa);
+    capturaPlaca.activa = false;
+}
+
+// La pluma ya abrio: el operador puede teclear la placa del auto que entro
+// mientras el ciclo principal sigue atendiendo las plumas. Si otro auto
+// entra antes, el anterior se queda con lo que llevaba.
+void iniciarCapturaPlaca(const string& ticketId) {
+    terminarCapturaPlaca();
+    cout << "\n      Placa (Enter para omitir): ";
+    capturaPlaca.activa = true;
+    capturaPlaca.ticketId = ticketId;
+    capturaPlaca.placa.clear();
+    capturaPlaca.inicio = GetTickCount();
+}
+
+// Una vuelta del ciclo principal: toma las teclas que ya esten esperando,
+// sin bloquear. La placa se asigna con Enter o a los ESPERA_PLACA_MS de
+// empezar, aunque se siga tecleando.
+void atenderCapturaPlaca() {
+    while (capturaPlaca.activa && _kbhit()) {
+        int tecla = _getch();
+        if (tecla == '\r' || tecla == '\n') {
+            terminarCapturaPlaca();
+        } else if (tecla == 8 && !capturaPlaca.placa.empty()) {
+            capturaPlaca.placa.pop_back();
+            cout << "\b \b";
+        } else if (isalnum(tecla) || tecla == '-') {
+            capturaPlaca.placa += (char)tecla;
+            cout << (char)tecla;
         }
     }
+    if (capturaPlaca.activa && GetTickCount() - capturaPlaca.inicio >= ESPERA_PLACA_MS) {
+        terminarCapturaPlaca();
+    }
+}
+
+// Ticket perdido: busca por placa exacta, luego por prefijo y luego con un
+// caracter equivocado
+void buscarPorPlaca() {
+    string placa;
 
-    cout << "\n======================================================" << endl;
-    cout << "\n   Presione enter para continuar..." << endl;
+    cout << "\n     =================================" << endl;
+    cout << "     ===   Buscar ticket x placa   ===" << endl;
+    cout << "     =================================" << endl;
+    cout << "\n      Teclear placa completa o inicio" << endl;
+    cout << "    (Presione enter al terminar): ";
+    cin >> placa;
+
+    vector<uint32_t> encontrados;
+    string criterio = historial.buscarPlaca(placa, encontrados, 20);
+
+    cout << "\n------------------------------------------" << endl;
+    if (encontrados.empty()) {
+        cout << "Ninguna placa coincide con " << IndicePlacas::normalizar(placa) << endl;
+    } else {
+        cout << " Busqueda " << criterio << ": " << encontrados.size() << " ticket(s)\n" << endl;
+        for (uint32_t i : encontrados) {
+            mostrarRenglon(historial[i], true);
+        }
+    }
+    cout << "------------------------------------------" << endl;
+    cout << "Presione enter para continuar..." << endl;
+    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+    cin.get();
+}
+
+void mostrarRenglonesHora(const vector<uint32_t>& encontrados, bool completos) {
+    cout << "\n------------------------------------------" << endl;
+    if (encontrados.empty()) {
+        cout << " Ningun ticket." << endl;
+    }
+    for (uint32_t i : encontrados) {
+        mostrarRenglon(historial[i], false);
+    }
+    if (!completos) cout << " (solo los primeros " << encontrados.size() << ")" << endl;
+    cout << "------------------------------------------" << endl;
+    cout << "Presione enter para continuar..." << endl;
+    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+    cin.get();
+}
+
+// Tickets que entraron un dia entre dos horas, p. ej. 21/11/2025 de 08:00 a 09:00
+void buscarPorHora() {
+    tm desde = {}, hasta = {};
+    int dia, mes, anio, hhDesde, mmDesde, hhHasta, mmHasta;
+
+    cout << "\n     =================================" << endl;
+    cout << "     ===   Tickets por fecha/hora  ===" << endl;
+    cout << "     =================================" << endl;
+    cout << "\n      Fecha (dd mm aaaa): ";
+    cin >> dia >> mes >> anio;
+    cout << "      Desde (hh mm): ";
+    cin >> hhDesde >> mmDesde;
+    cout << "      Hasta (hh mm): ";
+    cin >> hhHasta >> mmHasta;
+    if (!cin) {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        return;
+    }
+
+    desde.tm_year = hasta.tm_year = anio - 1900;
+    desde.tm_mon = hasta.tm_mon = mes - 1;
+    desde.tm_mday = hasta.tm_mday = dia;
+    desde.tm_hour = hhDesde;
+    desde.tm_min = mmDesde;
+    hasta.tm_hour = hhHasta;
+    hasta.tm_min = mmHasta;
+    desde.tm_isdst = hasta.tm_isdst = -1;
+
+    vector<uint32_t> encontrados;
+    bool completos = historial.buscarEntradas(mktime(&desde), mktime(&hasta), encontrados, MAX_RESULTADOS);
+    mostrarRenglonesHora(encontrados, completos);
+}
+
+// Autos que siguen dentro desde hace mas de N horas, el mas antiguo primero
+void listarEstanciasLargas() {
+    int horas;
+    cout << "\n      Mas de cuantas horas: ";
+    if (!(cin >> horas)) {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        return;
+    }
+    vector<uint32_t> encontrados;
+    bool completos = historial.buscarEstanciasLargas(time(nullptr) - (time_t)horas * 3600, encontrados,
+                                                     MAX_RESULTADOS);
+    mostrarRenglonesHora(encontrados, completos);
+}
+
+// historial.csv / .tkc y historial_diario.csv / .tkc en el directorio actual
+void exportarHistorial() {
+    long long filas = historial.exportar("historial", 1, compresionDisponible());
+    cout << "\n------------------------------------------" << endl;
+    if (filas >= 0) {
+        cout << " " << filas << " tickets exportados a historial.csv / historial.tkc" << endl;
+        cout << " Resumen por dia en historial_diario.csv / historial_diario.tkc" << endl;
+    } else {
+        cout << " ERROR: no se pudo escribir el historial" << endl;
+    }
+    cout << "------------------------------------------" << endl;
+    cout << "Presione enter para continuar..." << endl;
     cin.ignore(numeric_limits<streamsize>::max(), '\n');
     cin.get();
 }
@@ -487,6 +459,10 @@ void menu() {
         cout << "\n  1) Consulta ticket por numero  " << endl;
         cout << "\n  2) Listar todos los tickets    " << endl;
         cout << "\n  3) Listar lugares              " << endl;
+        cout << "\n  4) Buscar ticket por placa     " << endl;
+        cout << "\n  5) Tickets por fecha y hora    " << endl;
+        cout << "\n  6) Autos con mas de N horas    " << endl;
+        cout << "\n  7) Exportar historial          " << endl;
         cout << "\n  0) Salir                       " << endl;
         cout << "\n" << endl;
         cout << "\n=================================" << endl;
@@ -503,43 +479,64 @@ void menu() {
             case 1: consultarTicket(); break;
             case 2: listarTickets(); break;
             case 3: listarLugares(); break;
+            case 4: buscarPorPlaca(); break;
+            case 5: buscarPorHora(); break;
+            case 6: listarEstanciasLargas(); break;
+            case 7: exportarHistorial(); break;
             case 0: break;
             default: cout << "Opcion invalida." << endl; Sleep(500); break;
         }
     }
 }
 
-void cargaPrevia(){
-    //                             id            hr  min dia yy    mm lug  placa   cobro activo
-    RegistroTickets.push_back({"TCK-2025110001", 10, 30, 19, 2025, 11, 1, "ABC123", 0, true});
-    RegistroTickets.push_back({"TCK-2025110002", 11, 15, 21, 2025, 11, 2, "DEF456", 0, true});
-    RegistroTickets.push_back({"TCK-2025110003", 12, 0, 20, 2025, 11, 3, "GHI789", 0, true});
+// Los tickets de prueba del nucleo, con placa, tambien en el historial
+void cargaPrevia() {
+    est.cargaPrevia();
 
-    lugaresOcupados[0] = "TCK-2025110001";
-    lugaresOcupados[1] = "TCK-2025110002";
-    lugaresOcupados[2] = "TCK-2025110003";
-
-    contadorTickets = 3;
+    shared_ptr<const Estacionamiento::Instantanea> vista = est.obtenerInstantanea();
+    vector<int> ocupados;
+    for (int i = 0; i < (int)vista->lugares.size(); i++) {
+        if (vista->lugares[i].ocupado) ocupados.push_back(i);
+    }
+    // En orden de entrada, como si hubieran llegado en vivo
+    sort(ocupados.begin(), ocupados.end(),
+         [&](int a, int b) { return vista->lugares[a].horaEntrada < vista->lugares[b].horaEntrada; });
+
+    const char* placas[] = {"ABC123", "DEF456", "GHI789"};
+    for (int i : ocupados) {
+        const Estacionamiento::Lugar& lugar = vista->lugares[i];
+        historial.registrarEntrada(lugar.ticketId, i + 1, lugar.horaEntrada);
+        if (i < 3) historial.registrarPlaca(lugar.ticketId, placas[i]);
+    }
 }
 
 // --------------------------- Función principal ------------------------------
-int main() {
+// Uso: estacionamiento01 [archivo]   configuracion del lote (estacionamiento.cfg
+//                                     por omision, ver configurarConsola)
+int main(int argc, char* argv[]) {
     SerialController controller;
     int accionRsp = 0;
-    int pos = -1;
-    string wnum;
     string puerto;
-    string mensaje = "";
 
-    // Intentar varios puertos
-    const char* puertos[] = { "COM3", "COM4", "COM5", "COM6", "COM7", "COM8" };
+    string rutaConfiguracion = argc > 1 ? argv[1] : CONFIGURACION_CONSOLA;
+    ConfiguracionLote configuracion;
+    string error;
+    if (!configurarConsola(est, rutaConfiguracion, configuracion, error)) {
+        cout << "Error: configuracion " << rutaConfiguracion << ": " << error << endl;
+        return 1;
+    }
+
+    // Los puertos de la configuracion, en orden
     bool conectado = false;
-    for (const char* p : puertos) {
-        if (controller.connect(p)) {
+    for (const string& p : configuracion.puertos) {
+        cout << "Intentando conectar a " << p << "..." << endl;
+        if (controller.connect(p.c_str(), false, configuracion.baudios)) {
+            cout << "Conectado al puerto " << p << " correctamente!" << endl;
             puerto = p;
             conectado = true;
             break;
         }
+        cout << "Error al conectar a " << p << endl;
     }
 
     cargaPrevia();
@@ -556,93 +553,54 @@ int main() {
     bool mostrarPantallaEspera = true;
 
     while (true) {
-        controller.checkForData();
-
         if (controller.hasNewData()) {
             string datoRecibido = controller.getLastData();
-            
+            TRAZAR_TEXTO(TRAZA_INFO, EV_SERIAL_DATO, (int32_t)datoRecibido.size(), 0,
+                         datoRecibido.data(), datoRecibido.size());
+
             // Si llega nuevo dato, permitimos re-dibujar la pantalla de espera
             mostrarPantallaEspera = true;
 
-            // buscar primer numero (soporta que vengan letras antes)
-            pos = (int)datoRecibido.find_first_of("0123456789");
-            if (pos >= 0) {
-                // tomamos hasta 3 dígitos por si acaso (ajustar según protocolo)
-                int len = 2;
-                if ((int)datoRecibido.size() - pos < len) len = (int)datoRecibido.size() - pos;
-                wnum = datoRecibido.substr(pos, len);
-                int val = -1;
-                try { val = stoi(wnum); } catch(...) { val = -1; }
+            // Primer codigo del bloque: la linea completa en digitos (ver protocoloMega.h)
+            TramaMega trama = primerCodigoMega(datoRecibido.data(), datoRecibido.size());
+            if (trama.tipo == TRAMA_CODIGO) {
+                accionRsp = trama.codigo;
+                TRAZAR(TRAZA_INFO, EV_CODIGO, accionRsp, 0);
 
-                cout << "valor (val) = " << val << endl;
-                accionRsp = val;
-
-                cout << "valor leido = " << accionRsp << endl;
                 if (accionRsp >= 0) {
                     switch (accionRsp) {
-                        case 40: {
-                            int lugarIndex = encontrarLugarDisponible();
-                            cout << "lugar indice = " << lugarIndex << endl;
-                            if (lugarIndex != -1) {
-
-                                 // MARCAR EL LUGAR COMO OCUPADO
-                                numeroLugar = lugarIndex + 1;  // Para mostrar A-1, A-2, etc.
-
-                                ostringstream wnum, wmes, wdia, whora, wmin;
-
-                                time_t now = time(nullptr);
-                                tm* tiempo_desglosado = localtime(&now);
-                                int yy = tiempo_desglosado->tm_year + 1900;
-
-                                int mm = tiempo_desglosado->tm_mon + 1;
-                                wmes << setw(2) << setfill('0') << mm;
-
-                                int dd = tiempo_desglosado->tm_mday;
-                                wdia << setw(2) << setfill('0') << dd;
-
-                                int hh = tiempo_desglosado->tm_hour;
-                                whora << setw(2) << setfill('0') << hh;
-
-                                int min = tiempo_desglosado->tm_min;
-                                wmin << setw(2) << setfill('0') << min;
-
-                                contadorTickets++;
-                                wnum << setw(4) << setfill('0') << contadorTickets;
+                        case CODIGO_ENTRADA: {
+                            // El lugar lo elige la politica del nucleo, que tambien genera el folio
+                            int lugar = est.entrada();
+                            if (lugar != -1) {
+                                TRAZAR(TRAZA_INFO, EV_LUGAR_ASIGNADO, lugar, 0);
+                                shared_ptr<const Estacionamiento::Instantanea> vista = est.obtenerInstantanea();
+                                const Estacionamiento::Lugar& asignado = vista->lugares[lugar - 1];
+                                historial.registrarEntrada(asignado.ticketId, lugar, asignado.horaEntrada);
 
                                 system("cls");
                                 cout << "\n\nRecibiendo auto... " << endl;
-                                cout << "\n  " << wdia.str() << "/" << wmes.str() << "/" << yy << "   ----   " << whora.str() << ":" << wmin.str() << endl;
+                                cout << "\n  " << textoFecha(asignado.horaEntrada) << "   ----   "
+                                     << textoHora(asignado.horaEntrada) << endl;
                                 cout << "\n--------------------------------" << endl;
                                 cout << "     Entrada de vehiculo\n" << endl;
                                 cout << "\n     Generando ticket... " << endl;
 
-                                Ticket nuevoTicket;
-                                
-                                nuevoTicket.id = "TCK-" + to_string(yy) + wmes.str() +  wnum.str();
-                                nuevoTicket.lugar = numeroLugar;
-                                nuevoTicket.hora = hh;
-                                nuevoTicket.min = min;
-                                nuevoTicket.dia = dd;
-                                nuevoTicket.mes = mm;
-                                nuevoTicket.yyyy = yy;
-                                nuevoTicket.placa = "ABC1234";
-                                lugaresOcupados[lugarIndex] = nuevoTicket.id;
-
-                                RegistroTickets.push_back(nuevoTicket);
-
                                 cout << "\n     =================================" << endl;
                                 cout << "\n     === TICKET DE ESTACIONAMIENTO ===" << endl;
                                 cout << "\n     =================================" << endl;
-                                cout << "      Ticket: # " << nuevoTicket.id << "\n" << endl;
-                                cout << "      Fecha Actual: " << wdia.str() << "/" << wmes.str() << "/" << yy << endl;
-                                cout << "      Hora  Actual: " << whora.str() << ":" << wmin.str() << endl;
-                                cout << "      Lugar: " << "A-" << nuevoTicket.lugar << endl;
+                                cout << "      Ticket: # " << asignado.ticketId << "\n" << endl;
+                                cout << "      Fecha Actual: " << textoFecha(asignado.horaEntrada) << endl;
+                                cout << "      Hora  Actual: " << textoHora(asignado.horaEntrada) << endl;
+                                cout << "      Lugar: " << est.etiquetaLugar(lugar) << endl;
                                 cout << "\n     =================================" << endl;
                                 cout << "\nPresione <F2> para acceder al Menu" << endl;
                                 Sleep(400);
                                 controller.sendData("1");
                                 controller.clearSerialBuffer();
+                                iniciarCapturaPlaca(asignado.ticketId);
                             } else {
+                                TRAZAR(TRAZA_AVISO, EV_SIN_LUGARES, est.capacidad(), 0);
                                 mensaje =  "\n\n\n      No hay lugares!!!";
                                 controller.sendData("0");
                                 controller.clearSerialBuffer();
@@ -650,23 +608,25 @@ int main() {
                             }
                             break;
                         }
-                        case 30: {
-                                if (contarLugaresOcupados() >=  0) {
+                        case CODIGO_SALIDA: {
+                                // El cobro lee el teclado: la placa pendiente se queda como va
+                                terminarCapturaPlaca();
+                                if (est.obtenerInstantanea()->ocupados > 0) {
                                     system("cls");
                                     cout << "\n     ===    SALIDA DE VEHICULO     ===" << endl;
                                     float cobrar = pagoTotal();
 
-                                    if (cobrar == 0 && boletoSalida.min <= 15) { 
+                                    if (cobrar < 0) {
+                                        cout << "Proceso cancelado... " << endl;
                                         cout << "\n     ===    Abra la pluma manualmente     ===" << endl;
+                                        controller.sendData("0");
                                         controller.clearSerialBuffer();
                                         break;
                                     }
-                                    if (cobrar < 0 ) {
-                                        cout << "Proceso cancelado... " << endl;
-                                    }
-                                
+
                                     //salida
-                                    cout << "Lugares disponibles: " << contarLugaresOcupados()  << endl;
+                                    shared_ptr<const Estacionamiento::Instantanea> vista = est.obtenerInstantanea();
+                                    cout << "Lugares disponibles: " << vista->lugares.size() - vista->ocupados << endl;
                                     Sleep(300);
                                     controller.sendData("2");
                                     controller.clearSerialBuffer();
@@ -685,9 +645,10 @@ int main() {
                         }
                         } // switch
                 } // accionRsp
-            } // pos
+            } // trama
         } else {
-            if (mostrarPantallaEspera) {
+            // Sin borrar el ticket mientras se teclea su placa
+            if (mostrarPantallaEspera && !capturaPlaca.activa) {
                 system("cls");
                 cout << "\n\n\n" << endl;
                 cout << "=== SISTEMA DE ESTACIONAMIENTO ===" << endl;
@@ -700,8 +661,10 @@ int main() {
             }
         }
 
-        // Manejo de teclado no bloqueante: detectar F2 y F10
-        if (_kbhit()) {
+        // Manejo de teclado no bloqueante: la placa en captura o F2 y F10
+        if (capturaPlaca.activa) {
+            atenderCapturaPlaca();
+        } else if (_kbhit()) {
             int t = _getch();
             if (t == 0 || t == 224) {
                 int key = _getch();
@@ -728,5 +691,6 @@ int main() {
         Sleep(100); // dormir 100 ms por ciclo
     } // while
 
+    volcarTraza("estacionamiento01.trz");
     return 0;
-}
\ No newline at end of file
+}
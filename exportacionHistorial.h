@@ -0,0 +1,610 @@
+#ifndef EXPORTACION_HISTORIAL_H
+#define EXPORTACION_HISTORIAL_H
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef ESTACIONAMIENTO_ZLIB
+#include <zlib.h>
+#endif
+
+using namespace std;
+
+// ==================== EXPORTACION DEL HISTORIAL ====================
+// Escribe tablas (historial de tickets, resumen por dia) fila por fila a CSV
+// y a un formato binario por columnas, en bloques: la memoria no depende de
+// cuantas filas se exporten, solo de FILAS_POR_BLOQUE.
+//
+// Formato por columnas ("TKC1"):
+//   cabecera: "TKC1", varint(columnas), por columna byte(tipo) y
+//             varint(longitud) + nombre
+//   bloque:   varint(filas), byte(compresion), varint(bytes crudos),
+//             varint(bytes guardados), datos; un bloque de 0 filas cierra
+//   datos:    columna tras columna, varint(longitud) + bytes
+//     ENTERO, FECHA: zigzag(valor - valor de la fila anterior) en varint
+//     TEXTO:         varint(prefijo comun con el anterior), varint(resto), resto
+// Compresion: 0 ninguna, 1 zlib (solo si se compilo con ESTACIONAMIENTO_ZLIB).
+// FECHA es epoch en segundos; en el CSV sale como hora local y 0 queda vacio.
+
+const char CABECERA_COLUMNAR[4] = {'T', 'K', 'C', '1'};
+const size_t FILAS_POR_BLOQUE = 16384;
+
+enum TipoColumna { COLUMNA_ENTERO = 0, COLUMNA_FECHA = 1, COLUMNA_TEXTO = 2 };
+enum CompresionBloque { SIN_COMPRESION = 0, COMPRESION_ZLIB = 1 };
+
+struct ColumnaTabla {
+    string nombre;
+    TipoColumna tipo;
+};
+
+// Valor de una celda: 'entero' para ENTERO y FECHA, 'texto' para TEXTO
+struct Celda {
+    int64_t entero;
+    string_view texto;
+};
+
+inline bool compresionDisponible() {
+#ifdef ESTACIONAMIENTO_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+// localtime() vuelve a revisar la zona horaria en cada llamada (~2 us con
+// glibc, mas que todo lo demas de una fila). Los cambios de horario caen en
+// multiplos de 15 min UTC, asi que basta convertir el inicio de cada cuarto
+// de hora y sumar los segundos; se guardan los ultimos cuartos usados.
+class HoraLocal {
+private:
+    static const int SEGUNDOS_CUARTO = 900;
+    static const int CUBETAS = 64;
+
+    struct Cubeta {
+        int64_t cuarto;
+        tm inicio;
+    };
+    Cubeta cubetas[CUBETAS];
+
+public:
+    HoraLocal() {
+        for (Cubeta& c : cubetas) c.cuarto = INT64_MIN;
+    }
+
+    bool convertir(int64_t t, tm& resultado) {
+        int64_t cuarto = t / SEGUNDOS_CUARTO - (t % SEGUNDOS_CUARTO < 0 ? 1 : 0);
+        Cubeta& c = cubetas[(uint64_t)cuarto % CUBETAS];
+        if (c.cuarto != cuarto) {
+            time_t inicio = (time_t)(cuarto * SEGUNDOS_CUARTO);
+            tm* fecha = localtime(&inicio);
+            if (fecha == nullptr) return false;
+            c.inicio = *fecha;
+            c.cuarto = cuarto;
+        }
+        // El cuarto empieza en hh:00, :15, :30 o :45 local: no se pasa de la hora
+        int segundos = (int)(t - cuarto * SEGUNDOS_CUARTO);
+        resultado = c.inicio;
+        resultado.tm_min += segundos / 60;
+        resultado.tm_sec += segundos % 60;
+        return true;
+    }
+
+    // "2025-11-21 08:15:00"; vacio para 0
+    void formatear(int64_t t, string& destino) {
+        tm fecha;
+        if (t == 0 || !convertir(t, fecha)) return;
+        char texto[24];
+        size_t n = strftime(texto, sizeof(texto), "%Y-%m-%d %H:%M:%S", &fecha);
+        destino.append(texto, n);
+    }
+};
+
+// ---------------------------- CSV --------------------------------------------
+class EscritorCsv {
+private:
+    FILE* archivo;
+    bool propio;  // se abrio aqui y se cierra aqui (no stdout)
+    vector<ColumnaTabla> columnas;
+    string pendiente;
+    HoraLocal horaLocal;
+
+    void vaciar() {
+        if (!pendiente.empty()) fwrite(pendiente.data(), 1, pendiente.size(), archivo);
+        pendiente.clear();
+    }
+
+    void agregarTexto(string_view texto) {
+        if (texto.find_first_of(",\"\r\n") == string_view::npos) {
+            pendiente.append(texto.data(), texto.size());
+            return;
+        }
+        pendiente += '"';
+        for (char c : texto) {
+            if (c == '"') pendiente += '"';
+            pendiente += c;
+        }
+        pendiente += '"';
+    }
+
+public:
+    EscritorCsv() : archivo(nullptr), propio(false) {}
+    ~EscritorCsv() { cerrar(); }
+
+    bool abrir(const string& ruta, const vector<ColumnaTabla>& cols) {
+        FILE* f = fopen(ruta.c_str(), "wb");
+        if (f == nullptr) return false;
+        abrir(f, cols);
+        propio = true;
+        return true;
+    }
+
+    // Sobre un archivo ya abierto (p. ej. stdout); no se cierra al terminar
+    void abrir(FILE* f, const vector<ColumnaTabla>& cols) {
+        archivo = f;
+        propio = false;
+        columnas = cols;
+        for (size_t i = 0; i < columnas.size(); i++) {
+            if (i > 0) pendiente += ',';
+            agregarTexto(columnas[i].nombre);
+        }
+        pendiente += '\n';
+    }
+
+    void fila(const Celda* celdas) {
+        for (size_t i = 0; i < columnas.size(); i++) {
+            if (i > 0) pendiente += ',';
+            if (columnas[i].tipo == COLUMNA_TEXTO) {
+                agregarTexto(celdas[i].texto);
+            } else if (columnas[i].tipo == COLUMNA_FECHA) {
+                horaLocal.formatear(celdas[i].entero, pendiente);
+            } else {
+                pendiente += to_string((long long)celdas[i].entero);
+            }
+        }
+        pendiente += '\n';
+        if (pendiente.size() >= 64 * 1024) vaciar();
+    }
+
+    // false si fallo alguna escritura
+    bool cerrar() {
+        if (archivo == nullptr) return true;
+        vaciar();
+        bool ok = !ferror(archivo);
+        if (propio) {
+            ok = fclose(archivo) == 0 && ok;
+        } else {
+            fflush(archivo);
+        }
+        archivo = nullptr;
+        return ok;
+    }
+};
+
+// ---------------------------- Por columnas -----------------------------------
+inline void escribirVarintColumnar(string& destino, uint64_t valor) {
+    while (valor >= 0x80) {
+        destino += (char)((valor & 0x7F) | 0x80);
+        valor >>= 7;
+    }
+    destino += (char)valor;
+}
+
+// false si se acaba el buffer o el varint es invalido
+inline bool leerVarintColumnar(const uint8_t*& p, const uint8_t* fin, uint64_t& valor) {
+    valor = 0;
+    for (int corrimiento = 0; corrimiento < 64; corrimiento += 7) {
+        if (p == fin) return false;
+        uint8_t byte = *p++;
+        valor |= (uint64_t)(byte & 0x7F) << corrimiento;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+inline uint64_t zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+inline int64_t desZigzag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+class EscritorColumnar {
+private:
+    FILE* archivo;
+    bool comprimir;
+    vector<ColumnaTabla> columnas;
+    vector<string> datos;          // bytes del bloque en curso, por columna
+    vector<int64_t> anteriorEntero;
+    vector<string> anteriorTexto;
+    size_t filasBloque;
+    string bloque, guardado;
+    bool error;
+
+    void escribir(const string& bytes) {
+        if (fwrite(bytes.data(), 1, bytes.size(), archivo) != bytes.size()) error = true;
+    }
+
+    void cerrarBloque() {
+        if (filasBloque == 0) return;
+        string crudo;
+        for (string& columna : datos) {
+            escribirVarintColumnar(crudo, columna.size());
+            crudo += columna;
+            columna.clear();
+        }
+        const string* cuerpo = &crudo;
+        uint8_t compresion = SIN_COMPRESION;
+#ifdef ESTACIONAMIENTO_ZLIB
+        if (comprimir) {
+            uLongf largo = compressBound((uLong)crudo.size());
+            guardado.resize(largo);
+            if (compress2((Bytef*)&guardado[0], &largo, (const Bytef*)crudo.data(), (uLong)crudo.size(), 1) == Z_OK &&
+                largo < crudo.size()) {
+                guardado.resize(largo);
+                cuerpo = &guardado;
+                compresion = COMPRESION_ZLIB;
+            }
+        }
+#endif
+        bloque.clear();
+        escribirVarintColumnar(bloque, filasBloque);
+        bloque += (char)compresion;
+        escribirVarintColumnar(bloque, crudo.size());
+        escribirVarintColumnar(bloque, cuerpo->size());
+        escribir(bloque);
+        escribir(*cuerpo);
+        // Cada bloque se decodifica solo: los deltas vuelven a empezar
+        for (int64_t& v : anteriorEntero) v = 0;
+        for (string& t : anteriorTexto) t.clear();
+        filasBloque = 0;
+    }
+
+public:
+    EscritorColumnar() : archivo(nullptr), comprimir(false), filasBloque(0), error(false) {}
+    ~EscritorColumnar() { cerrar(); }
+
+    // 'comprimir' se ignora si no se compilo con ESTACIONAMIENTO_ZLIB
+    bool abrir(const string& ruta, const vector<ColumnaTabla>& cols, bool comprimirBloques = false) {
+        archivo = fopen(ruta.c_str(), "wb");
+        if (archivo == nullptr) return false;
+        comprimir = comprimirBloques;
+        columnas = cols;
+        datos.assign(columnas.size(), string());
+        anteriorEntero.assign(columnas.size(), 0);
+        anteriorTexto.assign(columnas.size(), string());
+        filasBloque = 0;
+        error = false;
+        string cabecera(CABECERA_COLUMNAR, sizeof(CABECERA_COLUMNAR));
+        escribirVarintColumnar(cabecera, columnas.size());
+        for (const ColumnaTabla& c : columnas) {
+            cabecera += (char)c.tipo;
+            escribirVarintColumnar(cabecera, c.nombre.size());
+            cabecera += c.nombre;
+        }
+        escribir(cabecera);
+        return true;
+    }
+
+    void fila(const Celda* celdas) {
+        for (size_t i = 0; i < columnas.size(); i++) {
+            string& destino = datos[i];
+            if (columnas[i].tipo == COLUMNA_TEXTO) {
+                string_view texto = celdas[i].texto;
+                string& anterior = anteriorTexto[i];
+                size_t comun = 0;
+                while (comun < texto.size() && comun < anterior.size() && texto[comun] == anterior[comun]) comun++;
+                escribirVarintColumnar(destino, comun);
+                escribirVarintColumnar(destino, texto.size() - comun);
+                destino.append(texto.data() + comun, texto.size() - comun);
+                anterior.assign(texto.data(), texto.size());
+            } else {
+                escribirVarintColumnar(destino, zigzag(celdas[i].entero - anteriorEntero[i]));
+                anteriorEntero[i] = celdas[i].entero;
+            }
+        }
+        if (++filasBloque == FILAS_POR_BLOQUE) cerrarBloque();
+    }
+
+    bool cerrar() {
+        if (archivo == nullptr) return true;
+        cerrarBloque();
+        string fin;
+        escribirVarintColumnar(fin, 0);
+        escribir(fin);
+        bool ok = !error && fclose(archivo) == 0;
+        archivo = nullptr;
+        return ok;
+    }
+};
+
+// Lee un archivo TKC1 bloque por bloque
+class LectorColumnar {
+private:
+    FILE* archivo;
+    vector<ColumnaTabla> columnas;
+    vector<vector<int64_t>> enteros;  // por columna ENTERO/FECHA
+    vector<vector<string>> textos;    // por columna TEXTO
+    size_t filas;
+    bool completo;  // se leyo el bloque de cierre
+    string crudo, guardado;
+
+    bool leerVarint(uint64_t& valor) {
+        valor = 0;
+        for (int corrimiento = 0; corrimiento < 64; corrimiento += 7) {
+            int c = fgetc(archivo);
+            if (c == EOF) return false;
+            valor |= (uint64_t)(c & 0x7F) << corrimiento;
+            if ((c & 0x80) == 0) return true;
+        }
+        return false;
+    }
+
+    bool leerBytes(string& destino, uint64_t n) {
+        if (n > (1ULL << 31)) return false;
+        destino.resize((size_t)n);
+        return n == 0 || fread(&destino[0], 1, (size_t)n, archivo) == n;
+    }
+
+    bool decodificarColumna(size_t c, const uint8_t* p, const uint8_t* fin) {
+        if (columnas[c].tipo == COLUMNA_TEXTO) {
+            vector<string>& destino = textos[c];
+            destino.assign(filas, string());
+            string anterior;
+            for (size_t f = 0; f < filas; f++) {
+                uint64_t comun, resto;
+                if (!leerVarintColumnar(p, fin, comun) || !leerVarintColumnar(p, fin, resto)) return false;
+                if (comun > anterior.size() || resto > (uint64_t)(fin - p)) return false;
+                anterior.resize((size_t)comun);
+                anterior.append((const char*)p, (size_t)resto);
+                p += resto;
+                destino[f] = anterior;
+            }
+        } else {
+            vector<int64_t>& destino = enteros[c];
+            destino.resize(filas);
+            int64_t anterior = 0;
+            for (size_t f = 0; f < filas; f++) {
+                uint64_t delta;
+                if (!leerVarintColumnar(p, fin, delta)) return false;
+                anterior += desZigzag(delta);
+                destino[f] = anterior;
+            }
+        }
+        return p == fin;
+    }
+
+public:
+    LectorColumnar() : archivo(nullptr), filas(0), completo(false) {}
+    ~LectorColumnar() {
+        if (archivo != nullptr) fclose(archivo);
+    }
+
+    bool abrir(const string& ruta) {
+        archivo = fopen(ruta.c_str(), "rb");
+        if (archivo == nullptr) return false;
+        char cabecera[sizeof(CABECERA_COLUMNAR)];
+        uint64_t total;
+        if (fread(cabecera, 1, sizeof(cabecera), archivo) != sizeof(cabecera) ||
+            memcmp(cabecera, CABECERA_COLUMNAR, sizeof(cabecera)) != 0 || !leerVarint(total) || total > 256) {
+            return false;
+        }
+        columnas.clear();
+        for (uint64_t i = 0; i < total; i++) {
+            int tipo = fgetc(archivo);
+            uint64_t largo;
+            ColumnaTabla c;
+            if (tipo < COLUMNA_ENTERO || tipo > COLUMNA_TEXTO || !leerVarint(largo) || largo > 256 ||
+                !leerBytes(c.nombre, largo)) {
+                return false;
+            }
+            c.tipo = (TipoColumna)tipo;
+            columnas.push_back(c);
+        }
+        enteros.assign(columnas.size(), vector<int64_t>());
+        textos.assign(columnas.size(), vector<string>());
+        return true;
+    }
+
+    const vector<ColumnaTabla>& getColumnas() const {
+        return columnas;
+    }
+
+    // false al terminar el archivo o si esta danado (ver terminado())
+    bool siguienteBloque() {
+        uint64_t n, largoCrudo, largoGuardado;
+        filas = 0;
+        if (archivo == nullptr || completo || !leerVarint(n)) return false;
+        if (n == 0) {
+            completo = true;
+            return false;
+        }
+        int compresion = fgetc(archivo);
+        if (n > FILAS_POR_BLOQUE || !leerVarint(largoCrudo) || !leerVarint(largoGuardado)) return false;
+        if (compresion == SIN_COMPRESION) {
+            if (largoCrudo != largoGuardado || !leerBytes(crudo, largoCrudo)) return false;
+        } else if (compresion == COMPRESION_ZLIB) {
+#ifdef ESTACIONAMIENTO_ZLIB
+            if (!leerBytes(guardado, largoGuardado) || largoCrudo > (1ULL << 31)) return false;
+            crudo.resize((size_t)largoCrudo);
+            uLongf largo = (uLongf)largoCrudo;
+            if (uncompress((Bytef*)&crudo[0], &largo, (const Bytef*)guardado.data(), (uLong)guardado.size()) != Z_OK ||
+                largo != largoCrudo) {
+                return false;
+            }
+#else
+            return false;  // compilado sin zlib
+#endif
+        } else {
+            return false;
+        }
+        filas = (size_t)n;
+        const uint8_t* p = (const uint8_t*)crudo.data();
+        const uint8_t* fin = p + crudo.size();
+        for (size_t c = 0; c < columnas.size(); c++) {
+            uint64_t largo;
+            if (!leerVarintColumnar(p, fin, largo) || largo > (uint64_t)(fin - p) ||
+                !decodificarColumna(c, p, p + largo)) {
+                filas = 0;
+                return false;
+            }
+            p += largo;
+        }
+        return p == fin;
+    }
+
+    size_t filasBloque() const {
+        return filas;
+    }
+
+    // true si se llego al bloque de cierre: sin el, el archivo esta truncado
+    bool terminado() const {
+        return completo;
+    }
+
+    int64_t entero(size_t columna, size_t fila) const {
+        return enteros[columna][fila];
+    }
+
+    const string& texto(size_t columna, size_t fila) const {
+        return textos[columna][fila];
+    }
+};
+
+// ---------------------------- Historial de tickets ---------------------------
+// salida 0: sigue dentro
+struct FilaTicket {
+    int lote;
+    string_view ticketId;
+    string_view placa;
+    int lugar;
+    time_t entrada;
+    time_t salida;
+    int64_t cobroCentavos;
+};
+
+// Exporta <prefijo>.csv / .tkc con una fila por ticket y, al cerrar,
+// <prefijo>_diario.csv / _diario.tkc con un resumen por lote y dia de
+// entrada. Las filas pueden venir de varios lotes en cualquier orden; solo
+// se guarda un acumulado por (lote, dia).
+class ExportadorHistorial {
+public:
+    enum Formato { FORMATO_CSV = 1, FORMATO_COLUMNAR = 2, FORMATO_AMBOS = 3 };
+
+private:
+    struct Resumen {
+        int64_t tickets;
+        int64_t salidas;
+        int64_t cobroCentavos;
+        int64_t segundosEstancia;  // de los que ya salieron
+        int64_t estanciaMaxima;
+    };
+
+    int formatos;
+    bool comprimir;
+    string prefijo;
+    EscritorCsv csv;
+    EscritorColumnar columnar;
+    map<pair<int, int>, Resumen> resumenes;  // (lote, aaaammdd)
+    size_t filas;
+    bool abierto;
+    HoraLocal horaLocal;
+
+    static vector<ColumnaTabla> columnasHistorial() {
+        return {{"lote", COLUMNA_ENTERO},    {"ticket", COLUMNA_TEXTO}, {"placa", COLUMNA_TEXTO},
+                {"lugar", COLUMNA_ENTERO},   {"entrada", COLUMNA_FECHA}, {"salida", COLUMNA_FECHA},
+                {"cobro_centavos", COLUMNA_ENTERO}};
+    }
+
+    static vector<ColumnaTabla> columnasDiario() {
+        return {{"lote", COLUMNA_ENTERO},           {"dia", COLUMNA_TEXTO},
+                {"tickets", COLUMNA_ENTERO},        {"salidas", COLUMNA_ENTERO},
+                {"cobro_centavos", COLUMNA_ENTERO}, {"estancia_promedio_s", COLUMNA_ENTERO},
+                {"estancia_maxima_s", COLUMNA_ENTERO}};
+    }
+
+    // aaaammdd local
+    int diaLocal(time_t t) {
+        tm fecha;
+        if (!horaLocal.convertir(t, fecha)) return 0;
+        return (fecha.tm_year + 1900) * 10000 + (fecha.tm_mon + 1) * 100 + fecha.tm_mday;
+    }
+
+    bool escribirDiario() {
+        EscritorCsv diarioCsv;
+        EscritorColumnar diarioColumnar;
+        vector<ColumnaTabla> columnas = columnasDiario();
+        if ((formatos & FORMATO_CSV) && !diarioCsv.abrir(prefijo + "_diario.csv", columnas)) return false;
+        if ((formatos & FORMATO_COLUMNAR) && !diarioColumnar.abrir(prefijo + "_diario.tkc", columnas, comprimir)) {
+            return false;
+        }
+        for (const auto& par : resumenes) {
+            const Resumen& r = par.second;
+            char dia[16];
+            snprintf(dia, sizeof(dia), "%04d-%02d-%02d", par.first.second / 10000, par.first.second / 100 % 100,
+                     par.first.second % 100);
+            Celda celdas[7] = {{par.first.first, {}}, {0, dia}, {r.tickets, {}}, {r.salidas, {}},
+                               {r.cobroCentavos, {}}, {r.salidas ? r.segundosEstancia / r.salidas : 0, {}},
+                               {r.estanciaMaxima, {}}};
+            if (formatos & FORMATO_CSV) diarioCsv.fila(celdas);
+            if (formatos & FORMATO_COLUMNAR) diarioColumnar.fila(celdas);
+        }
+        bool ok = diarioCsv.cerrar();
+        return diarioColumnar.cerrar() && ok;
+    }
+
+public:
+    ExportadorHistorial() : formatos(0), comprimir(false), filas(0), abierto(false) {}
+
+    bool abrir(const string& prefijoArchivos, int formatosSalida = FORMATO_AMBOS, bool comprimirBloques = false) {
+        prefijo = prefijoArchivos;
+        formatos = formatosSalida;
+        comprimir = comprimirBloques;
+        resumenes.clear();
+        filas = 0;
+        vector<ColumnaTabla> columnas = columnasHistorial();
+        if ((formatos & FORMATO_CSV) && !csv.abrir(prefijo + ".csv", columnas)) return false;
+        if ((formatos & FORMATO_COLUMNAR) && !columnar.abrir(prefijo + ".tkc", columnas, comprimir)) return false;
+        abierto = true;
+        return true;
+    }
+
+    void agregar(const FilaTicket& t) {
+        Celda celdas[7] = {{t.lote, {}},    {0, t.ticketId}, {0, t.placa},           {t.lugar, {}},
+                           {t.entrada, {}}, {t.salida, {}},  {t.cobroCentavos, {}}};
+        if (formatos & FORMATO_CSV) csv.fila(celdas);
+        if (formatos & FORMATO_COLUMNAR) columnar.fila(celdas);
+        filas++;
+
+        Resumen& r = resumenes[make_pair(t.lote, diaLocal(t.entrada))];
+        r.tickets++;
+        if (t.salida != 0) {
+            int64_t estancia = t.salida > t.entrada ? (int64_t)(t.salida - t.entrada) : 0;
+            r.salidas++;
+            r.cobroCentavos += t.cobroCentavos;
+            r.segundosEstancia += estancia;
+            if (estancia > r.estanciaMaxima) r.estanciaMaxima = estancia;
+        }
+    }
+
+    size_t totalFilas() const {
+        return filas;
+    }
+
+    // Cierra el historial y escribe el resumen por dia; false si algo fallo
+    bool cerrar() {
+        if (!abierto) return false;
+        abierto = false;
+        bool ok = csv.cerrar();
+        ok = columnar.cerrar() && ok;
+        return escribirDiario() && ok;
+    }
+};
+
+#endif
@@ -0,0 +1,149 @@
+#ifndef FOLIO_TICKET_H
+#define FOLIO_TICKET_H
+
+#include <string>
+#include <cctype>
+#include <ctime>
+#include <cstdio>
+
+using namespace std;
+
+// ==================== FOLIO DEL TICKET ====================
+// "TCK-" + ddmmaaaa + verificador + secuencia (4 digitos o mas) + verificador:
+// TCK-25112025300059 es el ticket 5 del 25/11/2025. El primer verificador
+// (3) es de Damm sobre la fecha y el segundo (9) sobre la secuencia. Cada
+// uno detecta cualquier digito equivocado y cualquier par de digitos vecinos
+// invertido de su parte, que son los errores del cajero al teclear, y ambos
+// se revisan antes de buscar el ticket.
+//
+// En la salida basta teclear el final impreso, la secuencia con su
+// verificador ("00059" o "59"). Se valida solo, sin compararlo con ningun
+// ticket, y el motor lo resuelve con su indice de tickets activos por
+// secuencia (ver EstacionamientoLote::resolverTicket).
+
+const size_t DIGITOS_FECHA_FOLIO = 8;      // sin su verificador
+const size_t DIGITOS_SECUENCIA_FOLIO = 4;  // minimo; crece si el contador pasa de 9999
+const size_t MAX_DIGITOS_SECUENCIA = 9;    // cabe en un int
+const size_t INICIO_SECUENCIA_FOLIO = DIGITOS_FECHA_FOLIO + 1;  // entre los digitos del folio
+
+// Cuasigrupo de orden 10 sin diagonal (Damm, 2004)
+static const unsigned char TABLA_DAMM[10][10] = {
+    {0, 3, 1, 7, 5, 9, 8, 6, 4, 2}, {7, 0, 9, 2, 1, 5, 4, 8, 6, 3},
+    {4, 2, 0, 6, 8, 7, 1, 3, 5, 9}, {1, 7, 5, 0, 9, 8, 3, 4, 2, 6},
+    {6, 1, 2, 3, 0, 4, 5, 9, 7, 8}, {3, 6, 7, 4, 2, 0, 9, 5, 8, 1},
+    {5, 8, 6, 9, 7, 2, 0, 1, 3, 4}, {8, 9, 4, 5, 3, 6, 2, 0, 1, 7},
+    {9, 4, 3, 8, 6, 1, 7, 2, 0, 5}, {2, 5, 8, 1, 4, 3, 6, 7, 9, 0}};
+
+// Digito que se agrega a 'digitos' (solo '0'..'9'); con el verificador
+// incluido el resultado es 0. Los ceros a la izquierda no lo cambian, asi
+// que "59" y "00059" valen igual.
+inline int digitoVerificador(const char* digitos, size_t largo) {
+    int interino = 0;
+    for (size_t i = 0; i < largo; i++) interino = TABLA_DAMM[interino][digitos[i] - '0'];
+    return interino;
+}
+
+// Lo mas que ocupa un folio de escribirFolio(), mas su terminador
+const size_t MAX_LARGO_FOLIO = 4 + 48 + 1 + 16 + 1;
+
+// Escribe el folio en 'folio' (MAX_LARGO_FOLIO caracteres) y regresa su
+// largo, sin reservar memoria: el motor lo copia al ticketId del lugar, que
+// conserva la del folio anterior
+inline size_t escribirFolio(const tm& fecha, int secuencia, char* folio) {
+    char* dia = folio + 4;  // cabe cualquier int en cada campo
+    int largoDia = snprintf(dia, 48, "%02d%02d%04d", fecha.tm_mday, fecha.tm_mon + 1, fecha.tm_year + 1900);
+    dia[largoDia] = (char)('0' + digitoVerificador(dia, largoDia));
+    char* numero = dia + largoDia + 1;
+    int largoNumero = snprintf(numero, 16, "%0*d", (int)DIGITOS_SECUENCIA_FOLIO, secuencia);
+    numero[largoNumero] = (char)('0' + digitoVerificador(numero, largoNumero));
+    folio[0] = 'T';
+    folio[1] = 'C';
+    folio[2] = 'K';
+    folio[3] = '-';
+    return 4 + largoDia + 1 + largoNumero + 1;
+}
+
+inline string formatearFolio(const tm& fecha, int secuencia) {
+    char folio[MAX_LARGO_FOLIO];
+    return string(folio, escribirFolio(fecha, secuencia, folio));
+}
+
+// Secuencia de un folio bien formado (sin revisar los verificadores); -1 si
+// el texto no tiene la forma (folios de otro formato, p. ej. cargados a mano)
+inline int secuenciaFolio(const string& folio) {
+    if (folio.size() < 4 || folio.compare(0, 4, "TCK-") != 0) return -1;
+    size_t digitos = folio.size() - 4;
+    if (digitos < INICIO_SECUENCIA_FOLIO + DIGITOS_SECUENCIA_FOLIO + 1 ||
+        digitos > INICIO_SECUENCIA_FOLIO + MAX_DIGITOS_SECUENCIA + 1) {
+        return -1;
+    }
+    int secuencia = 0;
+    for (size_t i = 4; i < folio.size(); i++) {
+        if (!isdigit((unsigned char)folio[i])) return -1;
+        if (i >= 4 + INICIO_SECUENCIA_FOLIO && i + 1 < folio.size()) secuencia = secuencia * 10 + (folio[i] - '0');
+    }
+    return secuencia;
+}
+
+// Lo que tecleo el cajero, ya revisado. Sin reservas de memoria: los
+// digitos se quedan aqui y se comparan contra el folio del ticket.
+struct LecturaFolio {
+    enum Tipo {
+        COMPLETO,     // folio entero con los dos verificadores correctos: "TCK-" + 'digitos'
+        CORTO,        // solo el final, con su verificador correcto: 'secuencia'
+        MAL_ESCRITO   // verificador que no cuadra o texto sin forma de folio
+    };
+    Tipo tipo;
+    int secuencia;
+    char digitos[INICIO_SECUENCIA_FOLIO + MAX_DIGITOS_SECUENCIA + 1];
+    size_t largo;
+
+    // El folio completo es 'ticketId'
+    bool es(const string& ticketId) const {
+        return tipo == COMPLETO && ticketId.size() == 4 + largo && ticketId.compare(0, 4, "TCK-") == 0 &&
+               ticketId.compare(4, largo, digitos, largo) == 0;
+    }
+};
+
+// Acepta "TCK-25112025300059", "tck-25112025300059", "25112025300059" y el
+// final "00059" / "59"; los espacios y guiones entre digitos no cuentan.
+// No busca nada: cualquier verificador mal se rechaza aqui.
+inline LecturaFolio leerFolio(const string& texto) {
+    LecturaFolio lectura;
+    lectura.tipo = LecturaFolio::MAL_ESCRITO;
+    lectura.secuencia = -1;
+    lectura.largo = 0;
+    size_t inicio = 0;
+    bool prefijo = texto.size() >= 4 && toupper((unsigned char)texto[0]) == 'T' &&
+                   toupper((unsigned char)texto[1]) == 'C' && toupper((unsigned char)texto[2]) == 'K' &&
+                   texto[3] == '-';
+    if (prefijo) inicio = 4;
+
+    char* digitos = lectura.digitos;
+    size_t& largo = lectura.largo;
+    for (size_t i = inicio; i < texto.size(); i++) {
+        char c = texto[i];
+        if (c == ' ' || c == '-' || c == '\t' || c == '\r' || c == '\n') continue;
+        if (!isdigit((unsigned char)c) || largo == sizeof(lectura.digitos)) return lectura;
+        digitos[largo++] = c;
+    }
+    if (largo < 2) return lectura;
+
+    // Con "TCK-" se esperaba el folio entero; sin la fecha, es el final
+    size_t inicioSecuencia = 0;
+    if (largo >= INICIO_SECUENCIA_FOLIO + DIGITOS_SECUENCIA_FOLIO + 1) {
+        if (digitoVerificador(digitos, INICIO_SECUENCIA_FOLIO) != 0) return lectura;
+        inicioSecuencia = INICIO_SECUENCIA_FOLIO;
+    } else if (prefijo || largo - 1 > MAX_DIGITOS_SECUENCIA) {
+        return lectura;
+    }
+    if (digitoVerificador(digitos + inicioSecuencia, largo - inicioSecuencia) != 0) return lectura;
+    lectura.tipo = inicioSecuencia > 0 ? LecturaFolio::COMPLETO : LecturaFolio::CORTO;
+    lectura.secuencia = 0;
+    for (size_t i = inicioSecuencia; i + 1 < largo; i++) {
+        lectura.secuencia = lectura.secuencia * 10 + (digitos[i] - '0');
+    }
+    return lectura;
+}
+
+#endif
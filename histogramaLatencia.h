@@ -0,0 +1,121 @@
+#ifndef HISTOGRAMA_LATENCIA_H
+#define HISTOGRAMA_LATENCIA_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <sstream>
+
+using namespace std;
+
+// Reloj de alta resolucion para marcar las etapas de una operacion
+inline uint64_t microsegundosAhora() {
+    return (uint64_t)chrono::duration_cast<chrono::microseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ==================== HISTOGRAMA DE LATENCIAS ====================
+// Cubetas logaritmico-lineales al estilo HDR: los valores menores a 32 us son
+// exactos y de ahi en adelante cada potencia de 2 se parte en 16 cubetas
+// (error maximo ~6%). Registrar es un incremento atomico sin candados, asi
+// que se puede leer en vivo desde otro hilo mientras se sigue registrando.
+class HistogramaLatencia {
+private:
+    static const int EXACTOS = 32;
+    static const int SUBCUBETAS = 16;
+    static const int BITS_MAXIMOS = 40;  // ~12 dias en microsegundos
+    static const int CUBETAS = EXACTOS + (BITS_MAXIMOS - 5) * SUBCUBETAS;
+
+    atomic<uint64_t> cuentas[CUBETAS];
+    atomic<uint64_t> total;
+    atomic<uint64_t> suma;
+    atomic<uint64_t> maximo;
+
+    static int bitAlto(uint64_t valor) {
+        int bit = 0;
+        while (valor >>= 1) bit++;
+        return bit;
+    }
+
+    static int indice(uint64_t valor) {
+        if (valor < (uint64_t)EXACTOS) return (int)valor;
+        int bit = bitAlto(valor);
+        if (bit >= BITS_MAXIMOS) return CUBETAS - 1;
+        int corrimiento = bit - 4;
+        int sub = (int)(valor >> corrimiento) - SUBCUBETAS;
+        return EXACTOS + (bit - 5) * SUBCUBETAS + sub;
+    }
+
+    // Valor representativo (punto medio) de una cubeta
+    static uint64_t valorCubeta(int i) {
+        if (i < EXACTOS) return (uint64_t)i;
+        int bit = (i - EXACTOS) / SUBCUBETAS + 5;
+        int sub = (i - EXACTOS) % SUBCUBETAS + SUBCUBETAS;
+        int corrimiento = bit - 4;
+        return ((uint64_t)sub << corrimiento) + ((uint64_t)1 << corrimiento) / 2;
+    }
+
+public:
+    HistogramaLatencia() {
+        reiniciar();
+    }
+
+    void registrar(uint64_t microsegundos) {
+        cuentas[indice(microsegundos)].fetch_add(1, memory_order_relaxed);
+        total.fetch_add(1, memory_order_relaxed);
+        suma.fetch_add(microsegundos, memory_order_relaxed);
+        uint64_t anterior = maximo.load(memory_order_relaxed);
+        while (microsegundos > anterior &&
+               !maximo.compare_exchange_weak(anterior, microsegundos, memory_order_relaxed)) {
+        }
+    }
+
+    void reiniciar() {
+        for (int i = 0; i < CUBETAS; i++) cuentas[i].store(0, memory_order_relaxed);
+        total.store(0, memory_order_relaxed);
+        suma.store(0, memory_order_relaxed);
+        maximo.store(0, memory_order_relaxed);
+    }
+
+    uint64_t cantidad() const {
+        return total.load(memory_order_relaxed);
+    }
+
+    uint64_t valorMaximo() const {
+        return maximo.load(memory_order_relaxed);
+    }
+
+    uint64_t promedio() const {
+        uint64_t n = cantidad();
+        return n ? suma.load(memory_order_relaxed) / n : 0;
+    }
+
+    // Percentil (0..100) en microsegundos; 0 si no hay muestras
+    uint64_t percentil(double p) const {
+        uint64_t n = cantidad();
+        if (n == 0) return 0;
+        uint64_t objetivo = (uint64_t)(p / 100.0 * n + 0.5);
+        if (objetivo == 0) objetivo = 1;
+        uint64_t acumulado = 0;
+        for (int i = 0; i < CUBETAS; i++) {
+            acumulado += cuentas[i].load(memory_order_relaxed);
+            if (acumulado >= objetivo) {
+                uint64_t valor = valorCubeta(i);
+                uint64_t tope = valorMaximo();
+                return valor < tope ? valor : tope;
+            }
+        }
+        return valorMaximo();
+    }
+
+    // "<n> <p50> <p90> <p99> <max>" en microsegundos
+    string resumen() const {
+        ostringstream oss;
+        oss << cantidad() << " " << percentil(50) << " " << percentil(90) << " "
+            << percentil(99) << " " << valorMaximo();
+        return oss.str();
+    }
+};
+
+#endif
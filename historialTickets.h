@@ -0,0 +1,213 @@
+#ifndef HISTORIAL_TICKETS_H
+#define HISTORIAL_TICKETS_H
+
+#include <cmath>
+#include <ctime>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+
+#include "indicePlacas.h"
+#include "indiceTiempo.h"
+#include "exportacionHistorial.h"
+
+using namespace std;
+
+// ==================== HISTORIAL DE TICKETS ====================
+// Todos los tickets desde que arranco el programa, activos e historicos,
+// para lo que Estacionamiento ya no guarda: placa, hora de salida y cobro
+// de los que salieron. Lo comparten la consola y el servidor.
+//
+// Los registros solo se agregan; los indices guardan su posicion: por
+// folio, por placa (ver indicePlacas.h), por hora de entrada de todos y de
+// los que siguen dentro (ver indiceTiempo.h) y la lista de cada lugar.
+class HistorialTickets {
+public:
+    struct Registro {
+        string ticketId;
+        string placa;
+        int lugar;           // 1..capacidad
+        time_t horaEntrada;
+        time_t horaSalida;   // 0: sigue dentro
+        int64_t cobroCentavos;
+
+        bool activo() const {
+            return horaSalida == 0;
+        }
+    };
+
+    // Para listar por paginas; lo que no se pide queda en 0
+    struct Filtro {
+        int estado = 0;    // 0 todos, 1 activos, 2 no activos
+        int lugar = 0;     // 0 todos
+        time_t desde = 0;  // hora de entrada [desde, hasta); hasta 0: cualquiera
+        time_t hasta = 0;
+    };
+
+    // Donde sigue la proxima pagina: 'clave' en los indices por hora,
+    // 'posicion' en el historial o en la lista de un lugar
+    struct Cursor {
+        IndiceTiempo::Clave clave = IndiceTiempo::inicio();
+        size_t posicion = 0;
+    };
+
+private:
+    vector<Registro> registros;
+    unordered_map<string, uint32_t> registroDeTicket;
+    IndicePlacas indicePlacas;
+    IndiceTiempo indiceEntradas;  // todos, por hora de entrada
+    IndiceTiempo indiceActivos;   // los que siguen dentro
+    vector<vector<uint32_t>> porLugar;
+
+    static bool cumple(const Registro& r, const Filtro& filtro) {
+        if (filtro.estado == 1 && !r.activo()) return false;
+        if (filtro.estado == 2 && r.activo()) return false;
+        if (filtro.lugar != 0 && r.lugar != filtro.lugar) return false;
+        if (filtro.hasta != 0 && (r.horaEntrada < filtro.desde || r.horaEntrada >= filtro.hasta)) return false;
+        return true;
+    }
+
+public:
+    // Posicion del registro nuevo
+    uint32_t registrarEntrada(const string& ticketId, int lugar, time_t horaEntrada) {
+        uint32_t registro = (uint32_t)registros.size();
+        registros.push_back({ticketId, "", lugar, horaEntrada, 0, 0});
+        registroDeTicket[ticketId] = registro;
+        indiceEntradas.agregar(horaEntrada, registro);
+        indiceActivos.agregar(horaEntrada, registro);
+        if (lugar >= 1) {
+            if ((size_t)lugar > porLugar.size()) porLugar.resize(lugar);
+            porLugar[lugar - 1].push_back(registro);
+        }
+        return registro;
+    }
+
+    // false si el ticket no esta o ya habia salido
+    bool registrarSalida(const string& ticketId, time_t horaSalida, float cobro) {
+        auto it = registroDeTicket.find(ticketId);
+        if (it == registroDeTicket.end() || !registros[it->second].activo()) return false;
+        Registro& r = registros[it->second];
+        r.horaSalida = horaSalida;
+        r.cobroCentavos = llround(cobro * 100.0);
+        indiceActivos.quitar(r.horaEntrada, it->second);
+        return true;
+    }
+
+    // Se guarda normalizada; false si el ticket no esta o la placa queda vacia
+    bool registrarPlaca(const string& ticketId, const string& placa) {
+        auto it = registroDeTicket.find(ticketId);
+        string normalizada = IndicePlacas::normalizar(placa);
+        if (it == registroDeTicket.end() || normalizada.empty()) return false;
+        registros[it->second].placa = normalizada;
+        indicePlacas.agregar(normalizada, it->second);
+        return true;
+    }
+
+    // Solo el folio completo, como quedo registrado
+    bool buscar(const string& ticketId, uint32_t& registro) const {
+        auto it = registroDeTicket.find(ticketId);
+        if (it == registroDeTicket.end()) return false;
+        registro = it->second;
+        return true;
+    }
+
+    const Registro& operator[](uint32_t registro) const {
+        return registros[registro];
+    }
+
+    size_t total() const {
+        return registros.size();
+    }
+
+    // Ticket perdido: placa exacta; si no hay, por prefijo; si no, con un
+    // caracter equivocado. Regresa el criterio que encontro algo (o el
+    // ultimo que se intento).
+    const char* buscarPlaca(const string& texto, vector<uint32_t>& resultado, size_t limite) const {
+        indicePlacas.buscarExacta(texto, resultado, limite);
+        if (!resultado.empty()) return "exacta";
+        indicePlacas.buscarPrefijo(texto, resultado, limite);
+        if (!resultado.empty()) return "por prefijo";
+        indicePlacas.buscarAproximada(texto, resultado, limite);
+        return "aproximada";
+    }
+
+    // Entraron en [desde, hasta), en orden de hora; false si quedaron mas
+    bool buscarEntradas(time_t desde, time_t hasta, vector<uint32_t>& resultado, size_t limite) const {
+        return indiceEntradas.buscarRango(desde, hasta, resultado, limite);
+    }
+
+    // Siguen dentro y entraron antes de 'hasta', el mas antiguo primero
+    bool buscarEstanciasLargas(time_t hasta, vector<uint32_t>& resultado, size_t limite) const {
+        return indiceActivos.buscarAnteriores(hasta, resultado, limite);
+    }
+
+    // Agrega a 'pagina' hasta 'filas' registros a partir de 'cursor' y lo
+    // deja listo para la siguiente; regresa false si ya no hay mas. Cada
+    // pagina sale de un indice (por lugar, activos o por hora de entrada),
+    // asi que cuesta lo mismo con 100 tickets que con 100 mil; lo que el
+    // indice elegido no filtra (p. ej. "no activos") solo salta a los pocos
+    // activos.
+    bool pagina(const Filtro& filtro, Cursor& cursor, vector<uint32_t>& pagina, size_t filas) const {
+        if (filtro.lugar != 0) {
+            if ((size_t)filtro.lugar > porLugar.size()) return false;
+            // Un lugar se desocupa antes de recibir otro auto: su lista va
+            // en orden de hora y el activo, si lo hay, es el ultimo
+            const vector<uint32_t>& lista = porLugar[filtro.lugar - 1];
+            size_t i = cursor.posicion;
+            if (filtro.estado == 1 && i + 1 < lista.size()) i = lista.size() - 1;
+            if (filtro.hasta != 0 && i == 0) {
+                i = lower_bound(lista.begin(), lista.end(), filtro.desde,
+                                [this](uint32_t r, time_t t) { return registros[r].horaEntrada < t; }) -
+                    lista.begin();
+            }
+            for (; i < lista.size() && pagina.size() < filas; i++) {
+                const Registro& r = registros[lista[i]];
+                if (filtro.hasta != 0 && r.horaEntrada >= filtro.hasta) break;
+                if (cumple(r, filtro)) pagina.push_back(lista[i]);
+            }
+            cursor.posicion = i;
+            return i < lista.size() && (filtro.hasta == 0 || registros[lista[i]].horaEntrada < filtro.hasta);
+        }
+
+        if (filtro.estado == 1 || filtro.hasta != 0) {
+            const IndiceTiempo& indice = filtro.estado == 1 ? indiceActivos : indiceEntradas;
+            time_t desde = filtro.hasta != 0 ? filtro.desde : indice.primeraHora();
+            time_t hasta = filtro.hasta != 0 ? filtro.hasta : numeric_limits<time_t>::max();
+            while (pagina.size() < filas) {
+                size_t previos = pagina.size();
+                bool mas = indice.buscarPagina(desde, hasta, cursor.clave, pagina, filas - pagina.size());
+                // Lo que el indice no filtra se vuelve a quitar de la pagina
+                pagina.erase(remove_if(pagina.begin() + previos, pagina.end(),
+                                       [&](uint32_t i) { return !cumple(registros[i], filtro); }),
+                             pagina.end());
+                if (!mas) return false;
+            }
+            return true;
+        }
+
+        size_t i = cursor.posicion;
+        for (; i < registros.size() && pagina.size() < filas; i++) {
+            if (cumple(registros[i], filtro)) pagina.push_back((uint32_t)i);
+        }
+        cursor.posicion = i;
+        return i < registros.size();
+    }
+
+    // Todo el historial a <prefijo>.csv/.tkc y el resumen por dia a
+    // <prefijo>_diario.csv/.tkc (ver exportacionHistorial.h); se escribe
+    // por bloques, sin copiarlo. Regresa las filas escritas, -1 si fallo.
+    long long exportar(const string& prefijo, int lote, bool comprimir) const {
+        ExportadorHistorial exportador;
+        if (!exportador.abrir(prefijo, ExportadorHistorial::FORMATO_AMBOS, comprimir)) return -1;
+        for (const Registro& r : registros) {
+            exportador.agregar({lote, r.ticketId, r.placa, r.lugar, r.horaEntrada, r.horaSalida, r.cobroCentavos});
+        }
+        if (!exportador.cerrar()) return -1;
+        return (long long)exportador.totalFilas();
+    }
+};
+
+#endif
@@ -0,0 +1,200 @@
+#ifndef INDICE_PLACAS_H
+#define INDICE_PLACAS_H
+
+#include <cctype>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+// ==================== INDICE DE PLACAS ====================
+// Trie de placas normalizadas (mayusculas, solo letras y digitos) que
+// apunta a registros del llamador (p. ej. la posicion en RegistroTickets),
+// activos e historicos. Busquedas exacta, por prefijo y a distancia de
+// edicion 1 (un caracter cambiado, de mas o de menos: lo tipico al leer
+// mal una placa). El costo depende del largo de la placa y de cuantos
+// resultados se piden, no del total de registros.
+//
+// Los hijos de cada nodo estan juntos en 'aristas' (un bloque que se
+// duplica y se muda al final cuando se llena), asi que recorrerlos no salta
+// por la memoria: la busqueda aproximada visita todos los hijos de cada
+// nodo del camino. Un millon de placas ocupa ~100 MB.
+class IndicePlacas {
+private:
+    static const uint32_t NINGUNO = 0xFFFFFFFF;
+    static const uint8_t MAX_HIJOS = 36;  // A-Z y 0-9
+
+    struct Nodo {
+        uint32_t hijos;           // inicio del bloque en 'aristas'
+        uint32_t primeraEntrada;  // registros de las placas que terminan aqui
+        uint8_t totalHijos;
+        uint8_t capacidadHijos;
+    };
+
+    struct Arista {
+        uint32_t nodo;
+        char simbolo;
+    };
+
+    struct Entrada {
+        uint32_t registro;
+        uint32_t siguiente;
+    };
+
+    vector<Nodo> nodos;  // nodos[0] es la raiz
+    vector<Arista> aristas;
+    vector<Entrada> entradas;
+
+    uint32_t hijo(uint32_t nodo, char simbolo) const {
+        const Nodo& n = nodos[nodo];
+        for (uint32_t i = n.hijos; i < n.hijos + n.totalHijos; i++) {
+            if (aristas[i].simbolo == simbolo) return aristas[i].nodo;
+        }
+        return NINGUNO;
+    }
+
+    uint32_t agregarHijo(uint32_t nodo, char simbolo) {
+        uint32_t nuevo = (uint32_t)nodos.size();
+        nodos.push_back({0, NINGUNO, 0, 0});
+        Nodo& n = nodos[nodo];
+        if (n.totalHijos == n.capacidadHijos) {
+            uint8_t capacidad = n.capacidadHijos == 0 ? 1 : n.capacidadHijos * 2;
+            if (capacidad > MAX_HIJOS) capacidad = MAX_HIJOS;
+            uint32_t bloque = (uint32_t)aristas.size();
+            aristas.resize(aristas.size() + capacidad);
+            for (uint8_t i = 0; i < n.totalHijos; i++) aristas[bloque + i] = aristas[n.hijos + i];
+            n.hijos = bloque;
+            n.capacidadHijos = capacidad;
+        }
+        aristas[n.hijos + n.totalHijos] = {nuevo, simbolo};
+        n.totalHijos++;
+        return nuevo;
+    }
+
+    uint32_t nodoDe(const string& normalizada) const {
+        uint32_t nodo = 0;
+        for (size_t i = 0; i < normalizada.size() && nodo != NINGUNO; i++) {
+            nodo = hijo(nodo, normalizada[i]);
+        }
+        return nodo;
+    }
+
+    bool agregarRegistros(uint32_t nodo, vector<uint32_t>& resultado, size_t limite) const {
+        for (uint32_t e = nodos[nodo].primeraEntrada; e != NINGUNO; e = entradas[e].siguiente) {
+            if (resultado.size() >= limite) return false;
+            resultado.push_back(entradas[e].registro);
+        }
+        return resultado.size() < limite;
+    }
+
+    // Recorre el trie consumiendo 'placa' desde 'pos' con 'errores' ediciones
+    // disponibles. Puede llegar al mismo registro por dos caminos (p. ej.
+    // "AB1" contra "AB11"); el llamador quita repetidos.
+    void buscarConErrores(uint32_t nodo, const string& placa, size_t pos, int errores,
+                          vector<uint32_t>& resultado, size_t limite) const {
+        if (resultado.size() >= limite) return;
+        if (pos == placa.size()) {
+            agregarRegistros(nodo, resultado, limite);
+        }
+        if (errores > 0 && pos < placa.size()) {
+            // Falta un caracter en la placa registrada
+            buscarConErrores(nodo, placa, pos + 1, errores - 1, resultado, limite);
+        }
+        const Nodo& n = nodos[nodo];
+        for (uint32_t i = n.hijos; i < n.hijos + n.totalHijos; i++) {
+            uint32_t h = aristas[i].nodo;
+            if (pos < placa.size() && aristas[i].simbolo == placa[pos]) {
+                buscarConErrores(h, placa, pos + 1, errores, resultado, limite);
+            } else if (errores > 0) {
+                if (pos < placa.size()) {
+                    // Caracter cambiado
+                    buscarConErrores(h, placa, pos + 1, errores - 1, resultado, limite);
+                }
+                // Caracter de mas en la placa registrada
+                buscarConErrores(h, placa, pos, errores - 1, resultado, limite);
+            }
+        }
+    }
+
+public:
+    IndicePlacas() {
+        nodos.push_back({0, NINGUNO, 0, 0});
+    }
+
+    // "abc-123 " -> "ABC123"
+    static string normalizar(const string& placa) {
+        string normalizada;
+        for (char c : placa) {
+            if (isalnum((unsigned char)c)) normalizada += (char)toupper((unsigned char)c);
+        }
+        return normalizada;
+    }
+
+    void reservar(size_t placas) {
+        nodos.reserve(placas * 4);
+        aristas.reserve(placas * 5);
+        entradas.reserve(placas);
+    }
+
+    // Una placa puede tener varios registros (visitas distintas)
+    void agregar(const string& placa, uint32_t registro) {
+        string normalizada = normalizar(placa);
+        if (normalizada.empty()) return;
+        uint32_t nodo = 0;
+        for (char simbolo : normalizada) {
+            uint32_t siguiente = hijo(nodo, simbolo);
+            if (siguiente == NINGUNO) siguiente = agregarHijo(nodo, simbolo);
+            nodo = siguiente;
+        }
+        entradas.push_back({registro, nodos[nodo].primeraEntrada});
+        nodos[nodo].primeraEntrada = (uint32_t)entradas.size() - 1;
+    }
+
+    // Los resultados se agregan a 'resultado', a lo mas 'limite' en total
+    void buscarExacta(const string& placa, vector<uint32_t>& resultado, size_t limite = 50) const {
+        string normalizada = normalizar(placa);
+        if (normalizada.empty()) return;
+        uint32_t nodo = nodoDe(normalizada);
+        if (nodo != NINGUNO) agregarRegistros(nodo, resultado, limite);
+    }
+
+    void buscarPrefijo(const string& prefijo, vector<uint32_t>& resultado, size_t limite = 50) const {
+        string normalizada = normalizar(prefijo);
+        if (normalizada.empty()) return;
+        uint32_t inicio = nodoDe(normalizada);
+        if (inicio == NINGUNO) return;
+        vector<uint32_t> pendientes(1, inicio);
+        while (!pendientes.empty()) {
+            uint32_t nodo = pendientes.back();
+            pendientes.pop_back();
+            if (!agregarRegistros(nodo, resultado, limite)) return;
+            const Nodo& n = nodos[nodo];
+            for (uint32_t i = n.hijos; i < n.hijos + n.totalHijos; i++) {
+                pendientes.push_back(aristas[i].nodo);
+            }
+        }
+    }
+
+    // Distancia de edicion <= 1, incluida la placa exacta
+    void buscarAproximada(const string& placa, vector<uint32_t>& resultado, size_t limite = 50) const {
+        string normalizada = normalizar(placa);
+        if (normalizada.empty()) return;
+        size_t inicio = resultado.size();
+        buscarConErrores(0, normalizada, 0, 1, resultado, NINGUNO);
+        sort(resultado.begin() + inicio, resultado.end());
+        resultado.erase(unique(resultado.begin() + inicio, resultado.end()), resultado.end());
+        if (resultado.size() > limite) resultado.resize(limite);
+    }
+
+    size_t totalRegistros() const {
+        return entradas.size();
+    }
+
+    size_t totalNodos() const {
+        return nodos.size();
+    }
+};
+
+#endif
@@ -0,0 +1,159 @@
+#ifndef INDICE_TIEMPO_H
+#define INDICE_TIEMPO_H
+
+#include <ctime>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+// ==================== INDICE POR HORA ====================
+// Indice ordenado de (instante, registro) para preguntar "que tickets
+// entraron entre las 08:00 y las 09:00 del 21" o "que autos llevan mas de
+// N horas" sin recorrer todo el historial: O(log n + k).
+//
+// Las claves van ordenadas por (instante, registro) en bloques de a lo mas
+// MAX_BLOQUE, y los bloques en orden: se busca el bloque por su ultima
+// clave y dentro de el, ambos en O(log n). Casi todo llega en orden de hora
+// y se agrega al final del ultimo bloque; lo que llega fuera de orden
+// (cargas previas, relojes corregidos) entra en su bloque, que se parte si
+// se llena. Quitar borra la clave de su bloque, sin dejar marcas, asi que
+// sirve tambien para el conjunto de activos aunque salgan primero los mas
+// viejos: una busqueda solo recorre claves vivas. Las busquedas se pueden
+// partir en paginas con un cursor (la ultima clave entregada).
+class IndiceTiempo {
+public:
+    static const size_t MAX_BLOQUE = 512;
+
+    struct Clave {
+        int64_t t;
+        uint32_t registro;
+    };
+
+    // Antes de la primera pagina
+    static Clave inicio() {
+        return {INT64_MIN, 0};
+    }
+
+private:
+    vector<vector<Clave>> bloques;  // ninguno vacio
+    size_t claves;
+
+    static bool antes(const Clave& a, const Clave& b) {
+        return a.t < b.t || (a.t == b.t && a.registro < b.registro);
+    }
+
+    // Primer bloque cuya ultima clave no va antes de 'clave'
+    size_t bloqueDe(const Clave& clave) const {
+        return lower_bound(bloques.begin(), bloques.end(), clave,
+                           [](const vector<Clave>& bloque, const Clave& c) { return antes(bloque.back(), c); }) -
+               bloques.begin();
+    }
+
+    // Un bloque que quedo chico se junta con el siguiente si caben juntos,
+    // para que no se acumulen bloques de pocas claves
+    void juntar(size_t i) {
+        if (i + 1 >= bloques.size() || bloques[i].size() + bloques[i + 1].size() > MAX_BLOQUE) return;
+        bloques[i].insert(bloques[i].end(), bloques[i + 1].begin(), bloques[i + 1].end());
+        bloques.erase(bloques.begin() + i + 1);
+    }
+
+public:
+    IndiceTiempo() : claves(0) {}
+
+    void reservar(size_t total) {
+        bloques.reserve(total / MAX_BLOQUE + 1);
+    }
+
+    void agregar(time_t t, uint32_t registro) {
+        Clave clave = {(int64_t)t, registro};
+        claves++;
+        if (bloques.empty() || !antes(clave, bloques.back().back())) {
+            // En orden: al final; un bloque lleno no se parte, se abre otro
+            if (bloques.empty() || bloques.back().size() == MAX_BLOQUE) {
+                bloques.emplace_back();
+                bloques.back().reserve(MAX_BLOQUE);
+            }
+            bloques.back().push_back(clave);
+            return;
+        }
+        size_t i = bloqueDe(clave);
+        vector<Clave>& bloque = bloques[i];
+        bloque.insert(upper_bound(bloque.begin(), bloque.end(), clave, antes), clave);
+        if (bloque.size() > MAX_BLOQUE) {
+            vector<Clave> mitad(bloque.begin() + bloque.size() / 2, bloque.end());
+            bloque.resize(bloque.size() / 2);
+            bloques.insert(bloques.begin() + i + 1, std::move(mitad));
+        }
+    }
+
+    // false si no estaba
+    bool quitar(time_t t, uint32_t registro) {
+        Clave clave = {(int64_t)t, registro};
+        size_t i = bloqueDe(clave);
+        if (i == bloques.size()) return false;
+        vector<Clave>& bloque = bloques[i];
+        auto it = lower_bound(bloque.begin(), bloque.end(), clave, antes);
+        if (it == bloque.end() || it->t != clave.t || it->registro != registro) return false;
+        bloque.erase(it);
+        claves--;
+        if (bloque.empty()) {
+            bloques.erase(bloques.begin() + i);
+        } else if (bloque.size() < MAX_BLOQUE / 4) {
+            juntar(i);
+            if (i > 0) juntar(i - 1);
+        }
+        return true;
+    }
+
+    // Una pagina de registros con desde <= t < hasta que van despues de
+    // 'cursor', en orden de hora, a lo mas 'limite' (se agregan a
+    // 'resultado'). 'cursor' queda en el ultimo entregado para pedir la
+    // siguiente; regresa false si ya no queda ninguno despues.
+    bool buscarPagina(time_t desde, time_t hasta, Clave& cursor, vector<uint32_t>& resultado,
+                      size_t limite) const {
+        Clave primera = {(int64_t)desde, 0};
+        Clave siguiente = {cursor.t, cursor.registro + 1};
+        if (antes(primera, siguiente)) primera = siguiente;
+        size_t i = bloqueDe(primera);
+        if (i == bloques.size()) return false;
+        size_t j = lower_bound(bloques[i].begin(), bloques[i].end(), primera, antes) - bloques[i].begin();
+        size_t entregados = 0;
+        for (; i < bloques.size(); i++, j = 0) {
+            for (; j < bloques[i].size(); j++) {
+                const Clave& c = bloques[i][j];
+                if (c.t >= (int64_t)hasta) return false;
+                if (entregados == limite) return true;
+                resultado.push_back(c.registro);
+                cursor = c;
+                entregados++;
+            }
+        }
+        return false;
+    }
+
+    // Registros con desde <= t < hasta, en orden de hora, a lo mas 'limite'
+    // (se agregan a 'resultado'). Regresa false si quedaron mas sin entregar.
+    bool buscarRango(time_t desde, time_t hasta, vector<uint32_t>& resultado, size_t limite = 100) const {
+        Clave cursor = inicio();
+        return !buscarPagina(desde, hasta, cursor, resultado, limite);
+    }
+
+    // Registros con t < hasta: "entraron antes de", p. ej. ahora - N horas
+    bool buscarAnteriores(time_t hasta, vector<uint32_t>& resultado, size_t limite = 100) const {
+        Clave cursor = inicio();
+        return !buscarPagina(primeraHora(), hasta, cursor, resultado, limite);
+    }
+
+    // Instante de la clave mas antigua; INT64_MAX si no hay
+    time_t primeraHora() const {
+        return bloques.empty() ? (time_t)INT64_MAX : (time_t)bloques.front().front().t;
+    }
+
+    size_t total() const {
+        return claves;
+    }
+};
+
+#endif
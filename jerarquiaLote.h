@@ -0,0 +1,188 @@
+#ifndef JERARQUIA_LOTE_H
+#define JERARQUIA_LOTE_H
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <cstdlib>
+
+#include "megaEstacionamiento01/distribucionLote.h"
+
+using namespace std;
+
+// ==================== JERARQUIA DEL LOTE ====================
+// Sitio -> niveles -> zonas -> cajones, con los lugares disponibles (libres
+// y sin apartar) de cada nodo para los letreros. Cada cambio de un cajon
+// sube por sus ancestros: O(profundidad), sin recorrer los lugares. Los
+// nodos que cambiaron se juntan en una lista hasta que el llamador la toma
+// (una vez por ciclo), asi que muchos cambios seguidos en un nivel son un
+// solo aviso al letrero.
+//
+// Los cajones se numeran seguidos, zona por zona, como en
+// distribucionLote.h; la etiqueta es "<zona>-<n>" (n dentro de la zona) y
+// con mas de un nivel "<nivel>-<zona>-<n>".
+class JerarquiaLote {
+public:
+    enum TipoNodo { NODO_SITIO, NODO_NIVEL, NODO_ZONA };
+
+    struct Nodo {
+        string nombre;
+        int tipo;
+        int padre;        // -1: el sitio
+        int primerCajon;  // zonas: indice del primero
+        int capacidad;
+        int disponibles;
+        bool cambiado;    // esta en la lista de cambios
+    };
+
+private:
+    vector<Nodo> nodos;        // 0: el sitio
+    vector<int> zonaDeCajon;   // nodo de la zona de cada cajon
+    vector<char> disponible;   // por cajon
+    vector<int> cambios;
+    int niveles;
+
+    void anotar(int nodo) {
+        if (!nodos[nodo].cambiado) {
+            nodos[nodo].cambiado = true;
+            cambios.push_back(nodo);
+        }
+    }
+
+public:
+    explicit JerarquiaLote(const string& sitio = "sitio") : niveles(0) {
+        nodos.push_back({sitio, NODO_SITIO, -1, 0, 0, 0, false});
+    }
+
+    // Un nivel con las zonas de distribucionLote.h; los cajones que sobren
+    // de 'capacidad' van a la ultima zona (lotes de prueba mas grandes)
+    static JerarquiaLote delLote(int capacidad) {
+        JerarquiaLote jerarquia;
+        int nivel = jerarquia.agregarNivel("N1");
+        int asignados = 0;
+        for (int z = 0; z < ZONAS_LOTE; z++) {
+            int cajones = z + 1 < ZONAS_LOTE ? ZONAS[z].cajones : capacidad - asignados;
+            if (cajones > capacidad - asignados) cajones = capacidad - asignados;
+            if (cajones < 0) cajones = 0;
+            jerarquia.agregarZona(nivel, ZONAS[z].nombre, cajones);
+            asignados += cajones;
+        }
+        return jerarquia;
+    }
+
+    // "P1:A=40,B=40;P2:C=80" (niveles separados por ';', zonas por ',');
+    // false si el texto no se entiende
+    static bool desdeTexto(const string& texto, JerarquiaLote& resultado) {
+        JerarquiaLote jerarquia;
+        istringstream lista(texto);
+        string nivelTexto;
+        while (getline(lista, nivelTexto, ';')) {
+            size_t dosPuntos = nivelTexto.find(':');
+            if (dosPuntos == string::npos || dosPuntos == 0) return false;
+            int nivel = jerarquia.agregarNivel(nivelTexto.substr(0, dosPuntos));
+            istringstream zonas(nivelTexto.substr(dosPuntos + 1));
+            string zonaTexto;
+            bool alguna = false;
+            while (getline(zonas, zonaTexto, ',')) {
+                size_t igual = zonaTexto.find('=');
+                if (igual == string::npos || igual == 0) return false;
+                char* fin = nullptr;
+                long cajones = strtol(zonaTexto.c_str() + igual + 1, &fin, 10);
+                if (*fin != '\0' || cajones <= 0) return false;
+                jerarquia.agregarZona(nivel, zonaTexto.substr(0, igual), (int)cajones);
+                alguna = true;
+            }
+            if (!alguna) return false;
+        }
+        if (jerarquia.niveles == 0) return false;
+        resultado = jerarquia;
+        return true;
+    }
+
+    int agregarNivel(const string& nombre) {
+        nodos.push_back({nombre, NODO_NIVEL, 0, 0, 0, 0, false});
+        niveles++;
+        return (int)nodos.size() - 1;
+    }
+
+    // Los cajones nuevos empiezan no disponibles; el motor avisa los libres
+    int agregarZona(int nivel, const string& nombre, int cajones) {
+        int zona = (int)nodos.size();
+        nodos.push_back({nombre, NODO_ZONA, nivel, (int)zonaDeCajon.size(), cajones, 0, false});
+        for (int n = zona; n != -1; n = nodos[n].padre) {
+            if (n != zona) nodos[n].capacidad += cajones;
+        }
+        zonaDeCajon.insert(zonaDeCajon.end(), cajones, zona);
+        disponible.insert(disponible.end(), cajones, 0);
+        return zona;
+    }
+
+    int totalCajones() const {
+        return (int)zonaDeCajon.size();
+    }
+
+    // Cajon con indice 0..; O(profundidad) si cambio, nada si no
+    void marcar(int cajon, bool estaDisponible) {
+        if (cajon < 0 || cajon >= totalCajones() || (disponible[cajon] != 0) == estaDisponible) return;
+        disponible[cajon] = estaDisponible;
+        for (int n = zonaDeCajon[cajon]; n != -1; n = nodos[n].padre) {
+            nodos[n].disponibles += estaDisponible ? 1 : -1;
+            anotar(n);
+        }
+    }
+
+    // Nodos que cambiaron desde la llamada anterior (se agregan a 'resultado')
+    void tomarCambios(vector<int>& resultado) {
+        for (int n : cambios) {
+            nodos[n].cambiado = false;
+            resultado.push_back(n);
+        }
+        cambios.clear();
+    }
+
+    const Nodo& nodo(int n) const {
+        return nodos[n];
+    }
+
+    int totalNodos() const {
+        return (int)nodos.size();
+    }
+
+    // "sitio", "sitio/N1", "sitio/N1/A"
+    string ruta(int n) const {
+        return nodos[n].padre == -1 ? nodos[n].nombre : ruta(nodos[n].padre) + "/" + nodos[n].nombre;
+    }
+
+    // Cajon con indice 0..; fuera de rango, solo su numero
+    string etiqueta(int cajon) const {
+        if (cajon < 0 || cajon >= totalCajones()) return to_string(cajon + 1);
+        const Nodo& zona = nodos[zonaDeCajon[cajon]];
+        string prefijo = niveles > 1 ? nodos[zona.padre].nombre + "-" : "";
+        return prefijo + zona.nombre + "-" + to_string(cajon - zona.primerCajon + 1);
+    }
+
+    // Zona (0.., en orden de alta) de cada cajon, para PoliticaZonas
+    vector<int> zonasPorCajon() const {
+        vector<int> ordinal(nodos.size(), -1);
+        int zonas = 0;
+        for (size_t n = 0; n < nodos.size(); n++) {
+            if (nodos[n].tipo == NODO_ZONA) ordinal[n] = zonas++;
+        }
+        vector<int> resultado(zonaDeCajon.size());
+        for (size_t c = 0; c < zonaDeCajon.size(); c++) resultado[c] = ordinal[zonaDeCajon[c]];
+        return resultado;
+    }
+
+    // Zona (0..) por nombre ("A") o por nivel y nombre ("P1-A"); -1 si no existe
+    int buscarZona(const string& nombre) const {
+        int zonas = 0;
+        for (const Nodo& n : nodos) {
+            if (n.tipo != NODO_ZONA) continue;
+            if (n.nombre == nombre || nodos[n.padre].nombre + "-" + n.nombre == nombre) return zonas;
+            zonas++;
+        }
+        return -1;
+    }
+};
+
+#endif
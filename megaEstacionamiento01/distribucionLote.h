@@ -0,0 +1,64 @@
+#ifndef DISTRIBUCION_LOTE_H
+#define DISTRIBUCION_LOTE_H
+
+// ==================== DISTRIBUCION DEL LOTE ====================
+// Única descripción del lote. La usan el sketch del MEGA (tablas de pines)
+// y la PC (capacidad fija del motor, ver EstacionamientoMega), así que
+// agregar un cajón es tocar solo estas listas. Sin STL: compila con avr-gcc.
+//
+//   LOTE_ZONAS(ZONA)     ZONA(nombre, cajones); los cajones se numeran
+//                        seguidos, zona por zona
+//   LOTE_CAJONES(CAJON)  CAJON(trig, echo, ledVerde, ledRojo) en el mismo orden
+//   LOTE_PLUMAS(PLUMA)   PLUMA(carril, trig, echo, servo, ledOk, ledDetect),
+//                        primero entrada (carril 1) y luego salida (carril 2)
+//
+// Todos los echo van al puerto K (A8..A15) en orden: cajones en los bits
+// 0.. y después las dos plumas.
+
+#define LOTE_ZONAS(ZONA) \
+  ZONA("A", 6)
+
+#define LOTE_CAJONES(CAJON) \
+  CAJON(22, A8,  24, 25)  /* Cajón 1 */ \
+  CAJON(26, A9,  28, 29)  /* Cajón 2 */ \
+  CAJON(30, A10, 32, 33)  /* Cajón 3 */ \
+  CAJON(34, A11, 36, 37)  /* Cajón 4 */ \
+  CAJON(38, A12, 40, 41)  /* Cajón 5 */ \
+  CAJON(42, A13, 44, 45)  /* Cajón 6 */
+
+#define LOTE_PLUMAS(PLUMA) \
+  PLUMA(1, 13, A14, 9, 11, 7)  /* Entrada */ \
+  PLUMA(2,  4, A15, 8, 10, 5)  /* Salida */
+
+// ---- Constantes derivadas (las mismas en el MEGA y en la PC) ----
+#define LOTE_CONTAR(...) + 1
+#define LOTE_SUMAR_ZONA(nombre, cajones) + (cajones)
+#define LOTE_ZONA(nombre, cajones) { nombre, cajones },
+
+const int CAJONES_LOTE = 0 LOTE_CAJONES(LOTE_CONTAR);
+const int ZONAS_LOTE = 0 LOTE_ZONAS(LOTE_CONTAR);
+const int PLUMAS_LOTE = 0 LOTE_PLUMAS(LOTE_CONTAR);
+
+static_assert(CAJONES_LOTE == 0 LOTE_ZONAS(LOTE_SUMAR_ZONA),
+              "las zonas deben sumar los cajones de LOTE_CAJONES");
+static_assert(PLUMAS_LOTE == 2, "el MEGA maneja una pluma de entrada y una de salida");
+static_assert(CAJONES_LOTE + PLUMAS_LOTE <= 8, "un sensor por bit del puerto K");
+
+struct ZonaLote {
+  const char* nombre;
+  int cajones;
+};
+
+constexpr ZonaLote ZONAS[ZONAS_LOTE] = { LOTE_ZONAS(LOTE_ZONA) };
+
+// Índice (0..) del primer cajón de la zona
+constexpr int primerCajonZona(int zona) {
+  return zona <= 0 ? 0 : primerCajonZona(zona - 1) + ZONAS[zona - 1].cajones;
+}
+
+// Zona (0..) del cajón con índice 0..
+constexpr int zonaDeCajon(int cajon, int zona = 0) {
+  return zona + 1 >= ZONAS_LOTE || cajon < primerCajonZona(zona + 1) ? zona : zonaDeCajon(cajon, zona + 1);
+}
+
+#endif
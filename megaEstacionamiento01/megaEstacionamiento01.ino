@@ -1,58 +1,212 @@
 #include <Servo.h>
+#include "distribucionLote.h"
 
 Servo servoEntrada;
 Servo servoSalida;
 
-// Pines para los sensores de entrada y salida (puedes mantener los mismos)
-int trigEntrada = 13;
-int echoEntrada = 12;
-int trigSalida = 4;
-int echoSalida = 6;
+// Pines de las plumas, generados desde LOTE_PLUMAS (distribucionLote.h).
+// Todos los echo van al puerto K (A8..A15): es el único puerto del MEGA con
+// interrupción por cambio de pin en sus 8 bits, y así una sola ISR mide
+// los 8 sensores (ver "MEDICION POR INTERRUPCIONES")
+struct PinesPluma {
+  int carril;
+  int trig;
+  int echo;
+  int servo;
+  int ledOk;
+  int ledDetect;
+};
+
+#define PINES_DE_PLUMA(carril, trig, echo, servo, ledOk, ledDetect) { carril, trig, echo, servo, ledOk, ledDetect },
+const PinesPluma PINES_PLUMAS[PLUMAS_LOTE] = { LOTE_PLUMAS(PINES_DE_PLUMA) };
+
+int trigEntrada = PINES_PLUMAS[0].trig;
+int echoEntrada = PINES_PLUMAS[0].echo;
+int trigSalida = PINES_PLUMAS[1].trig;
+int echoSalida = PINES_PLUMAS[1].echo;
 
 // FLAGS para entrada/salida
 bool autoEntradaDetectado = false;
 bool autoSalidaDetectado = false;
 
 // LEDs para entrada/salida
-int ledEntradaDetect = 7;  // Se enciende cuando se manda 40
-int ledSalidaDetect = 5;   // Se enciende cuando se manda 
-int ledEntradaOk = 11;     // Se enciende cuando se recibe 1
-int ledSalidaOk = 10;      // Se enciende cuando se recibe 2
-
-// Configuración de los 6 cajones de estacionamiento
+int ledEntradaDetect = PINES_PLUMAS[0].ledDetect;  // Se enciende cuando se manda 40
+int ledSalidaDetect = PINES_PLUMAS[1].ledDetect;   // Se enciende cuando se manda 
+int ledEntradaOk = PINES_PLUMAS[0].ledOk;          // Se enciende cuando se recibe 1
+int ledSalidaOk = PINES_PLUMAS[1].ledOk;           // Se enciende cuando se recibe 2
+
+// Filtro de los cajones: un rebote suelto o un eco perdido no cambian el
+// estado. Se toma la mediana de las últimas lecturas, con umbrales
+// distintos para ocupar y liberar, y el cambio debe sostenerse un tiempo
+// mínimo antes de avisar a la PC.
+const int MUESTRAS_FILTRO = 5;              // mediana de 5 barridos (~0.5 s)
+const long DISTANCIA_MINIMA = 2;            // cm, debajo de esto el HC-SR04 no mide
+const long UMBRAL_OCUPAR = 5;               // cm, mediana <= esto: hay auto
+const long UMBRAL_LIBERAR = 8;              // cm, mediana >= esto: cajón vacío
+const unsigned long TIEMPO_ESTABLE = 1000;  // ms que debe sostenerse el cambio
+
+// Configuración de los cajones de estacionamiento
 struct Cajon {
   int trig;
   int echo;
   int ledVerde;
   int ledRojo;
   bool ocupado;
+  int muestras[MUESTRAS_FILTRO];  // cm, buffer circular
+  uint8_t siguiente;              // posición de la próxima muestra
+  uint8_t totalMuestras;          // hasta llenar el buffer por primera vez
+  bool cambioPendiente;           // la mediana pide el estado contrario
+  unsigned long cambioDesde;      // millis() desde que lo pide
 };
 
-// Definición de pines para los 6 cajones en el MEGA
-Cajon cajones[6] = {
-  { 22, 23, 24, 25, false },  // Cajón 1
-  { 26, 27, 28, 29, false },  // Cajón 2
-  { 30, 31, 32, 33, false },  // Cajón 3
-  { 34, 35, 36, 37, false },  // Cajón 4
-  { 38, 39, 40, 41, false },  // Cajón 5
-  { 42, 43, 44, 45, false }   // Cajón 6oo
-};
+// Pines de los cajones, generados desde LOTE_CAJONES (echo en A8..)
+#define CAJON_DEL_LOTE(trig, echo, ledVerde, ledRojo) { trig, echo, ledVerde, ledRojo, false },
+Cajon cajones[CAJONES_LOTE] = { LOTE_CAJONES(CAJON_DEL_LOTE) };
 
-const int UMBRAL_OCUPADO = 5;  // cm - ajusta según necesidad
 int cajonesOcupados = 0;
-const int TOTAL_CAJONES = 6;
+const int TOTAL_CAJONES = CAJONES_LOTE;
+
+// Trama de ocupación: un solo mensaje con todos los cajones en vez de una
+// línea de texto por cajón. "M" + 2 dígitos hex, bit i = cajón i+1
+// (p. ej. "M05" = cajones 1 y 3 ocupados). Sale en el barrido en que cambió
+// algún cajón y cada PERIODO_MAPA como refresco, para que la PC se
+// sincronice al conectarse o si se perdió una trama.
+const unsigned long PERIODO_MAPA = 2000;
+uint8_t mapaCajones = 0;
+bool mapaCambio = true;  // la primera trama sale en cuanto hay estado inicial
+unsigned long ultimoMapa = 0;
+
+// Plumas: se mueven por pasos desde loop() con millis(), sin delay(),
+// para que los sensores, la otra pluma y el Serial sigan atendiéndose
+const int ANGULO_CERRADA = 45;
+const int ANGULO_ABIERTA = 110;
+const unsigned long MS_POR_GRADO = 30;
+const unsigned long TIEMPO_ABIERTA = 2000;  // Tiempo para que pase el auto
+const unsigned long ANTI_REBOTE = 200;      // ms mínimos entre dos avisos de auto en la misma pluma
+
+enum EstadoPluma { PLUMA_CERRADA, PLUMA_ABRIENDO, PLUMA_ABIERTA, PLUMA_CERRANDO };
+
+struct Pluma {
+  int carril;          // código con que la PC la abre (1 entrada, 2 salida)
+  Servo* servo;
+  int ledOk;
+  int ledDetect;
+  bool* autoDetectado;
+  EstadoPluma estado;
+  int angulo;
+  int anguloInicio;    // ángulo al empezar el movimiento actual
+  unsigned long marca; // millis() al entrar al estado actual
+  unsigned long ultimoAviso;  // millis() del último 40/30 de esta pluma (ANTI_REBOTE)
+};
 
-long medirDistancia(int trig, int echo) {
-  digitalWrite(trig, LOW);
-  delayMicroseconds(2);
-  digitalWrite(trig, HIGH);
-  delayMicroseconds(10);
-  digitalWrite(trig, LOW);
+Pluma plumaEntrada = { PINES_PLUMAS[0].carril, &servoEntrada, ledEntradaOk, ledEntradaDetect, &autoEntradaDetectado, PLUMA_CERRADA, ANGULO_CERRADA, ANGULO_CERRADA, 0, 0 };
+Pluma plumaSalida = { PINES_PLUMAS[1].carril, &servoSalida, ledSalidaOk, ledSalidaDetect, &autoSalidaDetectado, PLUMA_CERRADA, ANGULO_CERRADA, ANGULO_CERRADA, 0, 0 };
+
+const unsigned long PERIODO_LECTURA = 100;  // ms entre ciclos de lectura de sensores
+unsigned long ultimaLectura = 0;
+
+// -------- MEDICION POR INTERRUPCIONES --------
+// En vez de 8 pulseIn() seguidos (hasta 30 ms cada uno), se disparan los
+// triggers por grupos escalonados y la ISR de PCINT2 marca con micros() el
+// inicio y el fin de cada eco. Un barrido completo tarda una ventana de eco
+// y loop() sigue libre mientras tanto.
+// Cada cajón se muestrea cada PERIODO_LECTURA también con autos en las dos
+// plumas: ningún paso de loop() espera (las plumas y el anti-rebote van con
+// millis()). En el simulador, con las dos plumas abriendo y cerrando a la
+// vez (perfiles/mega_plumas_trafico.txt, make benchmark): periodo máximo de
+// cada sensor 100.0 ms y loop() de a lo más 0.7 ms.
+// Sensor i = bit i del puerto K: primero los cajones, luego entrada y salida.
+const int TOTAL_SENSORES = TOTAL_CAJONES + PLUMAS_LOTE;
+const int SENSOR_ENTRADA = TOTAL_CAJONES;
+const int SENSOR_SALIDA = TOTAL_CAJONES + 1;
+const uint8_t TODOS_LOS_SENSORES = (1 << TOTAL_SENSORES) - 1;
+const unsigned long VENTANA_ECO = 30000;   // us, mismo timeout que tenía pulseIn
+const unsigned long ESCALON_GRUPO = 300;   // us entre grupos: no se enciman las ráfagas de 40 kHz
+const long SIN_ECO = 100;                  // cm reportados si no hubo eco (igual que antes)
+
+// Sensores que se disparan juntos; alternados para que dos vecinos no se escuchen
+const uint8_t GRUPOS[] = { 0b01010101, 0b10101010 };
+const int TOTAL_GRUPOS = sizeof(GRUPOS) / sizeof(GRUPOS[0]);
+
+int trigs[TOTAL_SENSORES];
+long distancias[TOTAL_SENSORES];
+
+volatile unsigned long inicioEco[TOTAL_SENSORES];
+volatile unsigned long duracionEco[TOTAL_SENSORES];
+volatile uint8_t ecosPendientes = 0;  // sensores sin eco completo en este barrido
+volatile uint8_t ecosIniciados = 0;   // sensores con flanco de subida visto
+volatile uint8_t puertoAnterior = 0;
+
+bool barridoActivo = false;
+unsigned long inicioBarrido = 0;
+
+// Código numérico recibido de la PC, se arma sin bloquear hasta el salto de línea
+long codigoSerial = 0;
+bool hayDigitos = false;
+
+ISR(PCINT2_vect) {
+  unsigned long ahora = micros();
+  uint8_t puerto = PINK;
+  uint8_t cambios = (puerto ^ puertoAnterior) & ecosPendientes;
+  puertoAnterior = puerto;
+
+  for (uint8_t i = 0; i < TOTAL_SENSORES; i++) {
+    uint8_t bit = 1 << i;
+    if (!(cambios & bit)) continue;
+    if (puerto & bit) {
+      inicioEco[i] = ahora;
+      ecosIniciados |= bit;
+    } else if (ecosIniciados & bit) {
+      duracionEco[i] = ahora - inicioEco[i];
+      ecosPendientes &= ~bit;
+    }
+  }
+}
+
+void iniciarBarrido() {
+  noInterrupts();
+  ecosPendientes = TODOS_LOS_SENSORES;
+  ecosIniciados = 0;
+  puertoAnterior = PINK;
+  interrupts();
 
-  long duracion = pulseIn(echo, HIGH, 30000);  // Timeout de 30ms
-  if (duracion == 0) return 100;               // Retorna 100cm si hay timeout
+  for (int g = 0; g < TOTAL_GRUPOS; g++) {
+    for (int i = 0; i < TOTAL_SENSORES; i++) {
+      if (GRUPOS[g] & (1 << i)) digitalWrite(trigs[i], HIGH);
+    }
+    delayMicroseconds(10);
+    for (int i = 0; i < TOTAL_SENSORES; i++) {
+      if (GRUPOS[g] & (1 << i)) digitalWrite(trigs[i], LOW);
+    }
+    delayMicroseconds(ESCALON_GRUPO);
+  }
 
-  return duracion * 0.034 / 2;
+  inicioBarrido = micros();
+  barridoActivo = true;
+}
+
+// true cuando ya llegaron todos los ecos o se agotó la ventana
+bool terminarBarrido() {
+  noInterrupts();
+  uint8_t pendientes = ecosPendientes;
+  interrupts();
+  if (pendientes != 0 && micros() - inicioBarrido < VENTANA_ECO) {
+    return false;
+  }
+
+  noInterrupts();
+  for (int i = 0; i < TOTAL_SENSORES; i++) {
+    if (ecosPendientes & (1 << i)) {
+      distancias[i] = SIN_ECO;
+    } else {
+      distancias[i] = duracionEco[i] * 0.034 / 2;
+    }
+  }
+  ecosPendientes = 0;  // ecos tardíos se ignoran hasta el próximo barrido
+  interrupts();
+
+  barridoActivo = false;
+  return true;
 }
 
 void controlarLEDsCajon(int cajonIndex, bool ocupado) {
@@ -65,14 +219,22 @@ void controlarLEDsCajon(int cajonIndex, bool ocupado) {
   }
 }
 
-// Función para enviar senal del estado de un cajón
-void enviarSenalCajon(int cajonIndex, bool ocupado) {
-  // Aquí puedes modificar el formato de la senal según lo que necesites
-  // Por ejemplo, podrías enviar un JSON o un string simple
-  Serial.print("Cajon:");
-  Serial.print(cajonIndex + 1);
-  Serial.print(",Estado:");
-  Serial.println(ocupado ? "OCUPADO" : "LIBRE");
+// Envía la trama con el estado de todos los cajones (ver PERIODO_MAPA)
+void enviarMapaCajones() {
+  for (int i = 0; i < TOTAL_CAJONES; i++) {
+    if (cajones[i].totalMuestras < MUESTRAS_FILTRO) return;  // aún sin estado inicial
+  }
+  if (!mapaCambio && millis() - ultimoMapa < PERIODO_MAPA) {
+    return;
+  }
+
+  const char DIGITOS_HEX[] = "0123456789ABCDEF";
+  Serial.print('M');
+  Serial.print(DIGITOS_HEX[mapaCajones >> 4]);
+  Serial.println(DIGITOS_HEX[mapaCajones & 0x0F]);
+
+  mapaCambio = false;
+  ultimoMapa = millis();
 }
 
 void actualizarCajon(int cajonIndex, bool ocupado) {
@@ -83,27 +245,168 @@ void actualizarCajon(int cajonIndex, bool ocupado) {
 
     if (ocupado) {
       cajonesOcupados++;
+      mapaCajones |= (1 << cajonIndex);
     } else {
       cajonesOcupados--;
+      mapaCajones &= ~(1 << cajonIndex);
+    }
+
+    // Se reporta una sola vez al final del barrido
+    mapaCambio = true;
+  }
+}
+
+// Mediana por inserción: con 5 muestras son a lo más 10 comparaciones
+int medianaCajon(const Cajon& cajon) {
+  int orden[MUESTRAS_FILTRO];
+  for (int i = 0; i < MUESTRAS_FILTRO; i++) {
+    int valor = cajon.muestras[i];
+    int j = i;
+    while (j > 0 && orden[j - 1] > valor) {
+      orden[j] = orden[j - 1];
+      j--;
+    }
+    orden[j] = valor;
+  }
+  return orden[MUESTRAS_FILTRO / 2];
+}
+
+// Agrega una lectura al cajón y solo reporta el cambio cuando es estable
+void filtrarCajon(int cajonIndex, long distancia) {
+  Cajon& cajon = cajones[cajonIndex];
+  if (distancia < DISTANCIA_MINIMA) {
+    return;
+  }
+
+  cajon.muestras[cajon.siguiente] = distancia;
+  cajon.siguiente = (cajon.siguiente + 1) % MUESTRAS_FILTRO;
+  if (cajon.totalMuestras < MUESTRAS_FILTRO) {
+    cajon.totalMuestras++;
+    if (cajon.totalMuestras == MUESTRAS_FILTRO) {
+      // Primer estado del cajón: no hay un cambio que confirmar
+      actualizarCajon(cajonIndex, medianaCajon(cajon) <= UMBRAL_OCUPAR);
     }
+    return;
+  }
+
+  // Entre los dos umbrales se conserva el estado actual (histéresis)
+  int mediana = medianaCajon(cajon);
+  bool ocupado = cajon.ocupado;
+  if (mediana <= UMBRAL_OCUPAR) {
+    ocupado = true;
+  } else if (mediana >= UMBRAL_LIBERAR) {
+    ocupado = false;
+  }
 
-    // Enviar senal del cambio de estado
-    enviarSenalCajon(cajonIndex, ocupado);
+  if (ocupado == cajon.ocupado) {
+    cajon.cambioPendiente = false;
+  } else if (!cajon.cambioPendiente) {
+    cajon.cambioPendiente = true;
+    cajon.cambioDesde = millis();
+  } else if (millis() - cajon.cambioDesde >= TIEMPO_ESTABLE) {
+    cajon.cambioPendiente = false;
+    actualizarCajon(cajonIndex, ocupado);
+  }
+}
 
-    Serial.print("Total ocupados: ");
-    Serial.print(cajonesOcupados);
-    Serial.print("/");
-    Serial.println(TOTAL_CAJONES);
+void cambiarEstadoPluma(Pluma& pluma, EstadoPluma estado) {
+  pluma.estado = estado;
+  pluma.anguloInicio = pluma.angulo;
+  pluma.marca = millis();
+}
+
+// Operador autorizó el paso: abre, o mantiene abierta si ya lo estaba.
+// Se confirma a la PC con "P<carril>" para que mida la latencia completa.
+void abrirPluma(Pluma& pluma) {
+  Serial.print('P');
+  Serial.println(pluma.carril);
+  digitalWrite(pluma.ledOk, HIGH);
+  if (pluma.estado == PLUMA_ABIERTA) {
+    pluma.marca = millis();
+  } else if (pluma.estado != PLUMA_ABRIENDO) {
+    cambiarEstadoPluma(pluma, PLUMA_ABRIENDO);
   }
 }
 
+// Avanza la pluma según el tiempo transcurrido; se llama en cada loop()
+void actualizarPluma(Pluma& pluma) {
+  unsigned long transcurrido = millis() - pluma.marca;
+  int grados = transcurrido / MS_POR_GRADO;
+
+  switch (pluma.estado) {
+    case PLUMA_CERRADA:
+      return;
+
+    case PLUMA_ABRIENDO:
+      if (pluma.anguloInicio + grados >= ANGULO_ABIERTA) {
+        pluma.angulo = ANGULO_ABIERTA;
+        cambiarEstadoPluma(pluma, PLUMA_ABIERTA);
+      } else {
+        pluma.angulo = pluma.anguloInicio + grados;
+      }
+      break;
+
+    case PLUMA_ABIERTA:
+      if (transcurrido >= TIEMPO_ABIERTA) {
+        cambiarEstadoPluma(pluma, PLUMA_CERRANDO);
+      }
+      return;
+
+    case PLUMA_CERRANDO:
+      if (pluma.anguloInicio - grados <= ANGULO_CERRADA) {
+        pluma.angulo = ANGULO_CERRADA;
+        cambiarEstadoPluma(pluma, PLUMA_CERRADA);
+
+        digitalWrite(pluma.ledOk, LOW);
+        *pluma.autoDetectado = false;
+        digitalWrite(pluma.ledDetect, LOW);
+      } else {
+        pluma.angulo = pluma.anguloInicio - grados;
+      }
+      break;
+  }
+  pluma.servo->write(pluma.angulo);
+}
+
+// Auto frente a la pluma (2..4 cm): avisa a la PC con 'codigo' una vez,
+// hasta que la pluma cierre o la PC responda "0". El anti-rebote es una
+// marca de millis() por pluma, no un delay(): mientras corre, la otra
+// pluma y los barridos siguen atendiéndose.
+void detectarAuto(Pluma& pluma, long distancia, int codigo) {
+  if (*pluma.autoDetectado || distancia < 2 || distancia > 4) return;
+  if (millis() - pluma.ultimoAviso < ANTI_REBOTE) return;
+  Serial.println(codigo);
+  *pluma.autoDetectado = true;
+  digitalWrite(pluma.ledDetect, HIGH);
+  pluma.ultimoAviso = millis();
+}
+
+// Regresa el código completo (terminado en salto de línea) o -1 si aún no llega
+long leerCodigoSerial() {
+  while (Serial.available()) {
+    char c = Serial.read();
+    if (c >= '0' && c <= '9') {
+      codigoSerial = codigoSerial * 10 + (c - '0');
+      hayDigitos = true;
+    } else if (c == '\n') {
+      long codigo = hayDigitos ? codigoSerial : -1;
+      codigoSerial = 0;
+      hayDigitos = false;
+      if (codigo != -1) return codigo;
+    }
+  }
+  return -1;
+}
+
 void setup() {
   Serial.begin(9600);
 
   // Configurar pines de entrada/salida
   pinMode(trigEntrada, OUTPUT);
+  digitalWrite(trigEntrada, LOW);
   pinMode(echoEntrada, INPUT);
   pinMode(trigSalida, OUTPUT);
+  digitalWrite(trigSalida, LOW);
   pinMode(echoSalida, INPUT);
 
   pinMode(ledEntradaDetect, OUTPUT);
@@ -114,19 +417,27 @@ void setup() {
   // Configurar pines para los cajones
   for (int i = 0; i < TOTAL_CAJONES; i++) {
     pinMode(cajones[i].trig, OUTPUT);
+    digitalWrite(cajones[i].trig, LOW);
     pinMode(cajones[i].echo, INPUT);
     pinMode(cajones[i].ledVerde, OUTPUT);
     pinMode(cajones[i].ledRojo, OUTPUT);
 
     // Inicializar LEDs (verde encendido = libre)
     controlarLEDsCajon(i, false);
+    trigs[i] = cajones[i].trig;
   }
+  trigs[SENSOR_ENTRADA] = trigEntrada;
+  trigs[SENSOR_SALIDA] = trigSalida;
+
+  // Interrupción por cambio de pin en todo el puerto K (PCINT16..23)
+  PCMSK2 = 0xFF;
+  PCICR |= (1 << PCIE2);
 
-  servoEntrada.attach(9);
-  servoSalida.attach(8);
+  servoEntrada.attach(PINES_PLUMAS[0].servo);
+  servoSalida.attach(PINES_PLUMAS[1].servo);
 
-  servoEntrada.write(45);
-  servoSalida.write(45);
+  servoEntrada.write(ANGULO_CERRADA);
+  servoSalida.write(ANGULO_CERRADA);
 
   // Apagar LEDs de entrada/salida
   digitalWrite(ledEntradaDetect, LOW);
@@ -136,89 +447,52 @@ void setup() {
 }
 
 void loop() {
-  // -------- LECTURA DE SENSORES DE CAJONES --------
-  for (int i = 0; i < TOTAL_CAJONES; i++) {
-    long distancia = medirDistancia(cajones[i].trig, cajones[i].echo);
- 
-   if ((distancia >= 2 && distancia <= 4) && cajonesOcupados < TOTAL_CAJONES) {
-      bool ocupado = (distancia <= UMBRAL_OCUPADO);
-      actualizarCajon(i, ocupado);
-    }
-  }
+  // -------- PLUMAS --------
+  actualizarPluma(plumaEntrada);
+  actualizarPluma(plumaSalida);
 
-  // -------- SENSOR DE ENTRADA --------
-  long dEntrada = medirDistancia(trigEntrada, echoEntrada);
-
-  // Validar distancia correcta y que haya cajones libres
-  if (!autoEntradaDetectado && dEntrada >= 2 && dEntrada <= 4 && cajonesOcupados < TOTAL_CAJONES) {
-    Serial.println(40);
-    autoEntradaDetectado = true;
-    digitalWrite(ledEntradaDetect, HIGH);
-    delay(200);  // Anti-rebote
+  // -------- LECTURA SERIAL (OPERADOR) --------
+  long codigo = leerCodigoSerial();
+  switch (codigo) {
+    case 1:  // operador autorizó ENTRADA
+      abrirPluma(plumaEntrada);
+      break;
+
+    case 2:  // operador autorizó SALIDA
+      abrirPluma(plumaSalida);
+      break;
+
+    case 0:  // estacionamiento lleno o reset
+      digitalWrite(ledEntradaOk, LOW);
+      autoEntradaDetectado = false;
+      digitalWrite(ledEntradaDetect, LOW);
+      break;
   }
 
-  // -------- SENSOR DE SALIDA --------
-  long dSalida = medirDistancia(trigSalida, echoSalida);
+  // -------- BARRIDO DE SENSORES --------
+  if (!barridoActivo) {
+    if (millis() - ultimaLectura >= PERIODO_LECTURA) {  // Espera entre ciclos de lectura
+      ultimaLectura = millis();
+      iniciarBarrido();
+    }
+    return;
+  }
+  if (!terminarBarrido()) {
+    return;
+  }
 
-  if (!autoSalidaDetectado && dSalida >= 2 && dSalida <= 4) {
-    Serial.println(30);
-    autoSalidaDetectado = true;
-    digitalWrite(ledSalidaDetect, HIGH);
-    delay(200);  // Anti-rebote
+  // -------- LECTURA DE SENSORES DE CAJONES --------
+  for (int i = 0; i < TOTAL_CAJONES; i++) {
+    filtrarCajon(i, distancias[i]);
   }
+  enviarMapaCajones();
 
-  // -------- LECTURA SERIAL (OPERADOR) --------
-  if (Serial.available()) {
-    int codigo = Serial.parseInt();
-
-    switch (codigo) {
-      case 1:  // operador autorizó ENTRADA
-        digitalWrite(ledEntradaOk, HIGH);
-        for (int i = 45; i <= 110; i++) {
-          servoEntrada.write(i);  // Abrir barrera
-          delay(30);
-        }
-
-        delay (2000);
-
-        for (int i = 110; i >=  45; i--) {
-          servoEntrada.write(i);  // Cerrar barrera
-          delay(30);          
-        }
-
-        // Tiempo para que pase el auto
-        digitalWrite(ledEntradaOk, LOW);
-
-        autoEntradaDetectado = false;
-        digitalWrite(ledEntradaDetect, LOW);
-        break;
-
-      case 2:  // operador autorizó SALIDA
-        digitalWrite(ledSalidaOk, HIGH);
-        for (int i = 45; i <= 110; i++) {
-          servoSalida.write(i);  // Abrir barrera
-          delay(30);
-        }
-
-        delay (2000);
-
-        for (int i = 110; i >=  45; i--) {
-          servoSalida.write(i);  // Cerrar barrera
-          delay(30);          
-        }
-        digitalWrite(ledSalidaOk, LOW);
-
-        autoSalidaDetectado = false;
-        digitalWrite(ledSalidaDetect, LOW);
-        break;
-
-      case 0:  // estacionamiento lleno o reset
-        digitalWrite(ledEntradaOk, LOW);
-        autoEntradaDetectado = false;
-        digitalWrite(ledEntradaDetect, LOW);
-        break;
-    }
+  // -------- SENSOR DE ENTRADA --------
+  // Solo si hay cajones libres
+  if (cajonesOcupados < TOTAL_CAJONES) {
+    detectarAuto(plumaEntrada, distancias[SENSOR_ENTRADA], 40);
   }
 
-  delay(100);  // Espera entre ciclos de lectura
-}
\ No newline at end of file
+  // -------- SENSOR DE SALIDA --------
+  detectarAuto(plumaSalida, distancias[SENSOR_SALIDA], 30);
+}
@@ -0,0 +1,84 @@
+#ifndef METRICAS_H
+#define METRICAS_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <sstream>
+
+using namespace std;
+
+// ==================== METRICAS ====================
+// Contadores y medidores con un entero atomico cada uno: actualizar cuesta
+// un incremento relajado (unos pocos ns) y se puede exportar desde otro hilo
+// sin detener a nadie. El texto sale en el formato de exposicion de Prometheus.
+class Metrica {
+private:
+    string nombre;
+    string ayuda;
+    bool medidor;  // false: contador (solo crece)
+    atomic<int64_t> valor;
+
+    friend class RegistroMetricas;
+
+public:
+    Metrica(const string& n, const string& a, bool esMedidor)
+        : nombre(n), ayuda(a), medidor(esMedidor), valor(0) {}
+
+    void sumar(int64_t n = 1) {
+        valor.fetch_add(n, memory_order_relaxed);
+    }
+
+    void fijar(int64_t n) {
+        valor.store(n, memory_order_relaxed);
+    }
+
+    int64_t leer() const {
+        return valor.load(memory_order_relaxed);
+    }
+};
+
+class RegistroMetricas {
+private:
+    deque<Metrica> metricas;  // deque: las referencias no se invalidan al agregar
+
+public:
+    // Se registran al arrancar; las referencias se guardan y se usan en el camino caliente
+    Metrica& contador(const string& nombre, const string& ayuda) {
+        metricas.emplace_back(nombre, ayuda, false);
+        return metricas.back();
+    }
+
+    Metrica& medidor(const string& nombre, const string& ayuda) {
+        metricas.emplace_back(nombre, ayuda, true);
+        return metricas.back();
+    }
+
+    string textoPrometheus() const {
+        ostringstream oss;
+        for (const Metrica& m : metricas) {
+            oss << "# HELP " << m.nombre << " " << m.ayuda << "\n";
+            oss << "# TYPE " << m.nombre << " " << (m.medidor ? "gauge" : "counter") << "\n";
+            oss << m.nombre << " " << m.leer() << "\n";
+        }
+        return oss.str();
+    }
+
+    // Escribe a un temporal y renombra: quien lea el archivo (p. ej. el
+    // colector textfile de node_exporter) nunca ve una exportacion a medias
+    bool exportarArchivo(const string& ruta) const {
+        string temporal = ruta + ".tmp";
+        FILE* archivo = fopen(temporal.c_str(), "wb");
+        if (archivo == nullptr) return false;
+        string texto = textoPrometheus();
+        bool escrito = fwrite(texto.data(), 1, texto.size(), archivo) == texto.size();
+        escrito = (fclose(archivo) == 0) && escrito;
+        if (!escrito) return false;
+        remove(ruta.c_str());  // en Windows rename no reemplaza
+        return rename(temporal.c_str(), ruta.c_str()) == 0;
+    }
+};
+
+#endif
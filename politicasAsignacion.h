@@ -0,0 +1,329 @@
+#ifndef POLITICAS_ASIGNACION_H
+#define POLITICAS_ASIGNACION_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <sstream>
+#include <cstdlib>
+#include <algorithm>
+
+#include "jerarquiaLote.h"
+
+using namespace std;
+
+// ==================== POLITICAS DE ASIGNACION ====================
+// Que cajon libre le toca a quien entra. El motor le avisa a la politica
+// cada cajon que queda disponible (libre y sin apartar) o deja de estarlo,
+// y la politica guarda los disponibles en monticulos indexados: elegir es
+// O(1) (O(zonas) en PoliticaZonas) y cada aviso O(log n), sin recorrer los
+// lugares. Los cajones se identifican por indice 0..capacidad-1.
+
+// Lo que pide quien entra; cada politica usa lo que le sirve
+struct SolicitudLugar {
+    int zona = -1;            // zona preferida (0..), -1: cualquiera
+    bool preferente = false;  // reserva, permiso o discapacidad: puede usar los cajones preferentes
+};
+
+// Monticulo de minimos de cajones con su clave; sabe donde esta cada cajon,
+// asi que quitar uno cualquiera tambien es O(log n)
+class MonticuloIndexado {
+private:
+    vector<int> monticulo;     // cajones
+    vector<int64_t> claves;    // por cajon
+    vector<int> posicion;      // por cajon; -1: no esta
+
+    bool menor(int a, int b) const {
+        return claves[monticulo[a]] < claves[monticulo[b]] ||
+               (claves[monticulo[a]] == claves[monticulo[b]] && monticulo[a] < monticulo[b]);
+    }
+
+    void intercambiar(int a, int b) {
+        swap(monticulo[a], monticulo[b]);
+        posicion[monticulo[a]] = a;
+        posicion[monticulo[b]] = b;
+    }
+
+    void subir(int i) {
+        while (i > 0 && menor(i, (i - 1) / 2)) {
+            intercambiar(i, (i - 1) / 2);
+            i = (i - 1) / 2;
+        }
+    }
+
+    void bajar(int i) {
+        int n = (int)monticulo.size();
+        while (true) {
+            int menorHijo = i;
+            if (2 * i + 1 < n && menor(2 * i + 1, menorHijo)) menorHijo = 2 * i + 1;
+            if (2 * i + 2 < n && menor(2 * i + 2, menorHijo)) menorHijo = 2 * i + 2;
+            if (menorHijo == i) return;
+            intercambiar(i, menorHijo);
+            i = menorHijo;
+        }
+    }
+
+public:
+    void reiniciar(int capacidad) {
+        monticulo.clear();
+        monticulo.reserve(capacidad);
+        claves.assign(capacidad, 0);
+        posicion.assign(capacidad, -1);
+    }
+
+    bool contiene(int cajon) const {
+        return posicion[cajon] != -1;
+    }
+
+    void insertar(int cajon, int64_t clave) {
+        if (contiene(cajon)) return;
+        claves[cajon] = clave;
+        posicion[cajon] = (int)monticulo.size();
+        monticulo.push_back(cajon);
+        subir((int)monticulo.size() - 1);
+    }
+
+    void quitar(int cajon) {
+        int i = posicion[cajon];
+        if (i == -1) return;
+        intercambiar(i, (int)monticulo.size() - 1);
+        monticulo.pop_back();
+        posicion[cajon] = -1;
+        if (i < (int)monticulo.size()) {
+            subir(i);
+            bajar(i);
+        }
+    }
+
+    bool vacio() const {
+        return monticulo.empty();
+    }
+
+    // -1 si esta vacio
+    int tope() const {
+        return monticulo.empty() ? -1 : monticulo[0];
+    }
+
+    int total() const {
+        return (int)monticulo.size();
+    }
+};
+
+class PoliticaAsignacion {
+public:
+    virtual ~PoliticaAsignacion() {}
+    virtual const char* nombre() const = 0;
+    // Despues de reiniciar ningun cajon esta disponible; el motor avisa los libres
+    virtual void reiniciar(int capacidad) = 0;
+    virtual void disponible(int cajon) = 0;
+    virtual void noDisponible(int cajon) = 0;
+    // Cajon para la solicitud, -1 si no hay; no lo quita (el motor avisa al ocuparlo)
+    virtual int elegir(const SolicitudLugar& solicitud) const = 0;
+};
+
+// El mas cercano a la salida segun 'distancias' (una por cajon; empates por
+// numero de cajon; sin distancia cuenta su numero). Sin distancias es el de
+// numero mas bajo (A-1 primero), lo que hacia entrada() antes de las
+// politicas.
+class PoliticaCercania : public PoliticaAsignacion {
+private:
+    vector<int> distancias;
+    MonticuloIndexado libres;
+
+public:
+    explicit PoliticaCercania(const vector<int>& distanciasCajon = vector<int>())
+        : distancias(distanciasCajon) {}
+
+    const char* nombre() const override {
+        return distancias.empty() ? "primer_libre" : "cercania";
+    }
+
+    void reiniciar(int capacidad) override {
+        libres.reiniciar(capacidad);
+    }
+
+    void disponible(int cajon) override {
+        libres.insertar(cajon, cajon < (int)distancias.size() ? distancias[cajon] : cajon);
+    }
+
+    void noDisponible(int cajon) override {
+        libres.quitar(cajon);
+    }
+
+    int elegir(const SolicitudLugar&) const override {
+        return libres.tope();
+    }
+};
+
+// Nivela el desgaste: le toca el cajon que lleva mas tiempo disponible, asi
+// que los cajones se usan por turno y no siempre los de la entrada
+class PoliticaRotacion : public PoliticaAsignacion {
+private:
+    MonticuloIndexado libres;
+    int64_t turno;
+
+public:
+    PoliticaRotacion() : turno(0) {}
+
+    const char* nombre() const override {
+        return "rotacion";
+    }
+
+    void reiniciar(int capacidad) override {
+        libres.reiniciar(capacidad);
+        turno = 0;
+    }
+
+    void disponible(int cajon) override {
+        if (!libres.contiene(cajon)) libres.insertar(cajon, turno++);
+    }
+
+    void noDisponible(int cajon) override {
+        libres.quitar(cajon);
+    }
+
+    int elegir(const SolicitudLugar&) const override {
+        return libres.tope();
+    }
+};
+
+// Un monticulo por zona: la zona pedida si tiene lugar y si no la mas
+// cercana en numero (empate: la de numero menor); sin zona pedida, la
+// primera con lugar. Dentro de la zona, el cajon de numero mas bajo. Cada
+// monticulo trabaja con la posicion del cajon dentro de su zona, asi que la
+// memoria es O(capacidad) con cualquier numero de zonas.
+class PoliticaZonas : public PoliticaAsignacion {
+private:
+    vector<int> zonaDeCajon;
+    vector<MonticuloIndexado> zonas;
+    vector<vector<int>> cajonesZona;  // en orden de numero
+    vector<int> posicionEnZona;       // por cajon
+
+    // Los cajones sin zona en la tabla van a la 0
+    int zonaDe(int cajon) const {
+        return cajon < (int)zonaDeCajon.size() ? zonaDeCajon[cajon] : 0;
+    }
+
+public:
+    // zonaCajon: zona (0..) de cada cajon
+    explicit PoliticaZonas(const vector<int>& zonaCajon) : zonaDeCajon(zonaCajon) {
+        int total = 1;
+        for (int z : zonaDeCajon) total = z + 1 > total ? z + 1 : total;
+        zonas.resize(total);
+        cajonesZona.resize(total);
+    }
+
+    const char* nombre() const override {
+        return "zonas";
+    }
+
+    void reiniciar(int capacidad) override {
+        for (vector<int>& cajones : cajonesZona) cajones.clear();
+        posicionEnZona.assign(capacidad, 0);
+        for (int cajon = 0; cajon < capacidad; cajon++) {
+            vector<int>& cajones = cajonesZona[zonaDe(cajon)];
+            posicionEnZona[cajon] = (int)cajones.size();
+            cajones.push_back(cajon);
+        }
+        for (size_t z = 0; z < zonas.size(); z++) zonas[z].reiniciar((int)cajonesZona[z].size());
+    }
+
+    void disponible(int cajon) override {
+        zonas[zonaDe(cajon)].insertar(posicionEnZona[cajon], posicionEnZona[cajon]);
+    }
+
+    void noDisponible(int cajon) override {
+        zonas[zonaDe(cajon)].quitar(posicionEnZona[cajon]);
+    }
+
+    int elegir(const SolicitudLugar& solicitud) const override {
+        int total = (int)zonas.size();
+        int pedida = solicitud.zona >= 0 && solicitud.zona < total ? solicitud.zona : 0;
+        for (int d = 0; d < total; d++) {
+            int z = pedida - d;
+            if (z >= 0 && !zonas[z].vacio()) return cajonesZona[z][zonas[z].tope()];
+            z = pedida + d;
+            if (d > 0 && z < total && !zonas[z].vacio()) return cajonesZona[z][zonas[z].tope()];
+        }
+        return -1;
+    }
+
+    int disponiblesZona(int zona) const {
+        return zona >= 0 && zona < (int)zonas.size() ? zonas[zona].total() : 0;
+    }
+};
+
+// Cajones preferentes (reservados, de discapacidad) primero para quien los
+// puede usar; los demas solo reciben cajones generales, aunque haya
+// preferentes libres. Dentro de cada grupo, el de numero mas bajo.
+class PoliticaPreferentes : public PoliticaAsignacion {
+private:
+    vector<bool> preferente;
+    MonticuloIndexado preferentes;
+    MonticuloIndexado generales;
+
+    MonticuloIndexado& grupo(int cajon) {
+        return cajon < (int)preferente.size() && preferente[cajon] ? preferentes : generales;
+    }
+
+public:
+    explicit PoliticaPreferentes(const vector<bool>& cajonesPreferentes) : preferente(cajonesPreferentes) {}
+
+    const char* nombre() const override {
+        return "preferentes";
+    }
+
+    void reiniciar(int capacidad) override {
+        preferentes.reiniciar(capacidad);
+        generales.reiniciar(capacidad);
+    }
+
+    void disponible(int cajon) override {
+        grupo(cajon).insertar(cajon, cajon);
+    }
+
+    void noDisponible(int cajon) override {
+        grupo(cajon).quitar(cajon);
+    }
+
+    int elegir(const SolicitudLugar& solicitud) const override {
+        if (solicitud.preferente && !preferentes.vacio()) return preferentes.tope();
+        return generales.tope();
+    }
+};
+
+// Por nombre, para la linea de comandos: primer_libre, cercania, rotacion,
+// zonas o preferentes, con la configuracion por cajon que use cada una.
+// nullptr si el nombre no existe.
+inline unique_ptr<PoliticaAsignacion> crearPolitica(const string& nombre, const vector<int>& distancias,
+                                                     const vector<int>& zonaDeCajon,
+                                                     const vector<bool>& preferentes) {
+    if (nombre == "primer_libre") return unique_ptr<PoliticaAsignacion>(new PoliticaCercania());
+    if (nombre == "cercania") return unique_ptr<PoliticaAsignacion>(new PoliticaCercania(distancias));
+    if (nombre == "rotacion") return unique_ptr<PoliticaAsignacion>(new PoliticaRotacion());
+    if (nombre == "zonas") return unique_ptr<PoliticaAsignacion>(new PoliticaZonas(zonaDeCajon));
+    if (nombre == "preferentes") return unique_ptr<PoliticaAsignacion>(new PoliticaPreferentes(preferentes));
+    return nullptr;
+}
+
+// Como viene en --politica o en la configuracion: "nombre" o
+// "nombre=n1,n2,..."; las zonas son las de la jerarquia del lote
+inline unique_ptr<PoliticaAsignacion> crearPoliticaLote(const string& texto, const JerarquiaLote& jerarquia) {
+    size_t igual = texto.find('=');
+    string nombre = texto.substr(0, igual);
+    vector<int> numeros;
+    if (igual != string::npos) {
+        istringstream lista(texto.substr(igual + 1));
+        string numero;
+        while (getline(lista, numero, ',')) numeros.push_back(atoi(numero.c_str()));
+    }
+    int cajones = jerarquia.totalCajones();
+    vector<bool> preferentes(cajones, false);
+    for (int lugar : numeros) {
+        if (lugar >= 1 && lugar <= cajones) preferentes[lugar - 1] = true;
+    }
+    return crearPolitica(nombre, numeros, jerarquia.zonasPorCajon(), preferentes);
+}
+
+#endif
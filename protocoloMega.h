@@ -0,0 +1,223 @@
+#ifndef PROTOCOLO_MEGA_H
+#define PROTOCOLO_MEGA_H
+
+#include <string>
+#include <cstring>
+
+using namespace std;
+
+// ==================== PROTOCOLO DEL MEGA ====================
+// Lineas que llegan por el puerto serial (megaEstacionamiento01.ino):
+//   "40" / "30"   auto en la pluma de entrada / salida
+//   "M" + 2 hex   ocupacion de los cajones, bit i = cajon i+1
+//   "P1" / "P2"   la pluma de entrada / salida empezo a moverse
+// Respuesta de la PC: "1" entrada o salida gratis, "2" salida con cobro,
+// "0" error. Sin consola ni E/S: lo comparten todos los frentes.
+//
+// La lectura no copia ni reserva memoria: leerTramaMega() trabaja sobre
+// los bytes que se le dan y DecodificadorMega arma las lineas en un buffer
+// fijo (ver benchmark/fuzzProtocoloMega.cpp y medirProtocolo() en el
+// benchmark).
+
+const int CODIGO_ENTRADA = 40;
+const int CODIGO_SALIDA = 30;
+
+// Las tramas del MEGA son de 2 o 3 caracteres; una linea mas larga es ruido
+const size_t MAX_TRAMA_MEGA = 32;
+const size_t MAX_DIGITOS_CODIGO = 9;  // cabe en un int
+
+enum TipoTramaMega {
+    TRAMA_VACIA,
+    TRAMA_CODIGO,    // codigo numerico (40, 30 u otro)
+    TRAMA_CAJONES,   // mapa de ocupacion
+    TRAMA_PLUMA,     // confirmacion de pluma
+    TRAMA_DESCONOCIDA
+};
+
+struct TramaMega {
+    TipoTramaMega tipo;
+    int codigo;         // TRAMA_CODIGO
+    unsigned int mapa;  // TRAMA_CAJONES
+    int carril;         // TRAMA_PLUMA: 1 entrada, 2 salida
+};
+
+// -1 si no es digito hexadecimal (sin depender del locale, como isxdigit)
+inline int valorHex(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// Trama de ocupacion del MEGA: "M" + 2 digitos hex, bit i = cajon i+1
+inline bool leerTramaCajones(const char* linea, size_t largo, unsigned int& mapa) {
+    if (largo != 3 || linea[0] != 'M') return false;
+    int alto = valorHex(linea[1]);
+    int bajo = valorHex(linea[2]);
+    if (alto < 0 || bajo < 0) return false;
+    mapa = (unsigned int)(alto * 16 + bajo);
+    return true;
+}
+
+inline bool leerTramaCajones(const string& linea, unsigned int& mapa) {
+    return leerTramaCajones(linea.data(), linea.size(), mapa);
+}
+
+// Clasifica una linea ya sin "\r\n". Un codigo es la linea completa en
+// digitos: "4", "400" o "Cajon:4" ya no se leen como 40 por traer un 4 en
+// alguna parte, son codigos distintos o tramas desconocidas.
+inline TramaMega clasificarTramaMega(const char* linea, size_t largo) {
+    TramaMega trama = {TRAMA_VACIA, -1, 0, 0};
+    if (largo == 0) return trama;
+
+    trama.tipo = TRAMA_DESCONOCIDA;
+    unsigned int digito = (unsigned int)(unsigned char)linea[0] - '0';
+    if (digito <= 9) {
+        if (largo > MAX_DIGITOS_CODIGO) return trama;
+        int codigo = (int)digito;
+        for (size_t i = 1; i < largo; i++) {
+            digito = (unsigned int)(unsigned char)linea[i] - '0';
+            if (digito > 9) return trama;
+            codigo = codigo * 10 + (int)digito;
+        }
+        trama.tipo = TRAMA_CODIGO;
+        trama.codigo = codigo;
+    } else if (linea[0] == 'P') {
+        if (largo == 2 && (linea[1] == '1' || linea[1] == '2')) {
+            trama.tipo = TRAMA_PLUMA;
+            trama.carril = linea[1] - '0';
+        }
+    } else if (linea[0] == 'M') {
+        if (leerTramaCajones(linea, largo, trama.mapa)) trama.tipo = TRAMA_CAJONES;
+    }
+    return trama;
+}
+
+// Con o sin "\r\n" al final
+inline TramaMega leerTramaMega(const char* linea, size_t largo) {
+    while (largo > 0 && (linea[largo - 1] == '\r' || linea[largo - 1] == '\n')) largo--;
+    return clasificarTramaMega(linea, largo);
+}
+
+inline TramaMega leerTramaMega(const string& linea) {
+    return leerTramaMega(linea.data(), linea.size());
+}
+
+// Arma lineas con los bytes del puerto como lleguen (una trama partida en
+// dos lecturas, varias en una). Una linea que llega completa en el bloque se
+// clasifica ahi mismo, sin copiarla; solo las partidas se juntan en un
+// buffer fijo de MAX_TRAMA_MEGA. Una linea mas larga se marca desbordada,
+// se clasifica como desconocida y linea() conserva solo lo que cupo.
+//
+//   const char* p = buffer;
+//   while (decodificador.siguiente(p, buffer + leidos, trama)) { ... }
+class DecodificadorMega {
+private:
+    char buffer[MAX_TRAMA_MEGA];
+    size_t largo;        // bytes de la linea partida en 'buffer'
+    bool desbordada;
+    bool entregada;      // la ultima linea ya salio; la siguiente empieza de cero
+    const char* vista;   // la ultima linea entregada (en el bloque o en 'buffer')
+    size_t largoVista;
+
+    void empezarLinea() {
+        largo = 0;
+        desbordada = false;
+        entregada = false;
+    }
+
+    void acumular(const char* desde, const char* hasta) {
+        size_t copiar = (size_t)(hasta - desde);
+        if (copiar > MAX_TRAMA_MEGA - largo) {
+            copiar = MAX_TRAMA_MEGA - largo;
+            desbordada = true;
+        }
+        memcpy(buffer + largo, desde, copiar);
+        largo += copiar;
+    }
+
+    TramaMega cerrarLinea(const char* texto, size_t n) {
+        while (n > 0 && texto[n - 1] == '\r') n--;
+        vista = texto;
+        largoVista = n;
+        entregada = true;
+        if (desbordada) return {TRAMA_DESCONOCIDA, -1, 0, 0};
+        return clasificarTramaMega(texto, n);
+    }
+
+public:
+    DecodificadorMega()
+        : largo(0), desbordada(false), entregada(false), vista(buffer), largoVista(0) {}
+
+    // Consume de [datos, fin) hasta el siguiente '\n'. true: 'trama' es esa
+    // linea y 'datos' queda despues del salto. false: se acabaron los bytes
+    // y lo que quedo a medias espera la siguiente llamada.
+    bool siguiente(const char*& datos, const char* fin, TramaMega& trama) {
+        if (entregada) empezarLinea();
+        // Las tramas son de pocos bytes: un recorrido simple gana a memchr
+        const char* salto = datos;
+        while (salto < fin && *salto != '\n') salto++;
+        if (salto < fin && largo == 0 && !desbordada) {
+            size_t n = (size_t)(salto - datos);
+            if (n > MAX_TRAMA_MEGA) {
+                n = MAX_TRAMA_MEGA;
+                desbordada = true;
+            }
+            const char* linea = datos;
+            datos = salto + 1;
+            trama = cerrarLinea(linea, n);
+            return true;
+        }
+        acumular(datos, salto);
+        if (salto == fin) {
+            datos = fin;
+            return false;
+        }
+        datos = salto + 1;
+        trama = cerrarLinea(buffer, largo);
+        return true;
+    }
+
+    // Para bloques que ya vienen en lineas completas sin '\n' final: entrega
+    // lo que quedo a medias como una linea. false si no quedo nada.
+    bool terminar(TramaMega& trama) {
+        if (entregada) empezarLinea();
+        if (largo == 0 && !desbordada) return false;
+        trama = cerrarLinea(buffer, largo);
+        return true;
+    }
+
+    // true si no hay una linea a medias (el proximo byte empieza una)
+    bool enBlanco() const {
+        return entregada || (largo == 0 && !desbordada);
+    }
+
+    // La ultima linea entregada, sin "\r\n" ni '\0' final (usar con
+    // largoLinea()); puede apuntar al bloque que se le dio, asi que vale
+    // hasta la siguiente llamada y mientras ese bloque exista
+    const char* linea() const {
+        return vista;
+    }
+
+    size_t largoLinea() const {
+        return largoVista;
+    }
+
+    bool lineaDesbordada() const {
+        return desbordada;
+    }
+};
+
+// Primer codigo de un bloque leido de una vez (los frentes de consola leen
+// bloques de lineas completas); TRAMA_VACIA si no trae ninguno
+inline TramaMega primerCodigoMega(const char* datos, size_t largo) {
+    DecodificadorMega decodificador;
+    const char* fin = datos + largo;
+    TramaMega trama;
+    while (decodificador.siguiente(datos, fin, trama) || decodificador.terminar(trama)) {
+        if (trama.tipo == TRAMA_CODIGO) return trama;
+    }
+    return {TRAMA_VACIA, -1, 0, 0};
+}
+
+#endif
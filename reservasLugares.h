@@ -0,0 +1,515 @@
+#ifndef RESERVAS_LUGARES_H
+#define RESERVAS_LUGARES_H
+
+#include <ctime>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+#include <queue>
+#include <unordered_map>
+#include <algorithm>
+#include <limits>
+
+using namespace std;
+
+// ==================== CALENDARIO DE RESERVAS ====================
+// Reservas simultaneas por cubeta de CUBETA_SEGUNDOS desde 'base' en un
+// arbol de segmentos con suma perezosa: agregar o quitar una reserva y
+// preguntar el maximo de una ventana cuestan O(log cubetas), sin recorrer
+// reservas ni cajones. Cubre dos horizontes a partir de 'base'; cuando el
+// tiempo avanza uno, se recorre la base y se reconstruye con las reservas
+// vivas (una vez por horizonte).
+//
+// Una reserva cuenta en toda cubeta que toca, asi que el pronostico es
+// conservador en las orillas: 10:05-10:10 ocupa la cubeta 10:00-10:15.
+class CalendarioReservas {
+public:
+    static const int CUBETA_SEGUNDOS = 15 * 60;
+
+private:
+    int totalCubetas;
+    int64_t base;            // cubeta absoluta (t / CUBETA_SEGUNDOS) de la posicion 0
+    vector<int> maximo;      // maximo del nodo, ya con su suma pendiente
+    vector<int> pendiente;   // suma que falta bajar a los hijos
+
+    void sumar(int nodo, int izq, int der, int a, int b, int valor) {
+        if (b < izq || der < a) return;
+        if (a <= izq && der <= b) {
+            maximo[nodo] += valor;
+            pendiente[nodo] += valor;
+            return;
+        }
+        int mitad = (izq + der) / 2;
+        sumar(nodo * 2, izq, mitad, a, b, valor);
+        sumar(nodo * 2 + 1, mitad + 1, der, a, b, valor);
+        maximo[nodo] = pendiente[nodo] + max(maximo[nodo * 2], maximo[nodo * 2 + 1]);
+    }
+
+    int consultar(int nodo, int izq, int der, int a, int b) const {
+        if (b < izq || der < a) return 0;
+        if (a <= izq && der <= b) return maximo[nodo];
+        int mitad = (izq + der) / 2;
+        return pendiente[nodo] + max(consultar(nodo * 2, izq, mitad, a, b),
+                                     consultar(nodo * 2 + 1, mitad + 1, der, a, b));
+    }
+
+    // [inicio, fin) -> posiciones [a, b] dentro del arbol; false si cae fuera
+    bool posiciones(time_t inicio, time_t fin, int& a, int& b) const {
+        int64_t primera = (int64_t)inicio / CUBETA_SEGUNDOS - base;
+        int64_t ultima = ((int64_t)fin + CUBETA_SEGUNDOS - 1) / CUBETA_SEGUNDOS - 1 - base;
+        if (primera < 0) primera = 0;
+        if (ultima >= totalCubetas) ultima = totalCubetas - 1;
+        if (primera > ultima) return false;
+        a = (int)primera;
+        b = (int)ultima;
+        return true;
+    }
+
+public:
+    // 'horizonte': lo mas lejos que se puede reservar, en segundos
+    CalendarioReservas(time_t horizonte, time_t ahora)
+        : totalCubetas((int)(2 * ((horizonte + CUBETA_SEGUNDOS - 1) / CUBETA_SEGUNDOS))),
+          base((int64_t)ahora / CUBETA_SEGUNDOS),
+          maximo(4 * totalCubetas, 0), pendiente(4 * totalCubetas, 0) {}
+
+    void agregar(time_t inicio, time_t fin, int valor = 1) {
+        int a, b;
+        if (posiciones(inicio, fin, a, b)) sumar(1, 0, totalCubetas - 1, a, b, valor);
+    }
+
+    void quitar(time_t inicio, time_t fin) {
+        agregar(inicio, fin, -1);
+    }
+
+    // Mayor numero de reservas simultaneas en [desde, hasta)
+    int maximoEn(time_t desde, time_t hasta) const {
+        int a, b;
+        return posiciones(desde, hasta, a, b) ? consultar(1, 0, totalCubetas - 1, a, b) : 0;
+    }
+
+    // true si 'ahora' ya paso la mitad: el llamador recorre la base y vuelve
+    // a agregar las reservas vivas
+    bool debeRecorrer(time_t ahora) const {
+        return (int64_t)ahora / CUBETA_SEGUNDOS - base >= totalCubetas / 2;
+    }
+
+    void recorrer(time_t ahora) {
+        base = (int64_t)ahora / CUBETA_SEGUNDOS;
+        fill(maximo.begin(), maximo.end(), 0);
+        fill(pendiente.begin(), pendiente.end(), 0);
+    }
+};
+
+// ==================== HUECOS ENTRE RESERVAS ====================
+// Cada cajon queda partido por sus reservas en huecos [desde, hasta): antes
+// de la primera, entre dos seguidas y despues de la ultima (un cajon sin
+// reservas es un solo hueco sin limites). Una reserva [inicio, fin) cabe en
+// el cajon si y solo si uno de sus huecos tiene desde <= inicio y
+// hasta >= fin.
+//
+// Los huecos de todos los cajones van en un treap ordenado por (desde,
+// lugar) donde cada nodo guarda el mayor 'hasta' de su subarbol, y aparte
+// el mayor de los cajones libres ahora. Con eso buscar() baja un solo
+// camino: O(log huecos), y hay tantos huecos como cajones mas reservas.
+class IndiceHuecos {
+public:
+    static constexpr time_t SIN_LIMITE_ANTES = numeric_limits<time_t>::min();
+    static constexpr time_t SIN_LIMITE_DESPUES = numeric_limits<time_t>::max();
+
+private:
+    struct Nodo {
+        time_t desde;
+        time_t hasta;
+        int lugar;
+        bool libre;          // el cajon esta libre ahora (ver ReservasLugares::marcarLibre)
+        uint32_t prioridad;
+        int izq, der;
+        time_t mayorHasta;       // en el subarbol
+        time_t mayorHastaLibre;  // en el subarbol, solo cajones libres
+    };
+
+    vector<Nodo> nodos;
+    vector<int> sueltos;  // nodos borrados que se reusan
+    int raiz;
+    uint32_t semilla;
+
+    bool antes(const Nodo& n, time_t desde, int lugar) const {
+        return n.desde < desde || (n.desde == desde && n.lugar < lugar);
+    }
+
+    time_t mayor(int n, bool soloLibres) const {
+        if (n < 0) return SIN_LIMITE_ANTES;
+        return soloLibres ? nodos[n].mayorHastaLibre : nodos[n].mayorHasta;
+    }
+
+    void actualizar(int n) {
+        Nodo& x = nodos[n];
+        x.mayorHasta = max(x.hasta, max(mayor(x.izq, false), mayor(x.der, false)));
+        x.mayorHastaLibre = max(x.libre ? x.hasta : SIN_LIMITE_ANTES, max(mayor(x.izq, true), mayor(x.der, true)));
+    }
+
+    // Parte el arbol en los nodos antes de (desde, lugar) y el resto
+    void partir(int n, time_t desde, int lugar, int& izq, int& der) {
+        if (n < 0) {
+            izq = der = -1;
+            return;
+        }
+        if (antes(nodos[n], desde, lugar)) {
+            partir(nodos[n].der, desde, lugar, nodos[n].der, der);
+            izq = n;
+        } else {
+            partir(nodos[n].izq, desde, lugar, izq, nodos[n].izq);
+            der = n;
+        }
+        actualizar(n);
+    }
+
+    // Todos los nodos de 'izq' van antes que los de 'der'
+    int unir(int izq, int der) {
+        if (izq < 0) return der;
+        if (der < 0) return izq;
+        if (nodos[izq].prioridad > nodos[der].prioridad) {
+            nodos[izq].der = unir(nodos[izq].der, der);
+            actualizar(izq);
+            return izq;
+        }
+        nodos[der].izq = unir(izq, nodos[der].izq);
+        actualizar(der);
+        return der;
+    }
+
+    // El primer nodo en orden con desde <= inicio y hasta >= fin. En un
+    // nodo con desde <= inicio todo su subarbol izquierdo cumple lo primero,
+    // asi que su mayor 'hasta' dice si ahi hay uno: solo se baja por un
+    // camino y, si acaso, por un subarbol donde seguro esta.
+    int primero(int n, time_t inicio, time_t fin, bool soloLibres) const {
+        if (n < 0 || mayor(n, soloLibres) < fin) return -1;
+        const Nodo& x = nodos[n];
+        int encontrado = primero(x.izq, inicio, fin, soloLibres);
+        if (encontrado >= 0 || x.desde > inicio) return encontrado;
+        if (x.hasta >= fin && (!soloLibres || x.libre)) return n;
+        return primero(x.der, inicio, fin, soloLibres);
+    }
+
+public:
+    IndiceHuecos() : raiz(-1), semilla(2463534242u) {}
+
+    void insertar(time_t desde, time_t hasta, int lugar, bool libre) {
+        semilla ^= semilla << 13;
+        semilla ^= semilla >> 17;
+        semilla ^= semilla << 5;
+        Nodo nuevo = {desde, hasta, lugar, libre, semilla, -1, -1, 0, 0};
+        int n;
+        if (sueltos.empty()) {
+            n = (int)nodos.size();
+            nodos.push_back(nuevo);
+        } else {
+            n = sueltos.back();
+            sueltos.pop_back();
+            nodos[n] = nuevo;
+        }
+        actualizar(n);
+        int izq, der;
+        partir(raiz, desde, lugar, izq, der);
+        raiz = unir(unir(izq, n), der);
+    }
+
+    // Quita el hueco del cajon que empieza en 'desde'
+    void quitar(time_t desde, int lugar) {
+        int izq, medio, der;
+        partir(raiz, desde, lugar, izq, medio);
+        partir(medio, desde, lugar + 1, medio, der);
+        if (medio >= 0) sueltos.push_back(medio);
+        raiz = unir(izq, der);
+    }
+
+    // Cajon con un hueco que cubre [inicio, fin), el de menor 'desde' (y
+    // menor numero); solo cajones libres ahora si 'soloLibres'. 0 si no hay.
+    int buscar(time_t inicio, time_t fin, bool soloLibres) const {
+        int n = primero(raiz, inicio, fin, soloLibres);
+        return n < 0 ? 0 : nodos[n].lugar;
+    }
+};
+
+// ==================== RESERVAS POR LUGAR ====================
+// Reservas [inicio, fin) de un cajon con numero 1..capacidad. Las de un
+// mismo cajon no se enciman, asi que basta un mapa ordenado por inicio por
+// cajon: la anterior y la siguiente de un intervalo dicen si choca, en
+// O(log n). Para elegir cajon, los huecos entre reservas de todos van en un
+// IndiceHuecos, asi que reservar tampoco recorre cajones. El total por hora
+// va en un CalendarioReservas para contestar "cuantos lugares quedan libres
+// de 17:00 a 19:00" sin recorrer nada.
+//
+// Una reserva que empieza pronto se aparta de inmediato, asi que necesita
+// un cajon que ademas este libre ahora. Eso lo sabe el motor: el llamador
+// avisa con marcarLibre() y marcarOcupado() los cajones que cambian (ver
+// Estacionamiento::tomarCambiosDisponibles); sin avisos, todos cuentan
+// como libres. Las reservas de cajones sin auto van ademas en su propio
+// calendario, para admitir a quien llega sin reserva sin contar dos veces
+// un cajon ocupado que tiene una reserva despues.
+//
+// El cajon se aparta (entrada() ya no lo asigna a quien llega sin reserva)
+// ANTICIPACION_SEGUNDOS antes del inicio; si el cliente no llega en
+// TOLERANCIA_SEGUNDOS despues del inicio, la reserva vence. avanzar() saca
+// esos cambios de una cola por hora y el llamador los aplica al motor.
+class ReservasLugares {
+public:
+    static const time_t ANTICIPACION_SEGUNDOS = 30 * 60;
+    static const time_t TOLERANCIA_SEGUNDOS = 15 * 60;
+    static const time_t HORIZONTE_SEGUNDOS = 14 * 24 * 3600;
+
+    struct Reserva {
+        uint32_t id;
+        int lugar;
+        time_t inicio;
+        time_t fin;
+        string placa;
+        bool apartada;  // su cajon ya no se asigna a otros
+    };
+
+    // Cambio que avanzar() pide aplicar al cajon de una reserva
+    struct Cambio {
+        uint32_t id;
+        int lugar;
+        bool apartar;  // false: vencio sin llegar, se libera
+    };
+
+private:
+    enum TipoEvento { EVENTO_APARTAR, EVENTO_VENCER };
+
+    struct Evento {
+        time_t t;
+        uint32_t id;
+        int tipo;
+
+        bool operator>(const Evento& otro) const {
+            return t > otro.t || (t == otro.t && id > otro.id);
+        }
+    };
+
+    vector<map<time_t, uint32_t>> porLugar;  // indice 0: lugar 1; inicio -> id
+    vector<bool> libreAhora;                  // indice 0: lugar 1
+    vector<bool> ocupadoAhora;                // indice 0: lugar 1
+    IndiceHuecos huecos;
+    unordered_map<uint32_t, Reserva> reservas;
+    priority_queue<Evento, vector<Evento>, greater<Evento>> eventos;
+    CalendarioReservas calendario;
+    CalendarioReservas calendarioSinAuto;  // solo las de cajones no ocupados
+    uint32_t siguienteId;
+
+    bool choca(int lugar, time_t inicio, time_t fin) const {
+        const map<time_t, uint32_t>& agenda = porLugar[lugar - 1];
+        auto siguiente = agenda.lower_bound(inicio);
+        if (siguiente != agenda.end() && siguiente->first < fin) return true;
+        if (siguiente == agenda.begin()) return false;
+        --siguiente;
+        return reservas.at(siguiente->second).fin > inicio;
+    }
+
+    // Hueco del cajon donde cae 'inicio', sin contar una reserva que empiece
+    // justo ahi: fin de la anterior y comienzo de la siguiente
+    void huecoDe(int lugar, time_t inicio, time_t& desde, time_t& hasta) const {
+        const map<time_t, uint32_t>& agenda = porLugar[lugar - 1];
+        auto siguiente = agenda.upper_bound(inicio);
+        hasta = siguiente == agenda.end() ? IndiceHuecos::SIN_LIMITE_DESPUES : siguiente->first;
+        auto anterior = agenda.lower_bound(inicio);
+        if (anterior == agenda.begin()) {
+            desde = IndiceHuecos::SIN_LIMITE_ANTES;
+        } else {
+            --anterior;
+            desde = reservas.at(anterior->second).fin;
+        }
+    }
+
+    // La reserva entra a la agenda de r.lugar y parte su hueco en dos
+    void asignarCajon(const Reserva& r) {
+        time_t desde, hasta;
+        huecoDe(r.lugar, r.inicio, desde, hasta);
+        bool libre = libreAhora[r.lugar - 1];
+        huecos.quitar(desde, r.lugar);
+        huecos.insertar(desde, r.inicio, r.lugar, libre);
+        huecos.insertar(r.fin, hasta, r.lugar, libre);
+        porLugar[r.lugar - 1][r.inicio] = r.id;
+        if (!ocupadoAhora[r.lugar - 1]) calendarioSinAuto.agregar(r.inicio, r.fin);
+    }
+
+    // Lo contrario: sale de la agenda y sus dos huecos vuelven a ser uno
+    void soltarCajon(const Reserva& r) {
+        porLugar[r.lugar - 1].erase(r.inicio);
+        if (!ocupadoAhora[r.lugar - 1]) calendarioSinAuto.quitar(r.inicio, r.fin);
+        time_t desde, hasta;
+        huecoDe(r.lugar, r.inicio, desde, hasta);
+        huecos.quitar(desde, r.lugar);
+        huecos.quitar(r.fin, r.lugar);
+        huecos.insertar(desde, hasta, r.lugar, libreAhora[r.lugar - 1]);
+    }
+
+    void programar(const Reserva& r) {
+        eventos.push({r.inicio - ANTICIPACION_SEGUNDOS, r.id, EVENTO_APARTAR});
+        eventos.push({r.inicio + TOLERANCIA_SEGUNDOS, r.id, EVENTO_VENCER});
+    }
+
+    void borrar(unordered_map<uint32_t, Reserva>::iterator it) {
+        const Reserva& r = it->second;
+        soltarCajon(r);
+        calendario.quitar(r.inicio, r.fin);
+        reservas.erase(it);
+    }
+
+    void recorrerCalendario(time_t ahora) {
+        calendario.recorrer(ahora);
+        calendarioSinAuto.recorrer(ahora);
+        for (const auto& par : reservas) {
+            const Reserva& r = par.second;
+            calendario.agregar(r.inicio, r.fin);
+            if (!ocupadoAhora[r.lugar - 1]) calendarioSinAuto.agregar(r.inicio, r.fin);
+        }
+    }
+
+public:
+    ReservasLugares(int capacidad, time_t ahora)
+        : calendario(HORIZONTE_SEGUNDOS, ahora), calendarioSinAuto(HORIZONTE_SEGUNDOS, ahora), siguienteId(1) {
+        ampliar(capacidad);
+    }
+
+    int capacidad() const {
+        return (int)porLugar.size();
+    }
+
+    // Cajones nuevos al final (lote ampliado), sin reservas
+    void ampliar(int capacidad) {
+        for (int lugar = (int)porLugar.size() + 1; lugar <= capacidad; lugar++) {
+            huecos.insertar(IndiceHuecos::SIN_LIMITE_ANTES, IndiceHuecos::SIN_LIMITE_DESPUES, lugar, true);
+        }
+        if (capacidad > (int)porLugar.size()) {
+            porLugar.resize(capacidad);
+            libreAhora.resize(capacidad, true);
+            ocupadoAhora.resize(capacidad, false);
+        }
+    }
+
+    // Si el cajon esta libre y sin apartar en el motor; solo importa a las
+    // reservas que empiezan pronto. O(log n) por cada reserva del cajon.
+    void marcarLibre(int lugar, bool libre) {
+        if (lugar < 1 || lugar > capacidad() || libreAhora[lugar - 1] == libre) return;
+        libreAhora[lugar - 1] = libre;
+        time_t desde = IndiceHuecos::SIN_LIMITE_ANTES;
+        for (const auto& par : porLugar[lugar - 1]) {
+            huecos.quitar(desde, lugar);
+            huecos.insertar(desde, par.first, lugar, libre);
+            desde = reservas.at(par.second).fin;
+        }
+        huecos.quitar(desde, lugar);
+        huecos.insertar(desde, IndiceHuecos::SIN_LIMITE_DESPUES, lugar, libre);
+    }
+
+    // Si el cajon tiene auto; sus reservas salen o vuelven a calendarioSinAuto
+    void marcarOcupado(int lugar, bool ocupado) {
+        if (lugar < 1 || lugar > capacidad() || ocupadoAhora[lugar - 1] == ocupado) return;
+        ocupadoAhora[lugar - 1] = ocupado;
+        for (const auto& par : porLugar[lugar - 1]) {
+            calendarioSinAuto.agregar(par.first, reservas.at(par.second).fin, ocupado ? -1 : 1);
+        }
+    }
+
+    // Reserva un cajon sin otra reserva en [inicio, fin); si empieza antes
+    // de ANTICIPACION_SEGUNDOS se aparta enseguida, asi que ademas debe estar
+    // libre ahora (marcarLibre). O(log n). Regresa el id, o 0 si el
+    // intervalo no es valido o no hay cajon.
+    uint32_t reservar(time_t inicio, time_t fin, const string& placa, time_t ahora, int& lugar) {
+        lugar = 0;
+        if (fin <= inicio || fin <= ahora || fin > ahora + HORIZONTE_SEGUNDOS) return 0;
+        if (inicio < ahora) inicio = ahora;
+        if (calendario.debeRecorrer(ahora)) recorrerCalendario(ahora);
+        lugar = huecos.buscar(inicio, fin, inicio < ahora + ANTICIPACION_SEGUNDOS);
+        if (lugar == 0) return 0;
+        Reserva r = {siguienteId++, lugar, inicio, fin, placa, false};
+        asignarCajon(r);
+        calendario.agregar(inicio, fin);
+        programar(r);
+        reservas[r.id] = r;
+        return r.id;
+    }
+
+    // Pasa la reserva a otro cajon sin choque y libre ahora, p. ej. cuando
+    // su cajon sigue ocupado al apartarlo. Su propio cajon nunca sale: la
+    // reserva misma le quita el hueco.
+    bool reubicar(uint32_t id, int& lugarNuevo) {
+        lugarNuevo = 0;
+        auto it = reservas.find(id);
+        if (it == reservas.end()) return false;
+        Reserva& r = it->second;
+        lugarNuevo = huecos.buscar(r.inicio, r.fin, true);
+        if (lugarNuevo == 0) return false;
+        soltarCajon(r);
+        r.lugar = lugarNuevo;
+        asignarCajon(r);
+        return true;
+    }
+
+    // false si no existe
+    bool buscar(uint32_t id, Reserva& resultado) const {
+        auto it = reservas.find(id);
+        if (it == reservas.end()) return false;
+        resultado = it->second;
+        return true;
+    }
+
+    // Cancelacion o llegada del cliente: la reserva deja de existir y el
+    // llamador libera (o le da) el cajon. Regresa la reserva quitada.
+    bool quitar(uint32_t id, Reserva& quitada) {
+        auto it = reservas.find(id);
+        if (it == reservas.end()) return false;
+        quitada = it->second;
+        borrar(it);
+        return true;
+    }
+
+    // true si el cajon no tiene reservas que toquen [desde, hasta)
+    bool libre(int lugar, time_t desde, time_t hasta) const {
+        return lugar >= 1 && lugar <= capacidad() && !choca(lugar, desde, hasta);
+    }
+
+    // Lo mas que habra reservado a la vez en [desde, hasta), por cubetas
+    int reservadosEn(time_t desde, time_t hasta) const {
+        return calendario.maximoEn(desde, hasta);
+    }
+
+    // Cajones sin reserva durante toda la ventana
+    int disponiblesEn(time_t desde, time_t hasta) const {
+        return capacidad() - reservadosEn(desde, hasta);
+    }
+
+    // Quien llega sin reserva cabe si, contandolo a el y a los 'ocupados' de
+    // ahora, siguen cabiendo las reservas de [ahora, ahora + estancia). Las
+    // de un cajon ocupado no se suman: ese cajon ya cuenta por su auto.
+    bool admiteSinReserva(int ocupados, time_t ahora, time_t estancia) const {
+        return ocupados + 1 + calendarioSinAuto.maximoEn(ahora, ahora + estancia) <= capacidad();
+    }
+
+    // Aplica los eventos vencidos hasta 'ahora' y agrega a 'cambios' los
+    // cajones que hay que apartar o liberar en el motor
+    void avanzar(time_t ahora, vector<Cambio>& cambios) {
+        while (!eventos.empty() && eventos.top().t <= ahora) {
+            Evento e = eventos.top();
+            eventos.pop();
+            auto it = reservas.find(e.id);
+            if (it == reservas.end()) continue;  // ya se cancelo o llego
+            if (e.tipo == EVENTO_APARTAR) {
+                it->second.apartada = true;
+                cambios.push_back({e.id, it->second.lugar, true});
+            } else {
+                if (it->second.apartada) cambios.push_back({e.id, it->second.lugar, false});
+                borrar(it);
+            }
+        }
+        if (calendario.debeRecorrer(ahora)) recorrerCalendario(ahora);
+    }
+
+    size_t total() const {
+        return reservas.size();
+    }
+};
+
+#endif
@@ -0,0 +1,288 @@
+#ifndef SERIAL_CONTROLLER_H
+#define SERIAL_CONTROLLER_H
+
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <poll.h>
+#endif
+
+using namespace std;
+
+// ==================== SERIAL CONTROLLER ====================
+// Donde suele aparecer el Arduino, en el orden en que se prueban cuando la
+// configuracion no dice otros puertos (ver configuracionLote.h)
+inline vector<string> puertosPorOmision() {
+#ifdef _WIN32
+    return {"COM3", "COM4", "COM5", "COM6", "COM7", "COM8"};
+#else
+    return {"/dev/ttyACM0", "/dev/ttyACM1", "/dev/ttyUSB0", "/dev/ttyUSB1"};
+#endif
+}
+
+#ifdef _WIN32
+class SerialController {
+private:
+    HANDLE hSerial;
+    bool connected;
+    string accion;
+    bool newDataAvailable;
+
+public:
+    SerialController() : hSerial(INVALID_HANDLE_VALUE), connected(false), newDataAvailable(false) {}
+
+    // noBloqueante: ReadFile regresa de inmediato con lo que haya en el buffer
+    // (lo usa el servidor, que atiende sockets en el mismo ciclo)
+    bool connect(const char* portName, bool noBloqueante = false, int baudios = 9600) {
+        disconnect();
+        hSerial = CreateFileA(portName, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (hSerial == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+
+        DCB dcbSerialParams = {0};
+        dcbSerialParams.DCBlength = sizeof(dcbSerialParams);
+        if (!GetCommState(hSerial, &dcbSerialParams)) {
+            CloseHandle(hSerial);
+            return false;
+        }
+
+        dcbSerialParams.BaudRate = (DWORD)baudios;
+        dcbSerialParams.ByteSize = 8;
+        dcbSerialParams.StopBits = ONESTOPBIT;
+        dcbSerialParams.Parity = NOPARITY;
+
+        if (!SetCommState(hSerial, &dcbSerialParams)) {
+            CloseHandle(hSerial);
+            return false;
+        }
+
+        COMMTIMEOUTS timeouts = {0};
+        if (noBloqueante) {
+            timeouts.ReadIntervalTimeout = MAXDWORD;
+            timeouts.ReadTotalTimeoutConstant = 0;
+            timeouts.ReadTotalTimeoutMultiplier = 0;
+        } else {
+            timeouts.ReadIntervalTimeout = 50;
+            timeouts.ReadTotalTimeoutConstant = 50;
+            timeouts.ReadTotalTimeoutMultiplier = 10;
+        }
+        timeouts.WriteTotalTimeoutConstant = 50;
+        timeouts.WriteTotalTimeoutMultiplier = 10;
+
+        if (!SetCommTimeouts(hSerial, &timeouts)) {
+            CloseHandle(hSerial);
+            return false;
+        }
+
+        connected = true;
+        clearSerialBuffer();
+        return true;
+    }
+
+    // Cierra el puerto (para volver a conectar con otro puerto o velocidad)
+    void disconnect() {
+        if (connected) {
+            CloseHandle(hSerial);
+        }
+        hSerial = INVALID_HANDLE_VALUE;
+        connected = false;
+    }
+
+    void clearSerialBuffer() {
+        if (!connected) return;
+        DWORD errors;
+        COMSTAT comStat;
+        ClearCommError(hSerial, &errors, &comStat);
+        if (comStat.cbInQue > 0) {
+            vector<char> tmp(comStat.cbInQue + 1);
+            DWORD read;
+            ReadFile(hSerial, tmp.data(), tmp.size() - 1, &read, NULL);
+        }
+    }
+
+    bool sendData(const string& data) {
+        if (!connected) return false;
+        DWORD bytesWritten;
+        string dataWithNewline = data + "\n";
+        return WriteFile(hSerial, dataWithNewline.c_str(), dataWithNewline.length(), &bytesWritten, NULL);
+    }
+
+    bool hasNewData() {
+        if (!connected) return false;
+        
+        char buffer[256];
+        DWORD bytesRead;
+        if (ReadFile(hSerial, buffer, sizeof(buffer) - 1, &bytesRead, NULL) && bytesRead > 0) {
+            buffer[bytesRead] = '\0';
+            accion = buffer;
+            // Limpiar saltos de línea
+            while (!accion.empty() && (accion.back() == '\r' || accion.back() == '\n')) {
+                accion.pop_back();
+            }
+            newDataAvailable = true;
+            return true;
+        }
+        return false;
+    }
+
+    // Lectura cruda: copia hasta 'maximo' bytes sin interpretar lineas
+    int leerBytes(char* destino, int maximo) {
+        if (!connected) return 0;
+        DWORD bytesRead = 0;
+        if (!ReadFile(hSerial, destino, maximo, &bytesRead, NULL)) return 0;
+        return (int)bytesRead;
+    }
+
+    bool isConnected() const {
+        return connected;
+    }
+
+    string getLastData() {
+        newDataAvailable = false;
+        return accion;
+    }
+
+    ~SerialController() {
+        disconnect();
+    }
+};
+
+#else
+// Misma interfaz sobre termios: Arduino por USB (/dev/ttyACM*) o el pty
+// del simulador de simuladorArduino/
+class SerialController {
+private:
+    int fd;
+    bool connected;
+    string accion;
+    bool newDataAvailable;
+    bool noBloqueante;
+
+    // Equivalente a los timeouts de 50 ms de la version Windows
+    bool esperarDatos() {
+        if (noBloqueante) return true;
+        pollfd p = {fd, POLLIN, 0};
+        return poll(&p, 1, 50) > 0;
+    }
+
+    // Las velocidades que acepta termios; 0 si no es una de ellas
+    static speed_t velocidad(int baudios) {
+        switch (baudios) {
+            case 1200: return B1200;
+            case 2400: return B2400;
+            case 4800: return B4800;
+            case 9600: return B9600;
+            case 19200: return B19200;
+            case 38400: return B38400;
+            case 57600: return B57600;
+            case 115200: return B115200;
+            default: return 0;
+        }
+    }
+
+public:
+    SerialController() : fd(-1), connected(false), newDataAvailable(false), noBloqueante(false) {}
+
+    bool connect(const char* portName, bool sinBloqueo = false, int baudios = 9600) {
+        disconnect();
+        speed_t vel = velocidad(baudios);
+        if (vel == 0) {
+            return false;
+        }
+        fd = open(portName, O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if (fd < 0) {
+            return false;
+        }
+
+        termios opciones;
+        if (tcgetattr(fd, &opciones) != 0) {
+            close(fd);
+            fd = -1;
+            return false;
+        }
+        cfmakeraw(&opciones);
+        cfsetispeed(&opciones, vel);
+        cfsetospeed(&opciones, vel);
+        opciones.c_cflag |= CLOCAL | CREAD;
+        opciones.c_cc[VMIN] = 0;
+        opciones.c_cc[VTIME] = 0;
+        if (tcsetattr(fd, TCSANOW, &opciones) != 0) {
+            close(fd);
+            fd = -1;
+            return false;
+        }
+
+        noBloqueante = sinBloqueo;
+        connected = true;
+        clearSerialBuffer();
+        return true;
+    }
+
+    // Cierra el puerto (para volver a conectar con otro puerto o velocidad)
+    void disconnect() {
+        if (connected) {
+            close(fd);
+        }
+        fd = -1;
+        connected = false;
+    }
+
+    void clearSerialBuffer() {
+        if (!connected) return;
+        tcflush(fd, TCIFLUSH);
+    }
+
+    bool sendData(const string& data) {
+        if (!connected) return false;
+        string dataWithNewline = data + "\n";
+        return write(fd, dataWithNewline.c_str(), dataWithNewline.length()) == (ssize_t)dataWithNewline.length();
+    }
+
+    bool hasNewData() {
+        if (!connected || !esperarDatos()) return false;
+
+        char buffer[256];
+        ssize_t bytesRead = read(fd, buffer, sizeof(buffer) - 1);
+        if (bytesRead > 0) {
+            buffer[bytesRead] = '\0';
+            accion = buffer;
+            // Limpiar saltos de línea
+            while (!accion.empty() && (accion.back() == '\r' || accion.back() == '\n')) {
+                accion.pop_back();
+            }
+            newDataAvailable = true;
+            return true;
+        }
+        return false;
+    }
+
+    // Lectura cruda: copia hasta 'maximo' bytes sin interpretar lineas
+    int leerBytes(char* destino, int maximo) {
+        if (!connected || !esperarDatos()) return 0;
+        ssize_t bytesRead = read(fd, destino, maximo);
+        return bytesRead > 0 ? (int)bytesRead : 0;
+    }
+
+    bool isConnected() const {
+        return connected;
+    }
+
+    string getLastData() {
+        newDataAvailable = false;
+        return accion;
+    }
+
+    ~SerialController() {
+        disconnect();
+    }
+};
+#endif
+
+#endif
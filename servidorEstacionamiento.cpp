@@ -0,0 +1,1188 @@
+// servidorEstacionamiento.cpp
+// Modo servidor (sin consola) del sistema de estacionamiento.
+// Atiende las plumas por el puerto serial y expone el estado por un socket
+// local (AF_UNIX) para letreros, cajeros y monitoreo, sin raspar la pantalla.
+// Compatibilidad: Windows 10+ (AF_UNIX de Winsock) y sistemas POSIX.
+//
+// Protocolo: una linea por peticion, una linea por respuesta.
+//   entrada [placa] [zona=<zona>] [preferente] -> ok <lugar> <ticket> | error lleno
+//                           zona ("A" o "P1-A", ver --niveles) y preferente los usan las
+//                           politicas zonas y preferentes (ver --politica)
+//   salida <ticket>      -> ok <cobro> <ticket>         | error no_encontrado | error mal_escrito
+//   consulta <ticket>    -> ok <lugar> <horaEntrada> <ticket> | error no_encontrado | error mal_escrito
+//                           <ticket>: el folio completo o solo el final impreso ("00059"); los
+//                           digitos verificadores se revisan antes de buscar (ver folioTicket.h) y
+//                           la respuesta trae el folio completo
+//   ocupacion            -> ok <ocupados> <capacidad> <version>
+//   tickets              -> ok <n> <ticket>:<lugar> ...
+//   discrepancias        -> ok <n> auto_sin_ticket:<lugar> | ticket_sin_auto:<lugar> ...
+//   latencias            -> ok <n> <carril>.<etapa> <muestras> <p50> <p90> <p99> <max> ...  (us)
+//   metricas             -> ok <n>, seguido de n lineas en formato de texto de Prometheus
+//   analitica            -> ok <estancias> <promedio> <p50> <p90> <p99> <hora_pico> <ocupacion_pico> <rotacion_24h>
+//                           (estancias en s; hora_pico: inicio de la hora con mas ocupacion
+//                           promedio de la ultima semana, 0 sin datos; rotacion: entradas por lugar)
+//   utilizacion          -> ok <n> <lugar>:<porcentaje> ...  (del tiempo desde que arranco)
+//   placa <ticket> <placa> -> ok                        | error no_encontrado | error mal_escrito
+//                           (placa de un ticket activo, p. ej. de una entrada por sensor)
+//   buscar_placa <texto> -> ok <n> <ticket>:<placa>:<lugar> ...  (lugar 0: ya salio)
+//                           exacta; si no hay, por prefijo; si no, con un caracter equivocado
+//   entradas <desde> <hasta> -> ok <n> <ticket>:<placa>:<lugar>:<horaEntrada> ...
+//                           tickets que entraron en [desde, hasta) (epoch), en orden de hora
+//   estancias_largas <horas> -> ok <n> <ticket>:<placa>:<lugar>:<horaEntrada> ...
+//                           autos que siguen dentro desde hace mas de <horas>, el mas antiguo primero
+//                           (las dos: a lo mas 100 resultados)
+//   exportar <prefijo> [comprimido] -> ok <filas>        | error archivo
+//                           historial a <prefijo>.csv y .tkc, resumen por dia a <prefijo>_diario.*
+//                           (ver exportacionHistorial.h; comprimido: bloques zlib si se compilo con ella)
+//   reservar <inicio> <fin> [placa] -> ok <id> <lugar>  | error sin_lugar
+//                           cajon sin otra reserva en [inicio, fin) (epoch, a lo mas 14 dias);
+//                           se aparta 30 min antes y vence si no llega 15 min despues del inicio
+//   cancelar_reserva <id> -> ok                         | error no_encontrado
+//   llegada <id>         -> ok <lugar> <ticket>         | error no_encontrado | error lleno
+//                           entrada en el cajon de la reserva (en otro libre si sigue ocupado)
+//   disponibilidad <desde> <hasta> -> ok <libres> <reservados>
+//                           cajones sin reserva durante toda la ventana y lo mas reservado a la
+//                           vez, por cubetas de 15 min (ver reservasLugares.h)
+//   letreros             -> ok <n> <ruta>:<disponibles>:<capacidad> ...
+//                           sitio, niveles y zonas (ruta "sitio/P1/A"); disponibles: libres
+//                           y sin apartar por una reserva
+//   configuracion        -> ok <recargas> <tarifa_hora> <minutos_gratis> <capacidad> <politica> <baudios> <puerto>
+//                           la configuracion vigente (puerto "-": sin serial)
+//   recargar             -> ok <recargas>                | error <motivo>
+//                           vuelve a leer --config sin esperar a que cambie
+//   suscribir            -> ok   (despues llegan lineas "evento ...")
+// Eventos: "evento entrada <lugar> <ticket>", "evento salida <ticket> <cobro>",
+//          "evento espera_salida", "evento ocupacion <ocupados> <capacidad> <version>",
+//          "evento auto_sin_ticket <lugar>", "evento ticket_sin_auto <lugar>"
+//          (al cambiar el sensor de un cajon, ver conciliarSensores),
+//          "evento reserva_apartada <id> <lugar>", "evento reserva_vencida <id> <lugar>",
+//          "evento letrero <ruta> <disponibles> <capacidad>" (a lo mas uno por nodo y
+//          ciclo de ESPERA_CICLO_MS, solo de los nodos que cambiaron),
+//          "evento configuracion <recargas> <tarifa_hora> <capacidad>" al aplicar --config
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <afunix.h>
+#pragma comment(lib, "ws2_32.lib")
+typedef SOCKET Socket;
+#define SOCKET_INVALIDO INVALID_SOCKET
+#define FLAGS_ENVIO 0
+#else
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+typedef int Socket;
+#define SOCKET_INVALIDO (-1)
+#define FLAGS_ENVIO MSG_NOSIGNAL
+#endif
+
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <csignal>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <unordered_map>
+
+#include "serialController.h"
+#include "estacionamiento.h"
+#include "protocoloMega.h"
+#include "histogramaLatencia.h"
+#include "trazaSerial.h"
+#include "metricas.h"
+#include "analiticaOcupacion.h"
+#include "historialTickets.h"
+#include "reservasLugares.h"
+#include "configuracionLote.h"
+
+using namespace std;
+
+// Limites por cliente: una linea de peticion y lo pendiente por enviar.
+// Un suscriptor que no lee se desconecta en vez de crecer sin limite.
+const size_t MAX_LINEA_CLIENTE = 1024;
+const size_t MAX_PENDIENTE_CLIENTE = 256 * 1024;
+const int ESPERA_CICLO_MS = 10;
+const uint64_t PERIODO_METRICAS_US = 5000000;
+const uint64_t PERIODO_CONFIGURACION_US = 1000000;
+
+volatile sig_atomic_t servidorActivo = 1;
+
+// Latencia sensor -> pluma por carril, medida en la PC:
+//   recepcion  primer byte del codigo (40/30) -> linea completa
+//   decision   linea completa -> entrada()/salida() resueltas
+//              (en la salida incluye la espera del ticket en el cajero)
+//   respuesta  decision -> codigo 1/2 escrito en el puerto
+//   pluma      respuesta -> "P<carril>" del MEGA: la pluma empezo a moverse
+//   total      primer byte -> "P<carril>"
+enum Carril { CARRIL_ENTRADA, CARRIL_SALIDA, TOTAL_CARRILES };
+enum Etapa { ETAPA_RECEPCION, ETAPA_DECISION, ETAPA_RESPUESTA, ETAPA_PLUMA, ETAPA_TOTAL, TOTAL_ETAPAS };
+const char* NOMBRES_CARRIL[TOTAL_CARRILES] = {"entrada", "salida"};
+const char* NOMBRES_ETAPA[TOTAL_ETAPAS] = {"recepcion", "decision", "respuesta", "pluma", "total"};
+
+void detenerServidor(int) {
+    servidorActivo = 0;
+}
+
+// --------------------------- Sockets portables ------------------------------
+void cerrarSocket(Socket s) {
+#ifdef _WIN32
+    closesocket(s);
+#else
+    close(s);
+#endif
+}
+
+bool ponerNoBloqueante(Socket s) {
+#ifdef _WIN32
+    u_long modo = 1;
+    return ioctlsocket(s, FIONBIO, &modo) == 0;
+#else
+    int flags = fcntl(s, F_GETFL, 0);
+    return flags != -1 && fcntl(s, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+bool operacionPendiente() {
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+int esperarEventos(vector<pollfd>& fds, int milisegundos) {
+#ifdef _WIN32
+    return WSAPoll(fds.data(), (ULONG)fds.size(), milisegundos);
+#else
+    return poll(fds.data(), fds.size(), milisegundos);
+#endif
+}
+
+// --------------------------- Puerto serial ------------------------------
+// El primero de 'puertos' que abre, sin bloqueo; vacio si ninguno
+string conectarSerial(SerialController& serial, const vector<string>& puertos, int baudios) {
+    serial.disconnect();
+    for (const string& puerto : puertos) {
+        if (serial.connect(puerto.c_str(), true, baudios)) return puerto;
+    }
+    return "";
+}
+
+// --------------------------- Metricas ------------------------------
+// Contadores en el camino de cada operacion; los medidores (ocupacion,
+// clientes, colas) se calculan solo al exportar
+struct MetricasServidor {
+    RegistroMetricas registro;
+    Metrica& entradas;
+    Metrica& rechazosLleno;
+    Metrica& rechazosReserva;
+    Metrica& salidas;
+    Metrica& salidasGratis;
+    Metrica& ticketsMalEscritos;
+    Metrica& ingresosCentavos;
+    Metrica& serialBytesRecibidos;
+    Metrica& serialBytesEnviados;
+    Metrica& serialTramasRecibidas;
+    Metrica& serialTramasEnviadas;
+    Metrica& serialErrores;
+    Metrica& serialDesconocidas;
+    Metrica& clientesConexiones;
+    Metrica& recargasConfiguracion;
+    Metrica& erroresConfiguracion;
+    Metrica& lugaresOcupados;
+    Metrica& lugaresCapacidad;
+    Metrica& ticketsEmitidos;
+    Metrica& clientesConectados;
+    Metrica& clientesPendienteBytes;
+    Metrica& salidaPendiente;
+    Metrica& serialConectado;
+
+    MetricasServidor()
+        : entradas(registro.contador("estacionamiento_entradas_total", "Tickets emitidos por sensor o cliente")),
+          rechazosLleno(registro.contador("estacionamiento_rechazos_lleno_total", "Entradas rechazadas por estar lleno")),
+          rechazosReserva(registro.contador("estacionamiento_rechazos_reserva_total", "Entradas sin reserva rechazadas para respetar reservas")),
+          salidas(registro.contador("estacionamiento_salidas_total", "Salidas cobradas")),
+          salidasGratis(registro.contador("estacionamiento_salidas_gratis_total", "Salidas dentro de los minutos gratis")),
+          ticketsMalEscritos(registro.contador("estacionamiento_tickets_mal_escritos_total", "Tickets rechazados por el digito verificador, sin buscarlos")),
+          ingresosCentavos(registro.contador("estacionamiento_ingresos_centavos_total", "Cobrado en centavos")),
+          serialBytesRecibidos(registro.contador("estacionamiento_serial_bytes_recibidos_total", "Bytes leidos del MEGA")),
+          serialBytesEnviados(registro.contador("estacionamiento_serial_bytes_enviados_total", "Bytes escritos al MEGA")),
+          serialTramasRecibidas(registro.contador("estacionamiento_serial_tramas_recibidas_total", "Lineas recibidas del MEGA")),
+          serialTramasEnviadas(registro.contador("estacionamiento_serial_tramas_enviadas_total", "Codigos enviados al MEGA")),
+          serialErrores(registro.contador("estacionamiento_serial_errores_total", "Escrituras fallidas o lineas demasiado largas")),
+          serialDesconocidas(registro.contador("estacionamiento_serial_tramas_desconocidas_total", "Lineas del MEGA sin significado")),
+          clientesConexiones(registro.contador("estacionamiento_clientes_conexiones_total", "Conexiones aceptadas en el socket")),
+          recargasConfiguracion(registro.contador("estacionamiento_configuracion_recargas_total", "Configuraciones aplicadas")),
+          erroresConfiguracion(registro.contador("estacionamiento_configuracion_errores_total", "Configuraciones rechazadas (se quedo la anterior)")),
+          lugaresOcupados(registro.medidor("estacionamiento_lugares_ocupados", "Lugares con ticket")),
+          lugaresCapacidad(registro.medidor("estacionamiento_lugares_capacidad", "Lugares del estacionamiento")),
+          ticketsEmitidos(registro.medidor("estacionamiento_tickets_contador", "Contador de tickets del motor")),
+          clientesConectados(registro.medidor("estacionamiento_clientes_conectados", "Clientes en el socket")),
+          clientesPendienteBytes(registro.medidor("estacionamiento_clientes_pendiente_bytes", "Bytes en cola hacia los clientes")),
+          salidaPendiente(registro.medidor("estacionamiento_salida_pendiente", "1 si un auto espera cobro en la pluma de salida")),
+          serialConectado(registro.medidor("estacionamiento_serial_conectado", "1 si hay puerto serial abierto")) {}
+};
+
+// --------------------------- Servidor local ------------------------------
+class ServidorLocal {
+private:
+    struct Cliente {
+        Socket s;
+        string recibido;    // bytes sin linea completa todavia
+        string pendiente;   // respuestas/eventos por enviar
+        bool suscrito;
+        bool cerrar;
+    };
+
+    Estacionamiento& est;
+    SerialController& serial;
+    Socket escucha;
+    string rutaSocket;
+    vector<Cliente> clientes;
+    vector<pollfd> fds;
+    DecodificadorMega decodificador;  // lineas del MEGA, sin copiar
+    uint64_t inicioLineaSerial;
+    bool salidaPendiente;
+
+    // Marcas del paso en curso de cada carril: byte, trama, decision, respuesta
+    struct MedicionCarril {
+        HistogramaLatencia etapas[TOTAL_ETAPAS];
+        uint64_t marcas[4];
+        int siguiente;  // proxima marca esperada; -1 sin paso en curso
+    };
+    MedicionCarril carriles[TOTAL_CARRILES];
+    GrabadorTraza grabador;
+    MetricasServidor metricas;
+    string rutaMetricas;
+    uint64_t ultimaExportacion;
+    AnaliticaOcupacion analitica;
+    ReservasLugares reservas;
+    vector<ReservasLugares::Cambio> cambiosReservas;
+    vector<int> lugaresCambiados;
+    vector<int> letrerosCambiados;
+    ConfiguracionLote vigente;     // lo aplicado, con todas las claves
+    VigilanteArchivo vigilante;    // --config
+    uint64_t ultimaRevisionConfiguracion;
+    unsigned long recargas;
+    string puertoSerial;           // vacio: sin serial
+
+    HistorialTickets historial;   // activos e historicos, con placa y cobro
+    int lote;                     // columna "lote" de las exportaciones
+    static const size_t MAX_RESULTADOS_PLACA = 20;
+    static const size_t MAX_RESULTADOS_HORA = 100;
+
+    // <ticket>:<placa>:<lugar> (lugar 0: ya salio)
+    string textoRegistro(uint32_t registro) {
+        const HistorialTickets::Registro& r = historial[registro];
+        int lugar = 0;
+        time_t horaEntrada;
+        est.buscarTicket(r.ticketId, lugar, horaEntrada);
+        return r.ticketId + ":" + r.placa + ":" + to_string(lugar);
+    }
+
+    string textoBusquedaPlaca(const string& texto) {
+        vector<uint32_t> encontrados;
+        historial.buscarPlaca(texto, encontrados, MAX_RESULTADOS_PLACA);
+
+        string respuesta = "ok " + to_string(encontrados.size());
+        for (uint32_t i : encontrados) respuesta += " " + textoRegistro(i);
+        return respuesta;
+    }
+
+    // <ticket>:<placa>:<lugar>:<horaEntrada>, en orden de hora
+    string textoPorHora(const vector<uint32_t>& encontrados) {
+        string respuesta = "ok " + to_string(encontrados.size());
+        for (uint32_t i : encontrados) {
+            respuesta += " " + textoRegistro(i) + ":" + to_string((long long)historial[i].horaEntrada);
+        }
+        return respuesta;
+    }
+
+    void enviarSerial(const string& trama) {
+        if (serial.isConnected()) {
+            if (serial.sendData(trama)) {
+                metricas.serialBytesEnviados.sumar(trama.size() + 1);
+                metricas.serialTramasEnviadas.sumar();
+            } else {
+                metricas.serialErrores.sumar();
+            }
+        }
+        grabador.registrar(true, trama);
+    }
+
+    // Medidores: se leen del estado actual justo antes de exportar
+    void actualizarMedidores() {
+        shared_ptr<const Estacionamiento::Instantanea> vista = est.obtenerInstantanea();
+        metricas.lugaresOcupados.fijar(vista->ocupados);
+        metricas.lugaresCapacidad.fijar(vista->lugares.size());
+        metricas.ticketsEmitidos.fijar(vista->contadorTickets);
+        metricas.clientesConectados.fijar(clientes.size());
+        int64_t pendiente = 0;
+        for (const Cliente& c : clientes) pendiente += c.pendiente.size();
+        metricas.clientesPendienteBytes.fijar(pendiente);
+        metricas.salidaPendiente.fijar(salidaPendiente ? 1 : 0);
+        metricas.serialConectado.fijar(serial.isConnected() ? 1 : 0);
+    }
+
+    void exportarMetricas() {
+        if (rutaMetricas.empty()) return;
+        uint64_t ahora = microsegundosAhora();
+        if (ahora - ultimaExportacion < PERIODO_METRICAS_US) return;
+        ultimaExportacion = ahora;
+        actualizarMedidores();
+        if (!metricas.registro.exportarArchivo(rutaMetricas)) {
+            cout << "Error: no se pudieron exportar las metricas a " << rutaMetricas << endl;
+        }
+    }
+
+    void iniciarMedicion(Carril carril, uint64_t recibido, uint64_t completo) {
+        MedicionCarril& m = carriles[carril];
+        m.marcas[0] = recibido;
+        m.marcas[1] = completo;
+        m.siguiente = 2;
+    }
+
+    // Solo avanza en orden, asi una entrada pedida por un cliente no altera
+    // la medicion del sensor que sigue esperando su confirmacion
+    void marcar(Carril carril, int marca) {
+        MedicionCarril& m = carriles[carril];
+        if (m.siguiente == marca) {
+            m.marcas[marca] = microsegundosAhora();
+            m.siguiente++;
+        }
+    }
+
+    void cancelarMedicion(Carril carril) {
+        carriles[carril].siguiente = -1;
+    }
+
+    // Llego "P<carril>": la pluma empezo a moverse
+    void completarMedicion(Carril carril) {
+        MedicionCarril& m = carriles[carril];
+        if (m.siguiente != 4) return;
+        uint64_t ahora = microsegundosAhora();
+        for (int etapa = ETAPA_RECEPCION; etapa < ETAPA_PLUMA; etapa++) {
+            m.etapas[etapa].registrar(m.marcas[etapa + 1] - m.marcas[etapa]);
+        }
+        m.etapas[ETAPA_PLUMA].registrar(ahora - m.marcas[3]);
+        m.etapas[ETAPA_TOTAL].registrar(ahora - m.marcas[0]);
+        m.siguiente = -1;
+    }
+
+    string textoLatencias() {
+        string respuesta = "ok " + to_string(TOTAL_CARRILES * TOTAL_ETAPAS);
+        for (int c = 0; c < TOTAL_CARRILES; c++) {
+            for (int e = 0; e < TOTAL_ETAPAS; e++) {
+                respuesta += string(" ") + NOMBRES_CARRIL[c] + "." + NOMBRES_ETAPA[e] + " " +
+                             carriles[c].etapas[e].resumen();
+            }
+        }
+        return respuesta;
+    }
+
+    string textoAnalitica() {
+        time_t ahora = time(nullptr);
+        const HistogramaLatencia& e = analitica.histogramaEstancias();
+        time_t horaPico = 0;
+        double ocupacionPico = 0;
+        analitica.horaPico(ahora, horaPico, ocupacionPico);
+        ostringstream oss;
+        oss << "ok " << e.cantidad() << " " << e.promedio() << " " << e.percentil(50) << " "
+            << e.percentil(90) << " " << e.percentil(99) << " " << (long long)horaPico << " "
+            << fixed << setprecision(2) << ocupacionPico << " " << analitica.rotacion(ahora);
+        return oss.str();
+    }
+
+    void encolar(Cliente& c, const string& linea) {
+        if (c.cerrar) return;
+        if (c.pendiente.size() + linea.size() + 1 > MAX_PENDIENTE_CLIENTE) {
+            c.cerrar = true;
+            return;
+        }
+        c.pendiente += linea;
+        c.pendiente += '\n';
+    }
+
+    void publicarEvento(const string& evento) {
+        string linea = "evento " + evento;
+        for (Cliente& c : clientes) {
+            if (c.suscrito) encolar(c, linea);
+        }
+    }
+
+    string textoOcupacion() {
+        shared_ptr<const Estacionamiento::Instantanea> vista = est.obtenerInstantanea();
+        ostringstream oss;
+        oss << vista->ocupados << " " << vista->lugares.size() << " " << vista->version;
+        return oss.str();
+    }
+
+    // <ruta>:<disponibles>:<capacidad>
+    string textoLetrero(int nodo) {
+        const JerarquiaLote& jerarquia = est.getJerarquia();
+        const JerarquiaLote::Nodo& n = jerarquia.nodo(nodo);
+        return jerarquia.ruta(nodo) + ":" + to_string(n.disponibles) + ":" + to_string(n.capacidad);
+    }
+
+    // Un evento por nodo que cambio desde el ciclo anterior, aunque hayan
+    // entrado o salido varios autos: los letreros no ven cada paso intermedio
+    void publicarLetreros() {
+        letrerosCambiados.clear();
+        est.tomarCambiosJerarquia(letrerosCambiados);
+        for (int nodo : letrerosCambiados) {
+            string letrero = textoLetrero(nodo);
+            replace(letrero.begin(), letrero.end(), ':', ' ');
+            publicarEvento("letrero " + letrero);
+        }
+    }
+
+    static string textoCobro(float cobro) {
+        ostringstream oss;
+        oss << fixed << setprecision(2) << cobro;
+        return oss.str();
+    }
+
+    // Quien llega sin reserva entra si, contandolo, siguen cabiendo las
+    // reservas de su estancia probable (la mediana, entre ANTICIPACION y 12 h).
+    // El calendario da el maximo reservado en O(log n), sin ver cada cajon.
+    bool admiteSinReserva() {
+        if (reservas.total() == 0) return true;
+        time_t ahora = time(nullptr);
+        time_t estancia = (time_t)analitica.histogramaEstancias().percentil(50);
+        if (estancia < ReservasLugares::ANTICIPACION_SEGUNDOS) estancia = ReservasLugares::ANTICIPACION_SEGUNDOS;
+        if (estancia > 12 * AnaliticaOcupacion::SEGUNDOS_HORA) estancia = 12 * AnaliticaOcupacion::SEGUNDOS_HORA;
+        sincronizarCajones();
+        return reservas.admiteSinReserva(est.obtenerInstantanea()->ocupados, ahora, estancia);
+    }
+
+    // Pasa a las reservas los cajones que el motor ocupo, libero, aparto o
+    // solto desde la vez anterior; antes de elegir un cajon libre ahora o
+    // de admitir a alguien sin reserva
+    void sincronizarCajones() {
+        lugaresCambiados.clear();
+        est.tomarCambiosDisponibles(lugaresCambiados);
+        if (lugaresCambiados.empty()) return;
+        shared_ptr<const Estacionamiento::Instantanea> vista = est.obtenerInstantanea();
+        for (int l : lugaresCambiados) {
+            const Estacionamiento::Lugar& lugar = vista->lugares[l - 1];
+            reservas.marcarLibre(l, !lugar.ocupado && !lugar.apartado);
+            reservas.marcarOcupado(l, lugar.ocupado);
+        }
+    }
+
+    // Aplica al motor los cajones que las reservas apartan o liberan. Si el
+    // cajon a apartar sigue ocupado, la reserva se pasa a otro libre.
+    void avanzarReservas() {
+        cambiosReservas.clear();
+        reservas.avanzar(time(nullptr), cambiosReservas);
+        for (const ReservasLugares::Cambio& cambio : cambiosReservas) {
+            if (!cambio.apartar) {
+                est.apartarLugar(cambio.lugar, false);
+                publicarEvento("reserva_vencida " + to_string(cambio.id) + " " + to_string(cambio.lugar));
+                continue;
+            }
+            int lugar = cambio.lugar;
+            int otro;
+            if (est.obtenerInstantanea()->lugares[lugar - 1].ocupado) {
+                sincronizarCajones();
+                if (reservas.reubicar(cambio.id, otro)) lugar = otro;
+            }
+            est.apartarLugar(lugar, true);
+            publicarEvento("reserva_apartada " + to_string(cambio.id) + " " + to_string(lugar));
+        }
+    }
+
+    // Valida y arma todo (tarifa, niveles, politica) antes de tocar el motor:
+    // si algo falla se queda completa la configuracion anterior. Los tickets
+    // abiertos, el historial y las reservas siguen igual; los cajones nuevos
+    // entran libres al final. Corre entre dos ciclos del servidor, asi que
+    // ninguna trama de las plumas espera mas que un ciclo.
+    bool aplicarConfiguracion(const ConfiguracionLote& cambios, string& error) {
+        ConfiguracionLote nueva = vigente.combinar(cambios);
+        if (nueva.capacidad < est.capacidad()) {
+            error = "la capacidad solo crece (ahora " + to_string(est.capacidad()) + ")";
+            return false;
+        }
+        bool cambiaLote = nueva.capacidad != vigente.capacidad || nueva.niveles != vigente.niveles ||
+                          nueva.politica != vigente.politica;
+        JerarquiaLote jerarquia = JerarquiaLote::delLote(nueva.capacidad);
+        unique_ptr<PoliticaAsignacion> politica;
+        if (cambiaLote) {
+            if (!nueva.niveles.empty() && (!JerarquiaLote::desdeTexto(nueva.niveles, jerarquia) ||
+                                           jerarquia.totalCajones() != nueva.capacidad)) {
+                error = "niveles invalidos (deben sumar " + to_string(nueva.capacidad) + " cajones): " + nueva.niveles;
+                return false;
+            }
+            politica = crearPoliticaLote(nueva.politica, jerarquia);
+            if (!politica) {
+                error = "politica desconocida " + nueva.politica;
+                return false;
+            }
+        }
+
+        est.asignarTarifa({nueva.tarifaHora, nueva.minutosGratis});
+        if (cambiaLote) {
+            est.ampliar(nueva.capacidad);
+            analitica.ampliar(nueva.capacidad);
+            reservas.ampliar(nueva.capacidad);
+            est.asignarJerarquia(jerarquia);
+            est.asignarPolitica(std::move(politica));
+        }
+        if (nueva.puertos != vigente.puertos || nueva.baudios != vigente.baudios) {
+            // Un paso a medias en el puerto anterior ya no va a terminar
+            decodificador = DecodificadorMega();
+            cancelarMedicion(CARRIL_ENTRADA);
+            cancelarMedicion(CARRIL_SALIDA);
+            puertoSerial = conectarSerial(serial, nueva.puertos, nueva.baudios);
+            if (puertoSerial.empty()) {
+                cout << "Modo simulacion (sin Arduino)" << endl;
+            } else {
+                cout << "Puerto serial conectado: " << puertoSerial << " a " << nueva.baudios << endl;
+            }
+        }
+        bool crecio = nueva.capacidad != vigente.capacidad;
+        vigente = nueva;
+        recargas++;
+        metricas.recargasConfiguracion.sumar();
+        publicarEvento("configuracion " + to_string(recargas) + " " + textoCobro(vigente.tarifaHora) + " " +
+                       to_string(vigente.capacidad));
+        if (crecio) publicarEvento("ocupacion " + textoOcupacion());
+        return true;
+    }
+
+    bool recargarConfiguracion(string& error) {
+        ConfiguracionLote archivo;
+        if (ConfiguracionLote::leer(vigilante.archivo(), archivo, error) && aplicarConfiguracion(archivo, error)) {
+            cout << "Configuracion " << recargas << " aplicada desde " << vigilante.archivo() << endl;
+            return true;
+        }
+        metricas.erroresConfiguracion.sumar();
+        cout << "Error: configuracion " << vigilante.archivo() << ": " << error << " (se queda la anterior)" << endl;
+        return false;
+    }
+
+    // Un stat() cada PERIODO_CONFIGURACION_US; si --config cambio, se aplica
+    void revisarConfiguracion() {
+        if (!vigilante.activo()) return;
+        uint64_t ahora = microsegundosAhora();
+        if (ahora - ultimaRevisionConfiguracion < PERIODO_CONFIGURACION_US) return;
+        ultimaRevisionConfiguracion = ahora;
+        string error;
+        if (vigilante.cambio()) recargarConfiguracion(error);
+    }
+
+    // Entrada comun para el sensor de la pluma y para los clientes. Con
+    // 'lugarReservado' (llegada de una reserva) se usa ese cajon si esta libre.
+    int registrarEntrada(string& ticketId, const SolicitudLugar& solicitud = SolicitudLugar(),
+                         int lugarReservado = 0) {
+        bool admitido = lugarReservado > 0 || admiteSinReserva();
+        int lugar = -1;
+        if (lugarReservado > 0) lugar = est.entradaEn(lugarReservado);
+        if (admitido && lugar == -1) lugar = est.entrada(solicitud);
+        if (lugar == -1) {
+            (admitido ? metricas.rechazosLleno : metricas.rechazosReserva).sumar();
+            enviarSerial("0");
+            cancelarMedicion(CARRIL_ENTRADA);
+            return -1;
+        }
+        marcar(CARRIL_ENTRADA, 2);
+        metricas.entradas.sumar();
+        const Estacionamiento::Lugar& asignado = est.obtenerInstantanea()->lugares[lugar - 1];
+        ticketId = asignado.ticketId;
+        analitica.entrada(lugar, asignado.horaEntrada);
+        historial.registrarEntrada(ticketId, lugar, asignado.horaEntrada);
+        enviarSerial("1");
+        marcar(CARRIL_ENTRADA, 3);
+        publicarEvento("entrada " + to_string(lugar) + " " + ticketId);
+        publicarEvento("ocupacion " + textoOcupacion());
+        return lugar;
+    }
+
+    void procesarTramaSerial(const TramaMega& trama, uint64_t recibido, uint64_t completo) {
+        if (trama.tipo == TRAMA_VACIA) return;
+
+        if (trama.tipo == TRAMA_PLUMA) {
+            completarMedicion(trama.carril == 1 ? CARRIL_ENTRADA : CARRIL_SALIDA);
+            return;
+        }
+
+        if (trama.tipo == TRAMA_CAJONES) {
+            for (const Estacionamiento::Discrepancia& d : est.conciliarSensores(trama.mapa)) {
+                publicarEvento(string(d.autoSinTicket ? "auto_sin_ticket " : "ticket_sin_auto ") +
+                               to_string(d.lugar));
+            }
+            return;
+        }
+
+        int comando = trama.codigo;
+        if (comando == CODIGO_ENTRADA) {
+            iniciarMedicion(CARRIL_ENTRADA, recibido, completo);
+            string ticketId;
+            int lugar = registrarEntrada(ticketId);
+            cout << (lugar != -1 ? "Entrada automatica - Lugar " + est.etiquetaLugar(lugar)
+                                 : string("Estacionamiento lleno")) << endl;
+        } else if (comando == CODIGO_SALIDA) {
+            // La salida necesita el ticket: la completa un cajero con "salida <ticket>"
+            salidaPendiente = true;
+            iniciarMedicion(CARRIL_SALIDA, recibido, completo);
+            publicarEvento("espera_salida");
+        } else {
+            // Solo se cuenta: con --grabar la linea queda en la traza
+            metricas.serialDesconocidas.sumar();
+        }
+    }
+
+    void atenderSerial() {
+        char buffer[256];
+        int leidos;
+        while ((leidos = serial.leerBytes(buffer, sizeof(buffer))) > 0) {
+            uint64_t ahora = microsegundosAhora();
+            metricas.serialBytesRecibidos.sumar(leidos);
+            const char* p = buffer;
+            const char* fin = buffer + leidos;
+            TramaMega trama;
+            while (true) {
+                // La linea que empiece en este bloque llego 'ahora'
+                if (decodificador.enBlanco()) inicioLineaSerial = ahora;
+                if (!decodificador.siguiente(p, fin, trama)) break;
+                metricas.serialTramasRecibidas.sumar();
+                if (decodificador.lineaDesbordada()) metricas.serialErrores.sumar();  // ruido: se trunca
+                grabador.registrar(false, decodificador.linea(), decodificador.largoLinea());
+                procesarTramaSerial(trama, inicioLineaSerial, ahora);
+            }
+        }
+    }
+
+    // Folio completo del ticket activo que mando el cliente (o solo su
+    // final); si no, responde el error y regresa false
+    bool resolverTicket(Cliente& c, const string& tecleado, string& ticketId) {
+        Estacionamiento::ResultadoFolio folio = est.resolverTicket(tecleado, ticketId);
+        if (folio == Estacionamiento::FOLIO_ACTIVO) return true;
+        if (folio == Estacionamiento::FOLIO_MAL_ESCRITO) metricas.ticketsMalEscritos.sumar();
+        encolar(c, folio == Estacionamiento::FOLIO_MAL_ESCRITO ? "error mal_escrito" : "error no_encontrado");
+        return false;
+    }
+
+    void procesarPeticion(Cliente& c, const string& linea) {
+        istringstream iss(linea);
+        string comando, argumento;
+        iss >> comando >> argumento;
+
+        if (comando == "entrada") {
+            string placa, opcion;
+            SolicitudLugar solicitud;
+            istringstream opciones(linea.substr(comando.size()));
+            while (opciones >> opcion) {
+                if (opcion.compare(0, 5, "zona=") == 0) {
+                    solicitud.zona = est.getJerarquia().buscarZona(opcion.substr(5));
+                } else if (opcion == "preferente") {
+                    solicitud.preferente = true;
+                } else if (placa.empty()) {
+                    placa = opcion;
+                }
+            }
+            string ticketId;
+            int lugar = registrarEntrada(ticketId, solicitud);
+            if (lugar != -1) historial.registrarPlaca(ticketId, placa);
+            encolar(c, lugar != -1 ? "ok " + to_string(lugar) + " " + ticketId : "error lleno");
+        } else if (comando == "salida") {
+            string ticketId;
+            if (!resolverTicket(c, argumento, ticketId)) return;
+            int lugar = 0;
+            time_t horaEntrada = 0;
+            est.buscarTicket(ticketId, lugar, horaEntrada);
+            float cobro = est.salida(ticketId);
+            if (cobro < 0) {
+                encolar(c, "error no_encontrado");
+                return;
+            }
+            time_t horaSalida = time(nullptr);
+            analitica.salida(lugar, horaEntrada, horaSalida);
+            historial.registrarSalida(ticketId, horaSalida, cobro);
+            marcar(CARRIL_SALIDA, 2);
+            metricas.salidas.sumar();
+            if (cobro == 0) metricas.salidasGratis.sumar();
+            metricas.ingresosCentavos.sumar(llround(cobro * 100.0));
+            enviarSerial("2");
+            marcar(CARRIL_SALIDA, 3);
+            salidaPendiente = false;
+            encolar(c, "ok " + textoCobro(cobro) + " " + ticketId);
+            publicarEvento("salida " + ticketId + " " + textoCobro(cobro));
+            publicarEvento("ocupacion " + textoOcupacion());
+        } else if (comando == "consulta") {
+            string ticketId;
+            if (!resolverTicket(c, argumento, ticketId)) return;
+            int lugar;
+            time_t horaEntrada;
+            if (est.buscarTicket(ticketId, lugar, horaEntrada)) {
+                encolar(c, "ok " + to_string(lugar) + " " + to_string((long long)horaEntrada) + " " + ticketId);
+            } else {
+                encolar(c, "error no_encontrado");
+            }
+        } else if (comando == "ocupacion") {
+            encolar(c, "ok " + textoOcupacion());
+        } else if (comando == "tickets") {
+            shared_ptr<const Estacionamiento::Instantanea> vista = est.obtenerInstantanea();
+            string respuesta = "ok " + to_string(vista->ocupados);
+            vista->lugares.recorrer([&](size_t i, const Estacionamiento::Lugar& lugar) {
+                if (lugar.ocupado) respuesta += " " + lugar.ticketId + ":" + to_string(i + 1);
+            });
+            encolar(c, respuesta);
+        } else if (comando == "discrepancias") {
+            shared_ptr<const Estacionamiento::Instantanea> vista = est.obtenerInstantanea();
+            int total = 0;
+            string lista;
+            vista->lugares.recorrer([&](size_t i, const Estacionamiento::Lugar& lugar) {
+                if (Estacionamiento::textoDiscrepancia(*vista, (int)i).empty()) return;
+                total++;
+                lista += string(lugar.autoPresente ? " auto_sin_ticket:" : " ticket_sin_auto:") + to_string(i + 1);
+            });
+            encolar(c, "ok " + to_string(total) + lista);
+        } else if (comando == "latencias") {
+            encolar(c, textoLatencias());
+        } else if (comando == "metricas") {
+            actualizarMedidores();
+            string texto = metricas.registro.textoPrometheus();
+            if (!texto.empty() && texto.back() == '\n') texto.pop_back();
+            size_t lineas = count(texto.begin(), texto.end(), '\n') + 1;
+            encolar(c, "ok " + to_string(lineas));
+            encolar(c, texto);
+        } else if (comando == "analitica") {
+            encolar(c, textoAnalitica());
+        } else if (comando == "utilizacion") {
+            time_t ahora = time(nullptr);
+            string respuesta = "ok " + to_string(est.capacidad());
+            for (int lugar = 1; lugar <= est.capacidad(); lugar++) {
+                ostringstream oss;
+                oss << " " << lugar << ":" << fixed << setprecision(1) << analitica.utilizacion(lugar, ahora) * 100.0;
+                respuesta += oss.str();
+            }
+            encolar(c, respuesta);
+        } else if (comando == "placa") {
+            string placa, ticketId;
+            iss >> placa;
+            if (!resolverTicket(c, argumento, ticketId)) return;
+            int lugar;
+            time_t horaEntrada;
+            if (placa.empty() || !est.buscarTicket(ticketId, lugar, horaEntrada)) {
+                encolar(c, "error no_encontrado");
+            } else {
+                historial.registrarPlaca(ticketId, placa);
+                encolar(c, "ok");
+            }
+        } else if (comando == "buscar_placa") {
+            encolar(c, textoBusquedaPlaca(argumento));
+        } else if (comando == "entradas") {
+            long long desde = 0, hasta = 0;
+            istringstream rango(linea.substr(comando.size()));
+            if (!(rango >> desde >> hasta) || hasta < desde) {
+                encolar(c, "error argumento");
+                return;
+            }
+            vector<uint32_t> encontrados;
+            historial.buscarEntradas((time_t)desde, (time_t)hasta, encontrados, MAX_RESULTADOS_HORA);
+            encolar(c, textoPorHora(encontrados));
+        } else if (comando == "estancias_largas") {
+            char* fin = nullptr;
+            double horas = strtod(argumento.c_str(), &fin);
+            if (argumento.empty() || *fin != '\0' || horas < 0) {
+                encolar(c, "error argumento");
+                return;
+            }
+            vector<uint32_t> encontrados;
+            time_t limite = time(nullptr) - (time_t)(horas * AnaliticaOcupacion::SEGUNDOS_HORA);
+            historial.buscarEstanciasLargas(limite, encontrados, MAX_RESULTADOS_HORA);
+            encolar(c, textoPorHora(encontrados));
+        } else if (comando == "exportar") {
+            string opcion;
+            iss >> opcion;
+            if (argumento.empty() || (!opcion.empty() && opcion != "comprimido")) {
+                encolar(c, "error argumento");
+            } else {
+                long long filas = historial.exportar(argumento, lote, opcion == "comprimido");
+                encolar(c, filas < 0 ? "error archivo" : "ok " + to_string(filas));
+            }
+        } else if (comando == "reservar") {
+            long long inicio = 0, fin = 0;
+            string placa;
+            istringstream datos(linea.substr(comando.size()));
+            if (!(datos >> inicio >> fin) || fin <= inicio) {
+                encolar(c, "error argumento");
+                return;
+            }
+            datos >> placa;
+            // Si empieza pronto, el cajon tiene que estar libre ahora
+            sincronizarCajones();
+            int lugar;
+            uint32_t id = reservas.reservar((time_t)inicio, (time_t)fin, IndicePlacas::normalizar(placa),
+                                            time(nullptr), lugar);
+            if (id == 0) {
+                encolar(c, "error sin_lugar");
+                return;
+            }
+            encolar(c, "ok " + to_string(id) + " " + to_string(lugar));
+            avanzarReservas();
+        } else if (comando == "cancelar_reserva") {
+            ReservasLugares::Reserva r;
+            if (!reservas.quitar((uint32_t)strtoul(argumento.c_str(), nullptr, 10), r)) {
+                encolar(c, "error no_encontrado");
+                return;
+            }
+            if (r.apartada) est.apartarLugar(r.lugar, false);
+            encolar(c, "ok");
+        } else if (comando == "llegada") {
+            ReservasLugares::Reserva r;
+            uint32_t id = (uint32_t)strtoul(argumento.c_str(), nullptr, 10);
+            if (!reservas.buscar(id, r)) {
+                encolar(c, "error no_encontrado");
+                return;
+            }
+            string ticketId;
+            SolicitudLugar solicitud;
+            solicitud.preferente = true;
+            int lugar = registrarEntrada(ticketId, solicitud, r.lugar);
+            if (lugar == -1) {
+                encolar(c, "error lleno");
+                return;
+            }
+            reservas.quitar(id, r);
+            if (r.apartada && lugar != r.lugar) est.apartarLugar(r.lugar, false);
+            if (!r.placa.empty()) historial.registrarPlaca(ticketId, r.placa);
+            encolar(c, "ok " + to_string(lugar) + " " + ticketId);
+        } else if (comando == "disponibilidad") {
+            long long desde = 0, hasta = 0;
+            istringstream rango(linea.substr(comando.size()));
+            if (!(rango >> desde >> hasta) || hasta <= desde) {
+                encolar(c, "error argumento");
+                return;
+            }
+            int reservados = reservas.reservadosEn((time_t)desde, (time_t)hasta);
+            encolar(c, "ok " + to_string(est.capacidad() - reservados) + " " + to_string(reservados));
+        } else if (comando == "letreros") {
+            int nodos = est.getJerarquia().totalNodos();
+            string respuesta = "ok " + to_string(nodos);
+            for (int n = 0; n < nodos; n++) respuesta += " " + textoLetrero(n);
+            encolar(c, respuesta);
+        } else if (comando == "configuracion") {
+            encolar(c, "ok " + to_string(recargas) + " " + textoCobro(vigente.tarifaHora) + " " +
+                       to_string(vigente.minutosGratis) + " " + to_string(vigente.capacidad) + " " +
+                       vigente.politica + " " + to_string(vigente.baudios) + " " +
+                       (puertoSerial.empty() ? "-" : puertoSerial));
+        } else if (comando == "recargar") {
+            string error;
+            if (!vigilante.activo()) {
+                encolar(c, "error sin_config");
+            } else if (recargarConfiguracion(error)) {
+                encolar(c, "ok " + to_string(recargas));
+            } else {
+                encolar(c, "error " + error);
+            }
+        } else if (comando == "suscribir") {
+            c.suscrito = true;
+            encolar(c, "ok");
+            if (salidaPendiente) encolar(c, "evento espera_salida");
+        } else if (!comando.empty()) {
+            encolar(c, "error comando");
+        }
+    }
+
+    void leerCliente(Cliente& c) {
+        char buffer[1024];
+        while (true) {
+            int n = (int)recv(c.s, buffer, sizeof(buffer), 0);
+            if (n == 0) { c.cerrar = true; return; }
+            if (n < 0) {
+                if (!operacionPendiente()) c.cerrar = true;
+                return;
+            }
+            c.recibido.append(buffer, n);
+
+            size_t inicio = 0, fin;
+            while ((fin = c.recibido.find('\n', inicio)) != string::npos) {
+                string linea = c.recibido.substr(inicio, fin - inicio);
+                if (!linea.empty() && linea.back() == '\r') linea.pop_back();
+                procesarPeticion(c, linea);
+                inicio = fin + 1;
+            }
+            c.recibido.erase(0, inicio);
+            if (c.recibido.size() > MAX_LINEA_CLIENTE) c.cerrar = true;
+            if (c.cerrar) return;
+        }
+    }
+
+    void enviarPendiente(Cliente& c) {
+        while (!c.pendiente.empty() && !c.cerrar) {
+            int n = (int)send(c.s, c.pendiente.data(), (int)c.pendiente.size(), FLAGS_ENVIO);
+            if (n < 0) {
+                if (!operacionPendiente()) c.cerrar = true;
+                return;
+            }
+            c.pendiente.erase(0, n);
+        }
+    }
+
+    void aceptarClientes() {
+        while (true) {
+            Socket s = accept(escucha, NULL, NULL);
+            if (s == SOCKET_INVALIDO) return;
+            if (!ponerNoBloqueante(s)) {
+                cerrarSocket(s);
+                continue;
+            }
+            clientes.push_back({s, "", "", false, false});
+            metricas.clientesConexiones.sumar();
+        }
+    }
+
+public:
+    ServidorLocal(Estacionamiento& e, SerialController& sc)
+        : est(e), serial(sc), escucha(SOCKET_INVALIDO), inicioLineaSerial(0), salidaPendiente(false),
+      ultimaExportacion(0), analitica(e.capacidad(), time(nullptr)),
+      reservas(e.capacidad(), time(nullptr)), ultimaRevisionConfiguracion(0), recargas(0), lote(1) {
+        for (MedicionCarril& m : carriles) m.siguiente = -1;
+        Estacionamiento::Tarifa tarifa = e.getTarifa();
+        vigente.tarifaHora = tarifa.porHora;
+        vigente.minutosGratis = tarifa.minutosGratis;
+        vigente.capacidad = e.capacidad();
+        vigente.politica = e.getPolitica().nombre();
+    }
+
+    // Configuracion de arranque (linea de comandos y --config), aplicada
+    // como cualquier recarga; tambien abre el puerto serial
+    bool configurar(const ConfiguracionLote& configuracion, string& error) {
+        return aplicarConfiguracion(configuracion, error);
+    }
+
+    // Vuelve a leer 'ruta' cada vez que cambia
+    void vigilarConfiguracion(const string& ruta) {
+        vigilante.vigilar(ruta);
+    }
+
+    bool iniciar(const string& ruta) {
+        sockaddr_un direccion;
+        memset(&direccion, 0, sizeof(direccion));
+        if (ruta.size() >= sizeof(direccion.sun_path)) {
+            cout << "Error: ruta de socket demasiado larga" << endl;
+            return false;
+        }
+        direccion.sun_family = AF_UNIX;
+        strcpy(direccion.sun_path, ruta.c_str());
+
+        escucha = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (escucha == SOCKET_INVALIDO) {
+            cout << "Error: no se pudo crear el socket" << endl;
+            return false;
+        }
+
+        remove(ruta.c_str());  // socket viejo de una ejecucion anterior
+        if (bind(escucha, (sockaddr*)&direccion, sizeof(direccion)) != 0 ||
+            listen(escucha, SOMAXCONN) != 0 || !ponerNoBloqueante(escucha)) {
+            cout << "Error: no se pudo escuchar en " << ruta << endl;
+            cerrarSocket(escucha);
+            escucha = SOCKET_INVALIDO;
+            return false;
+        }
+        rutaSocket = ruta;
+        return true;
+    }
+
+    void ejecutar() {
+        while (servidorActivo) {
+            fds.clear();
+            fds.push_back({escucha, POLLIN, 0});
+            for (const Cliente& c : clientes) {
+                short eventos = POLLIN;
+                if (!c.pendiente.empty()) eventos |= POLLOUT;
+                fds.push_back({c.s, eventos, 0});
+            }
+
+            if (esperarEventos(fds, ESPERA_CICLO_MS) > 0) {
+                // Los clientes aceptados en este ciclo se atienden en el siguiente
+                size_t atendidos = clientes.size();
+                if (fds[0].revents & POLLIN) aceptarClientes();
+                for (size_t i = 0; i < atendidos; i++) {
+                    short revents = fds[i + 1].revents;
+                    if (revents & (POLLIN | POLLHUP)) leerCliente(clientes[i]);
+                    if (revents & (POLLERR | POLLNVAL)) clientes[i].cerrar = true;
+                }
+            }
+
+            atenderSerial();
+            revisarConfiguracion();
+            avanzarReservas();
+            publicarLetreros();
+
+            for (Cliente& c : clientes) enviarPendiente(c);
+            grabador.vaciar();
+            exportarMetricas();
+
+            // Compactar la lista quitando los clientes cerrados
+            size_t vivos = 0;
+            for (size_t i = 0; i < clientes.size(); i++) {
+                if (clientes[i].cerrar) {
+                    cerrarSocket(clientes[i].s);
+                } else {
+                    if (vivos != i) clientes[vivos] = std::move(clientes[i]);
+                    vivos++;
+                }
+            }
+            clientes.resize(vivos);
+        }
+    }
+
+    // Graba cada trama serial (entrada y salida) en un archivo de traza
+    bool grabar(const string& ruta) {
+        return grabador.abrir(ruta);
+    }
+
+    // Exporta las metricas a 'ruta' cada PERIODO_METRICAS_US y al terminar
+    void exportarMetricasEn(const string& ruta) {
+        rutaMetricas = ruta;
+    }
+
+    // Numero de lote en las exportaciones del historial, para juntar varios
+    void asignarLote(int numero) {
+        lote = numero;
+    }
+
+    void exportarMetricasFinales() {
+        ultimaExportacion = 0;
+        exportarMetricas();
+    }
+
+    // Tabla de latencias al terminar, en milisegundos
+    void mostrarLatencias() {
+        cout << "Latencia sensor -> pluma (ms):" << endl;
+        cout << left << setw(20) << "carril.etapa" << right << setw(8) << "n" << setw(10) << "p50"
+             << setw(10) << "p90" << setw(10) << "p99" << setw(10) << "max" << endl;
+        for (int c = 0; c < TOTAL_CARRILES; c++) {
+            for (int e = 0; e < TOTAL_ETAPAS; e++) {
+                const HistogramaLatencia& h = carriles[c].etapas[e];
+                cout << left << setw(20) << string(NOMBRES_CARRIL[c]) + "." + NOMBRES_ETAPA[e] << right
+                     << setw(8) << h.cantidad() << fixed << setprecision(2)
+                     << setw(10) << h.percentil(50) / 1000.0 << setw(10) << h.percentil(90) / 1000.0
+                     << setw(10) << h.percentil(99) / 1000.0 << setw(10) << h.valorMaximo() / 1000.0 << endl;
+            }
+        }
+    }
+
+    ~ServidorLocal() {
+        for (Cliente& c : clientes) cerrarSocket(c.s);
+        if (escucha != SOCKET_INVALIDO) {
+            cerrarSocket(escucha);
+            remove(rutaSocket.c_str());
+        }
+    }
+};
+
+// --------------------------- Función principal ------------------------------
+// Uso: servidorEstacionamiento [--grabar traza] [--metricas archivo] [--lote n] [--niveles texto]
+//        [--politica nombre] [--config archivo] [ruta_socket] [puerto_serial]
+//   --grabar traza      graba las tramas seriales para reproducirlas despues
+//                       (ver benchmark/reproducirTraza.cpp)
+//   --metricas archivo  exporta las metricas en formato Prometheus cada 5 s
+//   --lote n            numero de lote en "exportar" (1 por omision)
+//   --niveles texto     niveles y zonas del sitio, p. ej. "P1:A=4;P2:B=2" (deben
+//                       sumar los cajones; por omision un nivel con las zonas de
+//                       distribucionLote.h)
+//   --politica nombre   lugar que se da a cada entrada (ver politicasAsignacion.h):
+//                         primer_libre (por omision), rotacion, zonas (las de
+//                         --niveles), cercania=<d1,d2,...> (distancia de
+//                         cada cajon a la salida), preferentes=<l1,l2,...> (cajones
+//                         solo para "entrada ... preferente" y llegadas con reserva)
+//   --config archivo    tarifa, capacidad, niveles, politica, puertos y baudios (ver
+//                       configuracionLote.h; lo que trae gana sobre las opciones). Se
+//                       vuelve a leer cada vez que cambia, sin perder los tickets.
+int main(int argc, char* argv[]) {
+    string rutaTraza, rutaMetricas, rutaConfiguracion, niveles, nombrePolitica = "primer_libre";
+    int lote = 1;
+    vector<string> posicionales;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--grabar" && i + 1 < argc) {
+            rutaTraza = argv[++i];
+        } else if (arg == "--metricas" && i + 1 < argc) {
+            rutaMetricas = argv[++i];
+        } else if (arg == "--lote" && i + 1 < argc) {
+            lote = atoi(argv[++i]);
+        } else if (arg == "--niveles" && i + 1 < argc) {
+            niveles = argv[++i];
+        } else if (arg == "--politica" && i + 1 < argc) {
+            nombrePolitica = argv[++i];
+        } else if (arg == "--config" && i + 1 < argc) {
+            rutaConfiguracion = argv[++i];
+        } else {
+            posicionales.push_back(arg);
+        }
+    }
+    string rutaSocket = posicionales.size() > 0 ? posicionales[0] : "estacionamiento.sock";
+
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        cout << "Error: no se pudo iniciar Winsock" << endl;
+        return 1;
+    }
+#else
+    signal(SIGPIPE, SIG_IGN);
+#endif
+    signal(SIGINT, detenerServidor);
+    signal(SIGTERM, detenerServidor);
+
+    // Capacidad dinamica para que --config pueda agregar cajones en marcha
+    Estacionamiento est(CAJONES_LOTE);
+    SerialController serial;
+
+    ConfiguracionLote configuracion;
+    Estacionamiento::Tarifa tarifa = est.getTarifa();
+    configuracion.tarifaHora = tarifa.porHora;
+    configuracion.minutosGratis = tarifa.minutosGratis;
+    configuracion.capacidad = est.capacidad();
+    configuracion.niveles = niveles;
+    configuracion.politica = nombrePolitica;
+    configuracion.puertos = posicionales.size() > 1 ? vector<string>{posicionales[1]} : puertosPorOmision();
+    configuracion.baudios = 9600;
+    string error;
+    if (!rutaConfiguracion.empty()) {
+        ConfiguracionLote archivo;
+        if (!ConfiguracionLote::leer(rutaConfiguracion, archivo, error)) {
+            cout << "Error: configuracion " << rutaConfiguracion << ": " << error << endl;
+            return 1;
+        }
+        configuracion = configuracion.combinar(archivo);
+    }
+
+    {
+        ServidorLocal servidor(est, serial);
+        if (!servidor.configurar(configuracion, error)) {
+            cout << "Error: " << error << endl;
+            return 1;
+        }
+        if (!rutaConfiguracion.empty()) servidor.vigilarConfiguracion(rutaConfiguracion);
+        if (!servidor.iniciar(rutaSocket)) return 1;
+        if (!rutaTraza.empty() && !servidor.grabar(rutaTraza)) {
+            cout << "Error: no se pudo crear la traza " << rutaTraza << endl;
+            return 1;
+        }
+        cout << "Servidor escuchando en " << rutaSocket << endl;
+        if (!rutaMetricas.empty()) servidor.exportarMetricasEn(rutaMetricas);
+        servidor.asignarLote(lote);
+        servidor.ejecutar();
+        servidor.exportarMetricasFinales();
+        servidor.mostrarLatencias();
+    }
+
+    cout << "Servidor detenido." << endl;
+#ifdef _WIN32
+    WSACleanup();
+#endif
+    return 0;
+}
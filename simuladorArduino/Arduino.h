@@ -0,0 +1,105 @@
+// Arduino.h (simulador)
+// Capa minima del API de Arduino para compilar los sketches sin cambios
+// como ejecutables de Linux. La implementacion esta en simulador.cpp.
+// Diferencias con el AVR: int es de 32 bits y millis()/micros() no se
+// desbordan a los 49 dias / 70 minutos.
+
+#ifndef SIMULADOR_ARDUINO_H
+#define SIMULADOR_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x0
+#define OUTPUT       0x1
+#define INPUT_PULLUP 0x2
+
+#define DEC 10
+#define HEX 16
+#define BIN 2
+
+#define F(texto) (texto)
+
+// Numeración de pines analógicos del Mega 2560
+#define A0  54
+#define A1  55
+#define A2  56
+#define A3  57
+#define A4  58
+#define A5  59
+#define A6  60
+#define A7  61
+#define A8  62
+#define A9  63
+#define A10 64
+#define A11 65
+#define A12 66
+#define A13 67
+#define A14 68
+#define A15 69
+
+// Interrupción por cambio de pin: solo se simula PCINT2 (puerto K, A8..A15),
+// con los mismos nombres de registros que avr-libc
+#define PCIE2 2
+extern volatile uint8_t PCICR;
+extern volatile uint8_t PCMSK2;
+uint8_t simuladorLeerPuertoK();
+#define PINK (simuladorLeerPuertoK())
+#define ISR(vector) extern "C" void vector(void)
+#define PCINT2_vect simuladorPcint2
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+void pinMode(int pin, int modo);
+void digitalWrite(int pin, int valor);
+int digitalRead(int pin);
+unsigned long pulseIn(int pin, int estado, unsigned long timeout = 1000000UL);
+
+void noInterrupts();
+void interrupts();
+
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+unsigned long millis();
+unsigned long micros();
+
+class HardwareSerial {
+public:
+    void begin(unsigned long baud);
+    void end() {}
+    int available();
+    int read();
+    int peek();
+    void flush();
+    void setTimeout(unsigned long ms);
+    long parseInt();
+
+    size_t write(uint8_t c);
+    size_t write(const char* texto);
+    size_t write(const uint8_t* datos, size_t n);
+
+    size_t print(const char* texto);
+    size_t print(char c);
+    size_t print(int n, int base = DEC);
+    size_t print(unsigned int n, int base = DEC);
+    size_t print(long n, int base = DEC);
+    size_t print(unsigned long n, int base = DEC);
+    size_t print(double n, int digitos = 2);
+
+    size_t println();
+    template <typename T> size_t println(T valor) { size_t n = print(valor); return n + println(); }
+    template <typename T> size_t println(T valor, int formato) { size_t n = print(valor, formato); return n + println(); }
+
+    operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,25 @@
+// Servo.h (simulador)
+// Solo guarda el angulo; con --traza cada movimiento queda en el registro.
+
+#ifndef SIMULADOR_SERVO_H
+#define SIMULADOR_SERVO_H
+
+#include "Arduino.h"
+
+class Servo {
+public:
+    Servo() : pin(-1), angulo(90) {}
+    uint8_t attach(int p);
+    uint8_t attach(int p, int minimo, int maximo) { (void)minimo; (void)maximo; return attach(p); }
+    void detach() { pin = -1; }
+    void write(int valor);
+    void writeMicroseconds(int us) { write((us - 544) * 180 / (2400 - 544)); }
+    int read() { return angulo; }
+    bool attached() { return pin != -1; }
+
+private:
+    int pin;
+    int angulo;
+};
+
+#endif
@@ -0,0 +1,664 @@
+// simulador.cpp
+// Nucleo del simulador de Arduino para Linux: reloj virtual, pines,
+// sensores ultrasonicos guiados por un perfil de distancias, Serial sobre
+// un pty y el ciclo setup()/loop() del sketch.
+//
+// Uso: <sketch> [--perfil archivo] [--velocidad N] [--duracion ms]
+//               [--enlace ruta] [--esperar] [--traza] [--estadisticas]
+//   --velocidad N  tiempo virtual N veces mas rapido que el real (0 = sin pausa)
+//   --duracion ms  termina al llegar a ese tiempo virtual
+//   --enlace ruta  crea un enlace simbolico al pty (p. ej. /tmp/ttyARDUINO)
+//   --esperar      no arranca setup() hasta que alguien abra el pty
+//   --traza        registra en stderr LEDs, servos y bytes seriales
+//   --estadisticas al terminar, periodo de muestreo de cada sensor y duracion de loop()
+//
+// Formato del perfil (una directiva por linea, '#' inicia comentario):
+//   sensor <nombre> <trig> <echo> [cm_inicial]
+//   <tiempo_ms> <nombre> <cm>      distancia a partir de ese instante (cm <= 0: sin eco)
+//   fin <tiempo_ms>                igual que --duracion
+//   ruido <nombre> <porcentaje> <cm>  ese porcentaje de disparos rebota a <cm>
+//                                  (lecturas espurias; secuencia fija y repetible)
+//   pc <tiempo_ms> <texto>         la PC manda <texto> + '\n' por el Serial en ese
+//                                  instante (p. ej. "1" para abrir la pluma de entrada)
+
+#include "Arduino.h"
+#include "Servo.h"
+
+#include <cstdio>
+#include <cstdarg>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <deque>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <random>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <termios.h>
+#include <time.h>
+#include <errno.h>
+
+using namespace std;
+
+void setup();
+void loop();
+extern "C" void simuladorPcint2(void) __attribute__((weak));
+
+HardwareSerial Serial;
+volatile uint8_t PCICR = 0;
+volatile uint8_t PCMSK2 = 0;
+
+namespace {
+
+struct SensorUltrasonico {
+    string nombre;
+    int trig;
+    int echo;
+    vector<pair<unsigned long, long> > perfil;  // (ms, cm), ordenado por tiempo
+    int ruidoPorcentaje;
+    long ruidoCm;
+    bool trigAlto;
+    bool disparado;
+    unsigned long long inicioEco;  // us virtuales
+    unsigned long long finEco;
+    bool subidaPendiente;          // flancos aun no entregados a la ISR
+    bool bajadaPendiente;
+    unsigned long long disparos;
+    unsigned long long ultimoDisparo;
+    unsigned long long sumaIntervalos;
+    unsigned long long maxIntervalo;
+};
+
+const int TOTAL_PINES = 256;
+const unsigned long LATENCIA_ECO_US = 450;     // del flanco del trigger al inicio del eco
+const unsigned long ECO_SIN_OBJETO_US = 38000; // el HC-SR04 sostiene el eco si no hay rebote
+const long ALCANCE_MAXIMO_CM = 400;
+// Costo aproximado de una vuelta vacia de loop() y de leer el reloj en un
+// AVR a 16 MHz; sin esto un sketch que solo consulta millis() congela el tiempo
+const unsigned long COSTO_LOOP_US = 20;
+const unsigned long COSTO_RELOJ_US = 4;
+const int PRIMER_PIN_PUERTO_K = 62;  // A8
+
+unsigned long long relojUs = 0;
+unsigned long long duracionUs = 0;
+double velocidad = 1.0;
+bool traza = false;
+bool estadisticas = false;
+bool interrupcionesHabilitadas = true;
+bool enInterrupcion = false;
+unsigned long long maxLoopUs = 0;
+unsigned long long sumaLoopUs = 0;
+timespec inicioReal;
+
+int estadoPin[TOTAL_PINES];
+int modoPin[TOTAL_PINES];
+vector<SensorUltrasonico> sensores;
+mt19937 generadorRuido(2024);
+
+int ptyMaestro = -1;
+deque<char> recibidos;
+unsigned long baudios = 9600;
+unsigned long long txLibreUs = 0;
+unsigned long timeoutSerialMs = 1000;
+unsigned long long bytesEnviados = 0;
+unsigned long long bytesRecibidos = 0;
+unsigned long long vueltasLoop = 0;
+string lineaEnviada;
+string lineaRecibida;
+vector<pair<unsigned long, string> > enviosPc;  // (ms, texto) de la directiva "pc", ordenados
+size_t siguienteEnvioPc = 0;
+
+void registrar(const char* formato, ...) __attribute__((format(printf, 1, 2)));
+
+void registrar(const char* formato, ...) {
+    fprintf(stderr, "[%10.3f ms] ", relojUs / 1000.0);
+    va_list args;
+    va_start(args, formato);
+    vfprintf(stderr, formato, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+void mostrarResumen() {
+    fprintf(stderr, "Simulacion: %.3f s virtuales, %llu vueltas de loop(), %llu bytes enviados, %llu recibidos\n",
+            relojUs / 1e6, vueltasLoop, bytesEnviados, bytesRecibidos);
+    if (!estadisticas) return;
+
+    fprintf(stderr, "loop(): promedio %.1f us, maximo %.1f ms\n",
+            vueltasLoop ? (double)sumaLoopUs / vueltasLoop : 0.0, maxLoopUs / 1000.0);
+    fprintf(stderr, "%-10s %8s %14s %14s\n", "sensor", "disparos", "periodo(ms)", "maximo(ms)");
+    for (const SensorUltrasonico& s : sensores) {
+        double promedio = s.disparos > 1 ? s.sumaIntervalos / 1000.0 / (s.disparos - 1) : 0.0;
+        fprintf(stderr, "%-10s %8llu %14.1f %14.1f\n", s.nombre.c_str(), s.disparos, promedio, s.maxIntervalo / 1000.0);
+    }
+}
+
+bool pcintActivo(const SensorUltrasonico& s) {
+    int bit = s.echo - PRIMER_PIN_PUERTO_K;
+    return bit >= 0 && bit < 8 && (PCICR & (1 << PCIE2)) && (PCMSK2 & (1 << bit));
+}
+
+// Siguiente flanco de eco que dispara PCINT2 antes de 'destino', o NULL
+SensorUltrasonico* siguienteFlanco(unsigned long long destino, unsigned long long& momento) {
+    SensorUltrasonico* elegido = NULL;
+    for (SensorUltrasonico& s : sensores) {
+        if (!pcintActivo(s)) continue;
+        unsigned long long t;
+        if (s.subidaPendiente) t = s.inicioEco;
+        else if (s.bajadaPendiente) t = s.finEco;
+        else continue;
+        if (t <= destino && (elegido == NULL || t < momento)) {
+            elegido = &s;
+            momento = t;
+        }
+    }
+    return elegido;
+}
+
+// Acumula bytes de una direccion y los registra por linea completa
+void trazarSerial(string& linea, const char* direccion, char c) {
+    if (c == '\n') {
+        registrar("serial %s %s", direccion, linea.c_str());
+        linea.clear();
+    } else if (c != '\r') {
+        linea += c;
+    }
+}
+
+// Avanza el reloj virtual y, si hay velocidad, espera el tiempo real equivalente.
+// Los flancos de eco que caen en el intervalo ejecutan la ISR en su instante.
+void avanzar(unsigned long long us) {
+    unsigned long long destino = relojUs + us;
+    if (simuladorPcint2 != NULL && interrupcionesHabilitadas && !enInterrupcion) {
+        SensorUltrasonico* s;
+        unsigned long long momento = 0;
+        while ((s = siguienteFlanco(destino, momento)) != NULL) {
+            if (momento > relojUs) relojUs = momento;
+            if (s->subidaPendiente) s->subidaPendiente = false;
+            else s->bajadaPendiente = false;
+            enInterrupcion = true;
+            simuladorPcint2();
+            enInterrupcion = false;
+        }
+    }
+    if (destino > relojUs) relojUs = destino;
+    if (duracionUs != 0 && relojUs >= duracionUs) {
+        fflush(stdout);
+        exit(0);
+    }
+    if (velocidad <= 0) return;
+
+    timespec ahora;
+    clock_gettime(CLOCK_MONOTONIC, &ahora);
+    double realUs = (ahora.tv_sec - inicioReal.tv_sec) * 1e6 + (ahora.tv_nsec - inicioReal.tv_nsec) / 1e3;
+    double objetivoUs = relojUs / velocidad;
+    if (objetivoUs - realUs > 1000) {
+        double espera = objetivoUs - realUs;
+        timespec pausa;
+        pausa.tv_sec = (time_t)(espera / 1e6);
+        pausa.tv_nsec = (long)fmod(espera * 1000, 1e9);
+        nanosleep(&pausa, NULL);
+    }
+}
+
+SensorUltrasonico* sensorPorTrig(int pin) {
+    for (SensorUltrasonico& s : sensores) if (s.trig == pin) return &s;
+    return NULL;
+}
+
+SensorUltrasonico* sensorPorEcho(int pin) {
+    for (SensorUltrasonico& s : sensores) if (s.echo == pin) return &s;
+    return NULL;
+}
+
+SensorUltrasonico* sensorPorNombre(const string& nombre) {
+    for (SensorUltrasonico& s : sensores) if (s.nombre == nombre) return &s;
+    return NULL;
+}
+
+long distanciaActual(const SensorUltrasonico& s) {
+    unsigned long ms = (unsigned long)(relojUs / 1000);
+    long cm = 200;
+    for (const auto& paso : s.perfil) {
+        if (paso.first > ms) break;
+        cm = paso.second;
+    }
+    return cm;
+}
+
+// Flanco de bajada del trigger: programa el pulso de eco segun la distancia
+void disparar(SensorUltrasonico& s) {
+    long cm = distanciaActual(s);
+    if (s.ruidoPorcentaje > 0 && (int)(generadorRuido() % 100) < s.ruidoPorcentaje) {
+        cm = s.ruidoCm;
+    }
+    unsigned long duracion = ECO_SIN_OBJETO_US;
+    if (cm > 0 && cm <= ALCANCE_MAXIMO_CM) {
+        duracion = (unsigned long)ceil(cm * 2 / 0.034);
+    }
+    s.disparado = true;
+    s.inicioEco = relojUs + LATENCIA_ECO_US;
+    s.finEco = s.inicioEco + duracion;
+    s.subidaPendiente = true;
+    s.bajadaPendiente = true;
+
+    if (s.disparos > 0) {
+        unsigned long long intervalo = relojUs - s.ultimoDisparo;
+        s.sumaIntervalos += intervalo;
+        if (intervalo > s.maxIntervalo) s.maxIntervalo = intervalo;
+    }
+    s.disparos++;
+    s.ultimoDisparo = relojUs;
+}
+
+// Lo que manda la PC: primero los envios del perfil que ya tocan, luego el pty
+void leerPty() {
+    while (siguienteEnvioPc < enviosPc.size() && enviosPc[siguienteEnvioPc].first <= relojUs / 1000) {
+        string texto = enviosPc[siguienteEnvioPc++].second + "\n";
+        for (char c : texto) {
+            recibidos.push_back(c);
+            if (traza) trazarSerial(lineaRecibida, "<-", c);
+        }
+        bytesRecibidos += texto.size();
+    }
+    if (ptyMaestro < 0) return;
+    char buffer[256];
+    ssize_t n;
+    while ((n = read(ptyMaestro, buffer, sizeof(buffer))) > 0) {
+        for (ssize_t i = 0; i < n; i++) {
+            recibidos.push_back(buffer[i]);
+            if (traza) trazarSerial(lineaRecibida, "<-", buffer[i]);
+        }
+        bytesRecibidos += n;
+    }
+}
+
+int esperarCaracter() {
+    unsigned long long limite = relojUs + timeoutSerialMs * 1000ULL;
+    while (true) {
+        leerPty();
+        if (!recibidos.empty()) return (unsigned char)recibidos.front();
+        if (relojUs >= limite) return -1;
+        avanzar(1000);
+    }
+}
+
+void cargarPerfil(const char* ruta) {
+    ifstream archivo(ruta);
+    if (!archivo) {
+        fprintf(stderr, "No se pudo abrir el perfil %s\n", ruta);
+        exit(1);
+    }
+    string linea;
+    int numero = 0;
+    while (getline(archivo, linea)) {
+        numero++;
+        size_t comentario = linea.find('#');
+        if (comentario != string::npos) linea.erase(comentario);
+        istringstream iss(linea);
+        string primero;
+        if (!(iss >> primero)) continue;
+
+        if (primero == "sensor") {
+            SensorUltrasonico s;
+            long inicial = 200;
+            if (!(iss >> s.nombre >> s.trig >> s.echo)) {
+                fprintf(stderr, "%s:%d: sensor incompleto\n", ruta, numero);
+                exit(1);
+            }
+            iss >> inicial;
+            s.perfil.push_back(make_pair(0UL, inicial));
+            s.ruidoPorcentaje = 0;
+            s.ruidoCm = 0;
+            s.trigAlto = false;
+            s.disparado = false;
+            s.inicioEco = s.finEco = 0;
+            s.subidaPendiente = s.bajadaPendiente = false;
+            s.disparos = s.ultimoDisparo = s.sumaIntervalos = s.maxIntervalo = 0;
+            sensores.push_back(s);
+        } else if (primero == "ruido") {
+            string nombre;
+            SensorUltrasonico* s = NULL;
+            int porcentaje;
+            long cm;
+            if (!(iss >> nombre >> porcentaje >> cm) || (s = sensorPorNombre(nombre)) == NULL) {
+                fprintf(stderr, "%s:%d: ruido invalido\n", ruta, numero);
+                exit(1);
+            }
+            s->ruidoPorcentaje = porcentaje;
+            s->ruidoCm = cm;
+        } else if (primero == "pc") {
+            unsigned long ms;
+            string texto;
+            if (!(iss >> ms >> texto)) {
+                fprintf(stderr, "%s:%d: pc invalido\n", ruta, numero);
+                exit(1);
+            }
+            enviosPc.push_back(make_pair(ms, texto));
+        } else if (primero == "fin") {
+            unsigned long ms;
+            if (iss >> ms) duracionUs = ms * 1000ULL;
+        } else {
+            string nombre;
+            long cm;
+            SensorUltrasonico* s = NULL;
+            if (!(iss >> nombre >> cm) || (s = sensorPorNombre(nombre)) == NULL) {
+                fprintf(stderr, "%s:%d: linea invalida\n", ruta, numero);
+                exit(1);
+            }
+            s->perfil.push_back(make_pair(strtoul(primero.c_str(), NULL, 10), cm));
+        }
+    }
+    stable_sort(enviosPc.begin(), enviosPc.end(),
+                [](const pair<unsigned long, string>& a, const pair<unsigned long, string>& b) {
+                    return a.first < b.first;
+                });
+    for (SensorUltrasonico& s : sensores) {
+        stable_sort(s.perfil.begin(), s.perfil.end(),
+                    [](const pair<unsigned long, long>& a, const pair<unsigned long, long>& b) {
+                        return a.first < b.first;
+                    });
+    }
+}
+
+void abrirPty(const char* enlace, bool esperar) {
+    ptyMaestro = posix_openpt(O_RDWR | O_NOCTTY);
+    if (ptyMaestro < 0 || grantpt(ptyMaestro) != 0 || unlockpt(ptyMaestro) != 0) {
+        perror("posix_openpt");
+        exit(1);
+    }
+    termios modo;
+    tcgetattr(ptyMaestro, &modo);
+    cfmakeraw(&modo);
+    tcsetattr(ptyMaestro, TCSANOW, &modo);
+    fcntl(ptyMaestro, F_SETFL, fcntl(ptyMaestro, F_GETFL) | O_NONBLOCK);
+
+    const char* esclavo = ptsname(ptyMaestro);
+    fprintf(stderr, "Serial simulado en %s\n", esclavo);
+    if (enlace != NULL) {
+        unlink(enlace);
+        if (symlink(esclavo, enlace) != 0) perror("symlink");
+    }
+
+    if (esperar) {
+        // El maestro reporta POLLHUP mientras nadie tenga abierto el esclavo,
+        // pero solo despues de la primera apertura: se abre y cierra una vez.
+        close(open(esclavo, O_RDWR | O_NOCTTY));
+        fprintf(stderr, "Esperando que el controlador abra el puerto...\n");
+        while (true) {
+            pollfd p = {ptyMaestro, POLLIN, 0};
+            poll(&p, 1, 100);
+            if (!(p.revents & POLLHUP)) break;
+        }
+    }
+}
+
+} // namespace
+
+// --------------------------- Pines y tiempo ------------------------------
+void pinMode(int pin, int modo) {
+    if (pin < 0 || pin >= TOTAL_PINES) return;
+    modoPin[pin] = modo;
+    if (modo == INPUT_PULLUP) estadoPin[pin] = HIGH;
+}
+
+void digitalWrite(int pin, int valor) {
+    if (pin < 0 || pin >= TOTAL_PINES) return;
+    valor = valor ? HIGH : LOW;
+    SensorUltrasonico* s = sensorPorTrig(pin);
+    if (s != NULL) {
+        if (s->trigAlto && valor == LOW) disparar(*s);
+        s->trigAlto = (valor == HIGH);
+    } else if (traza && estadoPin[pin] != valor) {
+        registrar("pin %d %s", pin, valor ? "HIGH" : "LOW");
+    }
+    estadoPin[pin] = valor;
+}
+
+int digitalRead(int pin) {
+    if (pin < 0 || pin >= TOTAL_PINES) return LOW;
+    SensorUltrasonico* s = sensorPorEcho(pin);
+    if (s != NULL) {
+        return (relojUs >= s->inicioEco && relojUs < s->finEco) ? HIGH : LOW;
+    }
+    return estadoPin[pin];
+}
+
+unsigned long pulseIn(int pin, int estado, unsigned long timeout) {
+    SensorUltrasonico* s = sensorPorEcho(pin);
+    unsigned long long inicio = relojUs;
+
+    // Solo se modelan pulsos HIGH de eco que empiezan despues de la llamada
+    if (s == NULL || estado != HIGH || !s->disparado || s->inicioEco < inicio ||
+        s->finEco - inicio > timeout) {
+        avanzar(timeout);
+        return 0;
+    }
+    avanzar(s->finEco - inicio);
+    s->disparado = false;
+    return (unsigned long)(s->finEco - s->inicioEco);
+}
+
+uint8_t simuladorLeerPuertoK() {
+    uint8_t puerto = 0;
+    for (int bit = 0; bit < 8; bit++) {
+        if (digitalRead(PRIMER_PIN_PUERTO_K + bit) == HIGH) puerto |= (uint8_t)(1 << bit);
+    }
+    return puerto;
+}
+
+void noInterrupts() {
+    interrupcionesHabilitadas = false;
+}
+
+// Como con la bandera PCIF del AVR, los flancos ocurridos con las
+// interrupciones apagadas se atienden (una vez) al volver a encenderlas
+void interrupts() {
+    interrupcionesHabilitadas = true;
+    avanzar(0);
+}
+
+void delay(unsigned long ms) {
+    avanzar(ms * 1000ULL);
+}
+
+void delayMicroseconds(unsigned int us) {
+    avanzar(us);
+}
+
+unsigned long millis() {
+    avanzar(COSTO_RELOJ_US);
+    return (unsigned long)(relojUs / 1000);
+}
+
+unsigned long micros() {
+    avanzar(COSTO_RELOJ_US);
+    return (unsigned long)relojUs;
+}
+
+// --------------------------- Servo ------------------------------
+uint8_t Servo::attach(int p) {
+    pin = p;
+    return 1;
+}
+
+void Servo::write(int valor) {
+    if (valor < 0) valor = 0;
+    if (valor > 180) valor = 180;
+    if (traza && valor != angulo) registrar("servo %d -> %d", pin, valor);
+    angulo = valor;
+}
+
+// --------------------------- Serial ------------------------------
+void HardwareSerial::begin(unsigned long baud) {
+    baudios = baud;
+}
+
+int HardwareSerial::available() {
+    leerPty();
+    return (int)recibidos.size();
+}
+
+int HardwareSerial::read() {
+    leerPty();
+    if (recibidos.empty()) return -1;
+    int c = (unsigned char)recibidos.front();
+    recibidos.pop_front();
+    return c;
+}
+
+int HardwareSerial::peek() {
+    leerPty();
+    return recibidos.empty() ? -1 : (unsigned char)recibidos.front();
+}
+
+void HardwareSerial::flush() {
+    if (txLibreUs > relojUs) avanzar(txLibreUs - relojUs);
+}
+
+void HardwareSerial::setTimeout(unsigned long ms) {
+    timeoutSerialMs = ms;
+}
+
+// Igual que Stream::parseInt(): salta lo que no sea digito o '-', y
+// regresa 0 si se agota el timeout sin encontrar un numero
+long HardwareSerial::parseInt() {
+    int c;
+    do {
+        c = esperarCaracter();
+        if (c < 0) return 0;
+        if (c == '-' || (c >= '0' && c <= '9')) break;
+        recibidos.pop_front();
+    } while (true);
+
+    bool negativo = false;
+    long valor = 0;
+    while (true) {
+        if (c == '-') negativo = true;
+        else if (c >= '0' && c <= '9') valor = valor * 10 + (c - '0');
+        else break;
+        recibidos.pop_front();
+        c = esperarCaracter();
+        if (c < 0) break;
+    }
+    return negativo ? -valor : valor;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    // A 9600 baudios cada byte ocupa ~1 ms; con el buffer de 64 bytes lleno
+    // el sketch se bloquea igual que en la placa
+    unsigned long long costo = 10000000ULL / baudios;
+    if (txLibreUs < relojUs) txLibreUs = relojUs;
+    txLibreUs += costo;
+    if (txLibreUs - relojUs > 64 * costo) avanzar(txLibreUs - relojUs - 64 * costo);
+
+    if (ptyMaestro >= 0) {
+        ssize_t n = ::write(ptyMaestro, &c, 1);
+        (void)n;  // sin lector el byte se pierde, como en el USB de la placa
+    }
+    bytesEnviados++;
+    if (traza) trazarSerial(lineaEnviada, "->", (char)c);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* datos, size_t n) {
+    for (size_t i = 0; i < n; i++) write(datos[i]);
+    return n;
+}
+
+size_t HardwareSerial::write(const char* texto) {
+    return write((const uint8_t*)texto, strlen(texto));
+}
+
+size_t HardwareSerial::print(const char* texto) {
+    return write(texto);
+}
+
+size_t HardwareSerial::print(char c) {
+    return write((const uint8_t*)&c, 1);
+}
+
+size_t HardwareSerial::print(long n, int base) {
+    if (base == DEC) {
+        char texto[24];
+        snprintf(texto, sizeof(texto), "%ld", n);
+        return write(texto);
+    }
+    return print((unsigned long)n, base);
+}
+
+size_t HardwareSerial::print(unsigned long n, int base) {
+    char texto[72];
+    int i = sizeof(texto) - 1;
+    texto[i] = '\0';
+    if (base < 2) base = DEC;
+    do {
+        int digito = (int)(n % base);
+        texto[--i] = (char)(digito < 10 ? '0' + digito : 'A' + digito - 10);
+        n /= base;
+    } while (n > 0);
+    return write(texto + i);
+}
+
+size_t HardwareSerial::print(int n, int base) {
+    return print((long)n, base);
+}
+
+size_t HardwareSerial::print(unsigned int n, int base) {
+    return print((unsigned long)n, base);
+}
+
+size_t HardwareSerial::print(double n, int digitos) {
+    char texto[48];
+    snprintf(texto, sizeof(texto), "%.*f", digitos, n);
+    return write(texto);
+}
+
+size_t HardwareSerial::println() {
+    return write("\r\n");
+}
+
+// --------------------------- Principal ------------------------------
+int main(int argc, char* argv[]) {
+    const char* perfil = NULL;
+    const char* enlace = NULL;
+    unsigned long long duracionArg = 0;
+    bool esperar = false;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--perfil" && i + 1 < argc) perfil = argv[++i];
+        else if (arg == "--velocidad" && i + 1 < argc) velocidad = atof(argv[++i]);
+        else if (arg == "--duracion" && i + 1 < argc) duracionArg = strtoull(argv[++i], NULL, 10) * 1000ULL;
+        else if (arg == "--enlace" && i + 1 < argc) enlace = argv[++i];
+        else if (arg == "--esperar") esperar = true;
+        else if (arg == "--traza") traza = true;
+        else if (arg == "--estadisticas") estadisticas = true;
+        else {
+            fprintf(stderr, "Uso: %s [--perfil archivo] [--velocidad N] [--duracion ms] "
+                            "[--enlace ruta] [--esperar] [--traza] [--estadisticas]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (perfil != NULL) cargarPerfil(perfil);
+    if (duracionArg != 0) duracionUs = duracionArg;
+    abrirPty(enlace, esperar);
+    atexit(mostrarResumen);
+    clock_gettime(CLOCK_MONOTONIC, &inicioReal);
+
+    setup();
+    while (true) {
+        unsigned long long inicio = relojUs;
+        loop();
+        avanzar(COSTO_LOOP_US);
+        unsigned long long duracion = relojUs - inicio;
+        sumaLoopUs += duracion;
+        if (duracion > maxLoopUs) maxLoopUs = duracion;
+        vueltasLoop++;
+    }
+}
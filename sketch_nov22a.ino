@@ -15,6 +15,36 @@ int echoSalida = 6;
 bool autoEntradaDetectado = false;
 bool autoSalidaDetectado = false;
 
+// PLUMAS: máquina de estados avanzada desde loop() con millis()
+const int ANGULO_CERRADA = 45;
+const int ANGULO_ABIERTA = 180;
+const unsigned long MS_POR_GRADO = 15;
+const unsigned long TIEMPO_AVISO = 500;    // LED encendido antes de mover la pluma
+const unsigned long TIEMPO_ABIERTA = 500;
+
+enum EstadoPluma { PLUMA_CERRADA, PLUMA_AVISO, PLUMA_ABRIENDO, PLUMA_ABIERTA, PLUMA_CERRANDO };
+
+struct Pluma {
+  Servo* servo;
+  int led;
+  bool* autoDetectado;
+  EstadoPluma estado;
+  int angulo;
+  int anguloInicio;
+  unsigned long marca;
+};
+
+Pluma entrada = { &servoEntrada, ledVerde, &autoEntradaDetectado, PLUMA_CERRADA, ANGULO_CERRADA, ANGULO_CERRADA, 0 };
+Pluma salida = { &servoSalida, ledAzul, &autoSalidaDetectado, PLUMA_CERRADA, ANGULO_CERRADA, ANGULO_CERRADA, 0 };
+
+const unsigned long PERIODO_LECTURA = 60;
+unsigned long ultimaLectura = 0;
+unsigned long inicioParpadeo = 0;
+bool parpadeando = false;
+
+long codigoSerial = 0;
+bool hayDigitos = false;
+
 long medirDistancia(int trig, int echo) {
   digitalWrite(trig, LOW);
   delayMicroseconds(2);
@@ -43,12 +73,44 @@ void setup() {
   servoEntrada.attach(9);
   servoSalida.attach(8);
 
-  servoEntrada.write(45);
-  servoSalida.write(45);
+  servoEntrada.write(ANGULO_CERRADA);
+  servoSalida.write(ANGULO_CERRADA);
 }
 
 void loop() {
 
+  // -------- PLUMAS --------
+  actualizarPluma(entrada);
+  actualizarPluma(salida);
+
+  if (parpadeando && millis() - inicioParpadeo >= 500) {
+    digitalWrite(ledVerde, LOW);
+    digitalWrite(ledAzul, LOW);
+    parpadeando = false;
+  }
+
+  // -------- LECTURA SERIAL --------
+  switch (leerCodigoSerial()) {
+    case 1:   // operador autorizó ENTRADA
+      abrirPluma(entrada);
+      break;
+
+    case 2:   // operador autorizó SALIDA
+      abrirPluma(salida);
+      break;
+    case 0:
+      digitalWrite(ledVerde, HIGH);
+      digitalWrite(ledAzul, HIGH);
+      inicioParpadeo = millis();
+      parpadeando = true;
+      break;
+  }
+
+  if (millis() - ultimaLectura < PERIODO_LECTURA) {
+    return;
+  }
+  ultimaLectura = millis();
+
   // -------- SENSOR ENTRADA --------
   long dEntrada = medirDistancia(trigEntrada, echoEntrada);
 
@@ -64,61 +126,80 @@ void loop() {
       Serial.println(30);       // Aviso a la PC
       autoSalidaDetectado = true;
   }
-
-  // -------- LECTURA SERIAL --------
-  if (Serial.available()) {
-    int codigo = Serial.parseInt();
-
-    switch (codigo) {
-      case 1:   // operador autorizó ENTRADA
-        digitalWrite(ledVerde, HIGH);
-        delay (500);
-        digitalWrite(ledVerde, LOW);
-        plumaEntrada();
-        autoEntradaDetectado = false;
-        break;
-
-      case 2:   // operador autorizó SALIDA
-        digitalWrite(ledAzul, HIGH);
-        delay (500);
-        digitalWrite(ledAzul, LOW);
-        plumaSalida();
-        autoSalidaDetectado = false;
-        break;
-      case 0:
-        digitalWrite(ledVerde, HIGH);
-        digitalWrite(ledAzul, HIGH);
-        delay (500);
-        digitalWrite(ledVerde, LOW);
-        digitalWrite(ledAzul, LOW);
-        delay (500);
-    }
-  }
-
-  delay(60);
 }
 
 // ----------------- FUNCIONES -----------------
-void plumaEntrada() {
-  for (int a = 45; a <= 180; a++) {
-    servoEntrada.write(a);
-    delay(15);
-  }
-  delay(500);
-  for (int a = 180; a >= 45; a--) {
-    servoEntrada.write(a);
-    delay(15);
+void cambiarEstado(Pluma& pluma, EstadoPluma estado) {
+  pluma.estado = estado;
+  pluma.anguloInicio = pluma.angulo;
+  pluma.marca = millis();
+}
+
+void abrirPluma(Pluma& pluma) {
+  if (pluma.estado == PLUMA_ABIERTA) {
+    pluma.marca = millis();           // otro auto: mantener abierta
+  } else if (pluma.estado == PLUMA_CERRANDO) {
+    cambiarEstado(pluma, PLUMA_ABRIENDO);
+  } else if (pluma.estado == PLUMA_CERRADA) {
+    digitalWrite(pluma.led, HIGH);
+    cambiarEstado(pluma, PLUMA_AVISO);
   }
 }
 
-void plumaSalida() {
-  for (int a = 45; a <= 180; a++) {
-    servoSalida.write(a);
-    delay(15);
+void actualizarPluma(Pluma& pluma) {
+  unsigned long transcurrido = millis() - pluma.marca;
+  int grados = transcurrido / MS_POR_GRADO;
+
+  switch (pluma.estado) {
+    case PLUMA_CERRADA:
+      return;
+
+    case PLUMA_AVISO:
+      if (transcurrido >= TIEMPO_AVISO) {
+        digitalWrite(pluma.led, LOW);
+        cambiarEstado(pluma, PLUMA_ABRIENDO);
+      }
+      return;
+
+    case PLUMA_ABRIENDO:
+      if (pluma.anguloInicio + grados >= ANGULO_ABIERTA) {
+        pluma.angulo = ANGULO_ABIERTA;
+        cambiarEstado(pluma, PLUMA_ABIERTA);
+      } else {
+        pluma.angulo = pluma.anguloInicio + grados;
+      }
+      break;
+
+    case PLUMA_ABIERTA:
+      if (transcurrido >= TIEMPO_ABIERTA) cambiarEstado(pluma, PLUMA_CERRANDO);
+      return;
+
+    case PLUMA_CERRANDO:
+      if (pluma.anguloInicio - grados <= ANGULO_CERRADA) {
+        pluma.angulo = ANGULO_CERRADA;
+        cambiarEstado(pluma, PLUMA_CERRADA);
+        *pluma.autoDetectado = false;
+      } else {
+        pluma.angulo = pluma.anguloInicio - grados;
+      }
+      break;
   }
-  delay(500);
-  for (int a = 180; a >= 45; a--) {
-    servoSalida.write(a);
-    delay(15);
+  pluma.servo->write(pluma.angulo);
+}
+
+// Código de la PC terminado en salto de línea, sin esperar como parseInt()
+long leerCodigoSerial() {
+  while (Serial.available()) {
+    char c = Serial.read();
+    if (c >= '0' && c <= '9') {
+      codigoSerial = codigoSerial * 10 + (c - '0');
+      hayDigitos = true;
+    } else if (c == '\n') {
+      long codigo = hayDigitos ? codigoSerial : -1;
+      codigoSerial = 0;
+      hayDigitos = false;
+      if (codigo != -1) return codigo;
+    }
   }
-}
\ No newline at end of file
+  return -1;
+}
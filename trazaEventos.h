@@ -0,0 +1,129 @@
+#ifndef TRAZA_EVENTOS_H
+#define TRAZA_EVENTOS_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+// ==================== TRAZA DE EVENTOS ====================
+// Diagnostico que se puede dejar encendido: cada evento es un registro
+// binario de 32 bytes en un buffer circular propio del hilo (sin candados ni
+// formateo). volcarTraza() escribe los buffers a un archivo y
+// benchmark/decodificarTraza lo convierte a texto despues.
+//
+// Los niveles debajo de TRAZA_NIVEL_MINIMO desaparecen al compilar:
+//   cl /DTRAZA_NIVEL_MINIMO=2 ...   (solo AVISO y ERROR)
+
+#define TRAZA_DETALLE 0
+#define TRAZA_INFO    1
+#define TRAZA_AVISO   2
+#define TRAZA_ERROR   3
+
+#ifndef TRAZA_NIVEL_MINIMO
+#define TRAZA_NIVEL_MINIMO TRAZA_DETALLE
+#endif
+
+// Catalogo de eventos: el decodificador usa los mismos textos. Los
+// argumentos a y b son enteros; 'texto' guarda hasta 8 bytes crudos.
+enum EventoTraza : uint16_t {
+    EV_SERIAL_BYTES,     // a = bytes leidos, texto = primeros bytes
+    EV_SERIAL_DATO,      // a = largo del dato sin saltos de linea, texto = dato
+    EV_CODIGO,           // a = codigo numerico interpretado
+    EV_LUGAR_REVISADO,   // a = lugar (1..), b = 1 si esta ocupado
+    EV_LUGAR_ASIGNADO,   // a = lugar (1..)
+    EV_SIN_LUGARES,      // a = lugares revisados
+    TOTAL_EVENTOS_TRAZA
+};
+
+const char* const NOMBRES_EVENTO_TRAZA[TOTAL_EVENTOS_TRAZA] = {
+    "serial_bytes", "serial_dato", "codigo", "lugar_revisado", "lugar_asignado", "sin_lugares"
+};
+
+const char* const NOMBRES_NIVEL_TRAZA[] = {"DETALLE", "INFO", "AVISO", "ERROR"};
+
+struct RegistroEvento {
+    uint64_t nanosegundos;  // reloj monotono
+    uint16_t evento;
+    uint8_t nivel;
+    uint8_t largoTexto;
+    uint32_t hilo;
+    int32_t a;
+    int32_t b;
+    char texto[8];
+};
+static_assert(sizeof(RegistroEvento) == 32, "el formato del archivo depende del tamanio");
+
+const char CABECERA_TRAZA_EVENTOS[4] = {'E', 'V', 'T', '1'};
+const uint32_t CAPACIDAD_TRAZA = 4096;  // registros por hilo (128 KB)
+
+struct BufferTraza {
+    RegistroEvento registros[CAPACIDAD_TRAZA];
+    uint64_t escritos;
+    uint32_t hilo;
+};
+
+// Los buffers viven hasta el final del proceso, asi se pueden volcar
+// aunque su hilo ya haya terminado
+inline vector<BufferTraza*>& buffersTraza() {
+    static vector<BufferTraza*> buffers;
+    return buffers;
+}
+
+inline mutex& candadoTraza() {
+    static mutex candado;
+    return candado;
+}
+
+inline BufferTraza* registrarHiloTraza() {
+    BufferTraza* buffer = new BufferTraza();
+    lock_guard<mutex> guardia(candadoTraza());
+    buffer->escritos = 0;
+    buffer->hilo = (uint32_t)buffersTraza().size();
+    buffersTraza().push_back(buffer);
+    return buffer;
+}
+
+inline void trazarEvento(uint8_t nivel, EventoTraza evento, int32_t a, int32_t b,
+                         const char* texto = nullptr, size_t largo = 0) {
+    thread_local BufferTraza* buffer = registrarHiloTraza();
+    RegistroEvento& r = buffer->registros[buffer->escritos % CAPACIDAD_TRAZA];
+    r.nanosegundos = (uint64_t)chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+    r.evento = evento;
+    r.nivel = nivel;
+    r.hilo = buffer->hilo;
+    r.a = a;
+    r.b = b;
+    r.largoTexto = (uint8_t)(largo < sizeof(r.texto) ? largo : sizeof(r.texto));
+    if (r.largoTexto > 0) memcpy(r.texto, texto, r.largoTexto);
+    buffer->escritos++;
+}
+
+#define TRAZAR(nivel, evento, a, b) \
+    do { if ((nivel) >= TRAZA_NIVEL_MINIMO) trazarEvento((nivel), (evento), (a), (b)); } while (0)
+
+#define TRAZAR_TEXTO(nivel, evento, a, b, texto, largo) \
+    do { if ((nivel) >= TRAZA_NIVEL_MINIMO) trazarEvento((nivel), (evento), (a), (b), (texto), (largo)); } while (0)
+
+// Escribe lo que queda en los buffers de todos los hilos (los ultimos
+// CAPACIDAD_TRAZA eventos de cada uno). Llamar con los demas hilos quietos.
+inline bool volcarTraza(const char* ruta) {
+    FILE* archivo = fopen(ruta, "wb");
+    if (archivo == nullptr) return false;
+    fwrite(CABECERA_TRAZA_EVENTOS, 1, sizeof(CABECERA_TRAZA_EVENTOS), archivo);
+    lock_guard<mutex> guardia(candadoTraza());
+    for (BufferTraza* buffer : buffersTraza()) {
+        uint64_t desde = buffer->escritos > CAPACIDAD_TRAZA ? buffer->escritos - CAPACIDAD_TRAZA : 0;
+        for (uint64_t i = desde; i < buffer->escritos; i++) {
+            fwrite(&buffer->registros[i % CAPACIDAD_TRAZA], sizeof(RegistroEvento), 1, archivo);
+        }
+    }
+    return fclose(archivo) == 0;
+}
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef TRAZA_SERIAL_H
+#define TRAZA_SERIAL_H
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "histogramaLatencia.h"
+
+using namespace std;
+
+// ==================== TRAZA SERIAL ====================
+// Archivo binario con cada trama (linea sin '\n') que cruza el puerto serial.
+//   cabecera: "TRZ1"
+//   registro: varint(us desde el registro anterior), byte(direccion),
+//             varint(longitud), bytes de la trama
+// Direccion: 0 = llego del MEGA, 1 = se envio al MEGA. Un "40" ocupa ~6 bytes.
+
+const char CABECERA_TRAZA[4] = {'T', 'R', 'Z', '1'};
+
+struct RegistroTraza {
+    uint64_t microsegundos;  // desde el inicio de la grabacion
+    bool haciaMega;
+    string trama;
+};
+
+class GrabadorTraza {
+private:
+    FILE* archivo;
+    string pendiente;  // se escribe en vaciar(), fuera del camino de cada trama
+    uint64_t inicio;
+    uint64_t anterior;  // us desde el inicio del registro anterior
+
+    void escribirVarint(uint64_t valor) {
+        while (valor >= 0x80) {
+            pendiente += (char)((valor & 0x7F) | 0x80);
+            valor >>= 7;
+        }
+        pendiente += (char)valor;
+    }
+
+public:
+    GrabadorTraza() : archivo(nullptr), inicio(0), anterior(0) {}
+
+    bool abrir(const string& ruta) {
+        archivo = fopen(ruta.c_str(), "wb");
+        if (archivo == nullptr) return false;
+        fwrite(CABECERA_TRAZA, 1, sizeof(CABECERA_TRAZA), archivo);
+        inicio = microsegundosAhora();
+        anterior = 0;
+        return true;
+    }
+
+    bool activo() const {
+        return archivo != nullptr;
+    }
+
+    void registrar(bool haciaMega, const string& trama) {
+        registrar(haciaMega, trama.data(), trama.size());
+    }
+
+    // Sin armar un string: la linea del DecodificadorMega tal cual
+    void registrar(bool haciaMega, const char* trama, size_t largo) {
+        if (archivo == nullptr) return;
+        registrarEn(microsegundosAhora() - inicio, haciaMega, trama, largo);
+    }
+
+    // Con un instante propio (us desde el inicio), para trazas sinteticas
+    void registrarEn(uint64_t microsegundos, bool haciaMega, const string& trama) {
+        registrarEn(microsegundos, haciaMega, trama.data(), trama.size());
+    }
+
+    void registrarEn(uint64_t microsegundos, bool haciaMega, const char* trama, size_t largo) {
+        if (archivo == nullptr) return;
+        escribirVarint(microsegundos - anterior);
+        anterior = microsegundos;
+        pendiente += (char)(haciaMega ? 1 : 0);
+        escribirVarint(largo);
+        pendiente.append(trama, largo);
+    }
+
+    void vaciar() {
+        if (archivo == nullptr || pendiente.empty()) return;
+        fwrite(pendiente.data(), 1, pendiente.size(), archivo);
+        fflush(archivo);
+        pendiente.clear();
+    }
+
+    ~GrabadorTraza() {
+        vaciar();
+        if (archivo != nullptr) fclose(archivo);
+    }
+};
+
+// Lee una traza completa; false si el archivo no existe o esta truncado
+inline bool leerTraza(const string& ruta, vector<RegistroTraza>& registros) {
+    FILE* archivo = fopen(ruta.c_str(), "rb");
+    if (archivo == nullptr) return false;
+
+    char cabecera[sizeof(CABECERA_TRAZA)];
+    bool valida = fread(cabecera, 1, sizeof(cabecera), archivo) == sizeof(cabecera) &&
+                  string(cabecera, sizeof(cabecera)) == string(CABECERA_TRAZA, sizeof(CABECERA_TRAZA));
+
+    auto leerVarint = [archivo](uint64_t& valor) {
+        valor = 0;
+        for (int corrimiento = 0; corrimiento < 64; corrimiento += 7) {
+            int c = fgetc(archivo);
+            if (c == EOF) return false;
+            valor |= (uint64_t)(c & 0x7F) << corrimiento;
+            if (!(c & 0x80)) return true;
+        }
+        return false;
+    };
+
+    uint64_t reloj = 0, delta, longitud;
+    while (valida && leerVarint(delta)) {
+        int direccion = fgetc(archivo);
+        if (direccion == EOF || !leerVarint(longitud) || longitud > 4096) {
+            valida = false;
+            break;
+        }
+        RegistroTraza r;
+        reloj += delta;
+        r.microsegundos = reloj;
+        r.haciaMega = (direccion == 1);
+        r.trama.resize((size_t)longitud);
+        if (longitud > 0 && fread(&r.trama[0], 1, (size_t)longitud, archivo) != longitud) {
+            valida = false;
+            break;
+        }
+        registros.push_back(r);
+    }
+    fclose(archivo);
+    return valida;
+}
+
+#endif
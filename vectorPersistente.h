@@ -0,0 +1,287 @@
+#ifndef VECTOR_PERSISTENTE_H
+#define VECTOR_PERSISTENTE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <functional>
+
+using namespace std;
+
+// ==================== ESTRUCTURAS PERSISTENTES ====================
+// Lo que publica el motor en cada Instantanea (ver estacionamiento.h). Copiar
+// una es copiar la raiz: O(1), sin importar el tamanio del lote. Cambiar un
+// elemento copia solo los nodos de su camino que alguien mas comparte (las
+// instantaneas ya publicadas siguen viendo los originales); si nadie los
+// comparte se cambian en su lugar. Un solo hilo modifica; los lectores solo
+// leen instantaneas publicadas, que nadie vuelve a cambiar.
+
+// Arreglo en un arbol de 16 hijos por nodo: leer y fijar son O(log16 n),
+// 5 niveles para un millon de lugares
+template <class T>
+class VectorPersistente {
+public:
+    static const int BITS = 4;
+    static const size_t ANCHO = (size_t)1 << BITS;
+
+private:
+    struct Hoja {
+        T valores[ANCHO];
+    };
+    struct Interno {
+        shared_ptr<void> hijos[ANCHO];
+    };
+
+    shared_ptr<void> raiz;
+    int niveles;  // nodos internos sobre las hojas
+    size_t tamanio;
+
+    // Copia el nodo si alguien mas lo comparte. Solo el hilo que modifica
+    // crea copias de estos apuntadores, asi que la cuenta no sube mientras
+    // se revisa; si puede bajar, cuando un lector suelta su instantanea en
+    // su hilo. use_count() es una lectura relajada: el cerco de adquisicion
+    // la empareja con el decremento (que libera) del ultimo lector, para
+    // que sus lecturas del nodo queden antes de que aqui se cambie.
+    template <class Nodo>
+    static Nodo* propio(shared_ptr<void>& nodo) {
+        if (nodo.use_count() != 1) {
+            nodo = make_shared<Nodo>(*static_cast<const Nodo*>(nodo.get()));
+        } else {
+            atomic_thread_fence(memory_order_acquire);
+        }
+        return static_cast<Nodo*>(nodo.get());
+    }
+
+    template <class Funcion>
+    void recorrerNodo(const void* nodo, int nivel, size_t base, Funcion& f) const {
+        if (nivel == 0) {
+            const Hoja* hoja = static_cast<const Hoja*>(nodo);
+            for (size_t j = 0; j < ANCHO && base + j < tamanio; j++) f(base + j, hoja->valores[j]);
+            return;
+        }
+        const Interno* interno = static_cast<const Interno*>(nodo);
+        size_t cubiertos = (size_t)1 << (nivel * BITS);
+        for (size_t j = 0; j < ANCHO && base + j * cubiertos < tamanio; j++) {
+            recorrerNodo(interno->hijos[j].get(), nivel - 1, base + j * cubiertos, f);
+        }
+    }
+
+public:
+    VectorPersistente() : niveles(0), tamanio(0) {}
+
+    size_t size() const {
+        return tamanio;
+    }
+
+    const T& operator[](size_t i) const {
+        const void* nodo = raiz.get();
+        for (int nivel = niveles; nivel > 0; nivel--) {
+            nodo = static_cast<const Interno*>(nodo)->hijos[(i >> (nivel * BITS)) & (ANCHO - 1)].get();
+        }
+        return static_cast<const Hoja*>(nodo)->valores[i & (ANCHO - 1)];
+    }
+
+    // n copias de 'valor' en O(log n): cada nivel es un solo nodo compartido
+    void asignar(size_t n, const T& valor) {
+        tamanio = n;
+        niveles = 0;
+        shared_ptr<Hoja> hoja = make_shared<Hoja>();
+        for (size_t j = 0; j < ANCHO; j++) hoja->valores[j] = valor;
+        raiz = hoja;
+        for (size_t cubiertos = ANCHO; cubiertos < n; cubiertos <<= BITS) {
+            shared_ptr<Interno> interno = make_shared<Interno>();
+            for (size_t j = 0; j < ANCHO; j++) interno->hijos[j] = raiz;
+            raiz = interno;
+            niveles++;
+        }
+    }
+
+    // El contenido de un arreglo, O(n); no comparte nada con lo anterior
+    template <class Iterador>
+    void asignar(Iterador inicio, Iterador fin) {
+        vector<shared_ptr<void>> nodos;
+        tamanio = 0;
+        niveles = 0;
+        while (inicio != fin) {
+            shared_ptr<Hoja> hoja = make_shared<Hoja>();
+            for (size_t j = 0; j < ANCHO && inicio != fin; j++, ++inicio, tamanio++) hoja->valores[j] = *inicio;
+            nodos.push_back(hoja);
+        }
+        if (nodos.empty()) nodos.push_back(make_shared<Hoja>());
+        while (nodos.size() > 1) {
+            vector<shared_ptr<void>> padres;
+            for (size_t i = 0; i < nodos.size(); i += ANCHO) {
+                shared_ptr<Interno> interno = make_shared<Interno>();
+                for (size_t j = 0; j < ANCHO && i + j < nodos.size(); j++) interno->hijos[j] = nodos[i + j];
+                padres.push_back(interno);
+            }
+            nodos.swap(padres);
+            niveles++;
+        }
+        raiz = nodos[0];
+    }
+
+    // f(i, valor) por cada elemento en orden; para recorrer todo es mas
+    // barato que operator[], que baja desde la raiz cada vez
+    template <class Funcion>
+    void recorrer(Funcion f) const {
+        if (tamanio > 0) recorrerNodo(raiz.get(), niveles, 0, f);
+    }
+
+    void fijar(size_t i, const T& valor) {
+        shared_ptr<void>* ranura = &raiz;
+        for (int nivel = niveles; nivel > 0; nivel--) {
+            ranura = &propio<Interno>(*ranura)->hijos[(i >> (nivel * BITS)) & (ANCHO - 1)];
+        }
+        propio<Hoja>(*ranura)->valores[i & (ANCHO - 1)] = valor;
+    }
+};
+
+// Ticket -> lugar (indice 0..) sobre un VectorPersistente: direccionamiento
+// abierto con sondeo lineal y borrado por corrimiento, sin lapidas. Cada
+// casilla guarda solo el hash del folio y el lugar; el folio esta en el
+// lugar, asi que buscar recibe los lugares (los vivos o los de la misma
+// instantanea) para confirmarlo, y la tabla no reserva memoria por ticket.
+// Tiene al menos el doble de casillas que tickets: cada operacion revisa
+// pocas casillas y fija O(1) de ellas. Solo crece (y copia todo) cuando los
+// tickets pasan de la mitad; con reservar(capacidad) del lote no pasa,
+// porque cada ticket activo ocupa un lugar.
+class TablaTickets {
+private:
+    struct Casilla {
+        size_t hash;
+        int lugar;  // -1: vacia
+    };
+
+    VectorPersistente<Casilla> casillas;
+    size_t tickets;
+    size_t mascara;
+
+    static size_t hashFolio(const string& ticketId) {
+        return hash<string>()(ticketId);
+    }
+
+    void redimensionar(size_t minimo) {
+        size_t n = 16;
+        while (n < minimo) n <<= 1;
+        vector<Casilla> anteriores;
+        casillas.recorrer([&](size_t, const Casilla& c) {
+            if (c.lugar >= 0) anteriores.push_back(c);
+        });
+        casillas.asignar(n, Casilla{0, -1});
+        mascara = n - 1;
+        for (const Casilla& c : anteriores) {
+            size_t i = c.hash & mascara;
+            while (casillas[i].lugar >= 0) i = (i + 1) & mascara;
+            casillas.fijar(i, c);
+        }
+    }
+
+    // Casilla del ticket (lugares[lugar].ticketId == ticketId) o la vacia
+    // donde iria
+    template <class Lugares>
+    size_t posicion(const string& ticketId, size_t h, const Lugares& lugares) const {
+        size_t i = h & mascara;
+        while (casillas[i].lugar >= 0 &&
+               (casillas[i].hash != h || lugares[casillas[i].lugar].ticketId != ticketId)) {
+            i = (i + 1) & mascara;
+        }
+        return i;
+    }
+
+public:
+    TablaTickets() : tickets(0), mascara(15) {
+        casillas.asignar(16, Casilla{0, -1});
+    }
+
+    // Lugar para 'maximo' tickets sin crecer
+    void reservar(size_t maximo) {
+        if (2 * maximo > casillas.size()) redimensionar(2 * maximo);
+    }
+
+    size_t size() const {
+        return tickets;
+    }
+
+    template <class Lugares>
+    bool buscar(const string& ticketId, const Lugares& lugares, int& lugar) const {
+        const Casilla& c = casillas[posicion(ticketId, hashFolio(ticketId), lugares)];
+        if (c.lugar < 0) return false;
+        lugar = c.lugar;
+        return true;
+    }
+
+    // Con lugares[lugar].ticketId ya escrito; si el folio estaba en otro
+    // lugar (que aun lo tiene escrito) se mueve a este
+    template <class Lugares>
+    void fijar(const string& ticketId, int lugar, const Lugares& lugares) {
+        size_t h = hashFolio(ticketId);
+        size_t i = posicion(ticketId, h, lugares);
+        if (casillas[i].lugar < 0) {
+            if (2 * (tickets + 1) > casillas.size()) {
+                redimensionar(2 * casillas.size());
+                i = posicion(ticketId, h, lugares);
+            }
+            tickets++;
+        }
+        casillas.fijar(i, Casilla{h, lugar});
+    }
+
+    // Quita el folio si apunta a 'lugar'; no hace falta que el lugar lo
+    // tenga escrito todavia
+    void quitar(const string& ticketId, int lugar) {
+        size_t h = hashFolio(ticketId);
+        size_t hueco = h & mascara;
+        while (casillas[hueco].lugar >= 0 && (casillas[hueco].hash != h || casillas[hueco].lugar != lugar)) {
+            hueco = (hueco + 1) & mascara;
+        }
+        if (casillas[hueco].lugar < 0) return;
+        // Recorre el grupo y sube al hueco cada casilla que ya no se
+        // encontraria desde su inicio
+        for (size_t j = (hueco + 1) & mascara; casillas[j].lugar >= 0; j = (j + 1) & mascara) {
+            size_t k = casillas[j].hash & mascara;
+            bool seQueda = hueco < j ? (k > hueco && k <= j) : (k > hueco || k <= j);
+            if (seQueda) continue;
+            Casilla movida = casillas[j];
+            casillas.fijar(hueco, movida);
+            hueco = j;
+        }
+        casillas.fijar(hueco, Casilla{0, -1});
+        tickets--;
+    }
+
+    // Vacia la tabla conservando su tamanio, O(log n)
+    void limpiar() {
+        casillas.asignar(casillas.size(), Casilla{0, -1});
+        tickets = 0;
+    }
+
+    // El contenido de 'otra' sin compartir nodos con ella, para una tabla
+    // que se vuelve a escribir en su lugar (las instantaneas que recicla un
+    // lote de capacidad fija). Si son del mismo tamanio no reserva memoria.
+    void copiar(const TablaTickets& otra) {
+        if (casillas.size() != otra.casillas.size()) {
+            vector<Casilla> todas;
+            otra.casillas.recorrer([&](size_t, const Casilla& c) { todas.push_back(c); });
+            casillas.asignar(todas.begin(), todas.end());
+        } else {
+            otra.casillas.recorrer([&](size_t i, const Casilla& c) {
+                if (casillas[i].hash != c.hash || casillas[i].lugar != c.lugar) casillas.fijar(i, c);
+            });
+        }
+        tickets = otra.tickets;
+        mascara = otra.mascara;
+    }
+
+    // f(lugar) por cada ticket, en el orden de la tabla
+    template <class Funcion>
+    void recorrer(Funcion f) const {
+        casillas.recorrer([&](size_t, const Casilla& c) {
+            if (c.lugar >= 0) f(c.lugar);
+        });
+    }
+};
+
+#endif